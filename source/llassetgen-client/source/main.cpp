@@ -0,0 +1,94 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <protocol.h>
+
+namespace {
+
+const char usage[] =
+    "Send a request to a running llassetgen-server\n"
+    "Usage: llassetgen-client [--socket PATH] COMMAND [ARGS...]\n\n"
+    "Commands:\n"
+    "  atlas     Create a font atlas, takes the same options as 'llassetgen-cmd atlas'\n"
+    "  status    Show what the server keeps in memory\n"
+    "  stop      Stop the server\n";
+
+int connectTo(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path) {
+        throw std::runtime_error("socket path " + path + " is too long");
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("no llassetgen-server is listening on " + path);
+    }
+    return fd;
+}
+
+std::string workingDirectory() {
+    std::vector<char> buffer(256);
+    while (!getcwd(buffer.data(), buffer.size())) {
+        if (errno != ERANGE) {
+            throw std::runtime_error("the working directory is unknown");
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+    return buffer.data();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    // Example: llassetgen-client atlas -d parabola --ascii -f Verdana atlas.png
+    // The arguments are forwarded as they are, the server parses them like llassetgen-cmd does.
+    std::string socketPath = defaultSocketPath();
+    int first = 1;
+    if (argc > 2 && std::string{argv[1]} == "--socket") {
+        socketPath = argv[2];
+        first = 3;
+    }
+    if (first >= argc || std::string{argv[first]} == "--help" || std::string{argv[first]} == "-h") {
+        std::cout << usage;
+        return first >= argc ? 1 : 0;
+    }
+
+    try {
+        std::vector<std::string> request{workingDirectory()};
+        request.insert(request.end(), argv + first, argv + argc);
+
+        int fd = connectTo(socketPath);
+        std::vector<std::string> reply;
+        try {
+            sendMessage(fd, request);
+            reply = receiveMessage(fd);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+        if (reply.size() != 3) {
+            throw std::runtime_error("malformed reply");
+        }
+
+        std::cout << reply[1] << std::flush;
+        std::cerr << reply[2] << std::flush;
+        return std::stoi(reply[0]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
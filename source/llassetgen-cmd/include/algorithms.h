@@ -6,10 +6,12 @@
 #include <vector>
 
 #include <llassetgen/DistanceTransform.h>
+#include <llassetgen/FntWriter.h>
 #include <llassetgen/Image.h>
 #include <llassetgen/Geometry.h>
 #include <llassetgen/packing/Types.h>
 #include <llassetgen/packing/Algorithms.h>
+#include <llassetgen/packing/SizeSearch.h>
 
 
 using namespace llassetgen;
@@ -19,22 +21,45 @@ using VecIter = std::vector<Vec2<size_t>>::const_iterator;
 using ImageTransform = void (*)(Image&, Image&);
 
 
-std::map<std::string, ImageTransform> dtAlgos{
+static std::map<std::string, ImageTransform> dtAlgos{
     {"deadrec", [](Image& input, Image& output) { DeadReckoning(input, output).transform(); }},
     {"parabola", [](Image& input, Image& output) { ParabolaEnvelope(input, output).transform(); }},
 };
 
-std::map<std::string, Packing (*)(VecIter, VecIter, bool)> packingAlgos{
+static std::map<std::string, Packing (*)(VecIter, VecIter, bool)> packingAlgos{
     {"shelf", shelfPackAtlas},
-    {"maxrects", maxRectsPackAtlas}
+    {"maxrects", maxRectsPackAtlas},
+    {"skyline", skylinePackAtlas},
+    {"best", bestPackAtlas}
 };
 
-std::map<std::string, ImageTransform> downsamplingAlgos{
+static std::map<std::string, FixedSizePackingAlgorithm> fixedPackingAlgos{
+    {"shelf", shelfPackAtlas},
+    {"maxrects", maxRectsPackAtlas},
+    {"skyline", skylinePackAtlas},
+    {"best", bestPackAtlas}
+};
+
+static std::map<std::string, PagedPacking (*)(VecIter, VecIter, Vec2<PackingSizeType>, bool)> pagedPackingAlgos{
+    {"shelf", shelfPackPages},
+    {"maxrects", maxRectsPackPages},
+    {"skyline", skylinePackPages},
+    {"best", bestPackPages}
+};
+
+static std::map<std::string, ImageTransform> downsamplingAlgos{
     {"center", [](Image& input, Image& output) { input.centerDownsampling<DistanceTransform::OutputType>(output); }},
     {"average", [](Image& input, Image& output) { input.averageDownsampling<DistanceTransform::OutputType>(output); }},
     {"min", [](Image& input, Image& output) { input.minDownsampling<DistanceTransform::OutputType>(output); }}
 };
 
+static std::map<std::string, FntFormat> fntFormats{
+    {"text", FntFormat::Text},
+    {"binary", FntFormat::Binary},
+    {"xml", FntFormat::Xml},
+    {"json", FntFormat::Json}
+};
+
 template <class Func>
 std::set<std::string> algoNames(const std::map<std::string, Func> & map) {
     std::set<std::string> names;
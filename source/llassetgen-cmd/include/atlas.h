@@ -0,0 +1,120 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/GlyphRecord.h>
+#include <llassetgen/Image.h>
+#include <llassetgen/TileCache.h>
+
+namespace CLI {
+class App;
+}
+
+
+// Options of one atlas, from the command line of `atlas`, a job of a batch manifest or a request to the server.
+struct AtlasOptions {
+    std::string outPath;
+    // distance transform, none for a font atlas
+    std::string algorithm;
+    std::string packing = "shelf";
+    std::string glyphs;
+    std::vector<unsigned int> charCodes;
+    bool includeAscii = false;
+    bool includeAll = false;
+    unsigned int fontSize = 128;
+    std::string fontName;
+    std::string fontPath;
+    std::string fontCache;
+    unsigned int padding = 0;
+    unsigned int downsamplingRatio = 1;
+    std::string downsampling = "center";
+    std::vector<int> dynamicRange = {-30, 20};
+    bool createFnt = false;
+    std::string fntFormat = "text";
+    bool createBundle = false;
+    unsigned int memoryBudget = 0;
+    unsigned int maxTextureSize = 0;
+    bool smallest = false;
+    unsigned int alignment = 1;
+    bool crop = false;
+    bool incremental = false;
+    std::string tileCacheDir;
+    // threads that compute distance fields, one per hardware thread if 0
+    unsigned int transformThreads = 0;
+    unsigned int queueDepth = 16;
+};
+
+void addAtlasOptions(CLI::App& app, AtlasOptions& options);
+
+// Opens the font of an atlas, e.g. from a cache shared by the jobs of a batch.
+using FontOpener = std::function<llassetgen::FontFinder(const AtlasOptions&)>;
+
+llassetgen::FontFinder openFont(const AtlasOptions& options);
+
+// Fonts shared by several atlases, e.g. the jobs of a batch or the requests to the server. Every font is looked up and
+// mapped once, and every worker opens its own face of it once, as FreeType faces must not be used by several threads
+// at once.
+class FontPool {
+   public:
+    explicit FontPool(unsigned int workerCount) : workerFaces(workerCount) {}
+
+    llassetgen::FontFinder open(const AtlasOptions& options, unsigned int worker);
+
+   private:
+    std::shared_ptr<const llassetgen::FontSource> fontSource(const AtlasOptions& options);
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const llassetgen::FontSource>> sources;
+    std::vector<std::map<const llassetgen::FontSource*, llassetgen::FontFinder>> workerFaces;
+};
+
+// Glyph metrics, rendered glyphs and distance field tiles kept in memory by a long-running process, so that later
+// atlases of the same fonts and settings skip loading and rendering them. Fonts must stay open as long as the cache,
+// e.g. in a FontPool. Only the tiles may be used by several threads at once.
+class AtlasCache {
+   public:
+    // At most `capacityBytes` of rendered glyphs and as many of tiles are kept, the least recently used are dropped.
+    explicit AtlasCache(size_t capacityBytes) : tiles(capacityBytes), capacityBytes(capacityBytes) {}
+
+    uint64_t fontHash(const llassetgen::FontFinder& font);
+
+    // Records of the glyphs that the font has, like FontFinder::glyphRecords.
+    std::vector<llassetgen::GlyphRecord> glyphRecords(llassetgen::FontFinder& font,
+                                                      const std::set<unsigned long>& glyphs,
+                                                      const AtlasOptions& options);
+
+    llassetgen::Image renderGlyph(llassetgen::FontFinder& font, const llassetgen::GlyphRecord& record,
+                                  const AtlasOptions& options);
+
+    // Bytes of rendered glyphs currently held.
+    size_t glyphBytes() const { return usedBytes; }
+
+    llassetgen::TileMemory tiles;
+
+   private:
+    using GlyphKey = std::tuple<const llassetgen::FontSource*, unsigned int, unsigned int, unsigned int, unsigned long>;
+    static GlyphKey glyphKey(const llassetgen::FontFinder& font, unsigned long charcode, const AtlasOptions& options);
+
+    std::map<const llassetgen::FontSource*, uint64_t> fontHashes;
+    std::map<GlyphKey, llassetgen::GlyphRecord> records;
+
+    // most recently used first
+    std::list<std::pair<GlyphKey, llassetgen::Image>> bitmaps;
+    std::map<GlyphKey, std::list<std::pair<GlyphKey, llassetgen::Image>>::iterator> bitmapIndex;
+    size_t capacityBytes;
+    size_t usedBytes = 0;
+};
+
+// Build an atlas and write all its files. Throws if it can not be built. Warnings, e.g. about glyphs the font does not
+// contain, go to `err`. With a cache, the glyphs and tiles of earlier atlases are reused.
+void buildAtlas(AtlasOptions options, const FontOpener& fontOpener, std::ostream& err, AtlasCache* cache = nullptr);
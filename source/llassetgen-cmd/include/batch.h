@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+// One atlas of a batch manifest: its name and its options as command line arguments of `atlas`.
+struct BatchJob {
+    std::string name;
+    std::vector<std::string> args;
+};
+
+/*
+ * Read the jobs of a batch manifest, in the order they are listed. Manifests ending in `.json` hold an object with an
+ * optional "defaults" object and a "jobs" object, which maps job names to objects of options:
+ *
+ *     {"defaults": {"fontpath": "OpenSans-Regular.ttf", "fnt": true},
+ *      "jobs": {"small": {"fontsize": 32, "ascii": true, "outfile": "small.png"}}}
+ *
+ * All other manifests are INI files like the `--config` files of `atlas`, with one section per job. Options before
+ * the first section are defaults:
+ *
+ *     fontpath = OpenSans-Regular.ttf
+ *     fnt = true
+ *     [small]
+ *     fontsize = 32
+ *     ascii = true
+ *     outfile = small.png
+ *
+ * Options are the long names of the options of `atlas`. Jobs override the defaults, flags are set with true and
+ * lists are separated by spaces in INI files. Throws std::runtime_error if the manifest can not be read.
+ */
+std::vector<BatchJob> loadBatchManifest(const std::string& manifestPath);
@@ -2,16 +2,20 @@
 
 #include <string>
 
-std::string
+static std::string
     appHelp{"OpenLL Font Asset Generator\nRun 'llassetgen [SUBCOMMAND] --help' for more details\n"},
     atlasHelp{"Create a font atlas, optionally applying a distance transform"},
     distfieldHelp{
         "Apply a distance transform algorithm to the atlas. If none is chosen, no distance transform will be applied"},
-    packingHelp{"Use a different packing algorithm. 'maxrects' is more space-efficient, 'shelf' is faster"},
+    packingHelp{
+        "Use a different packing algorithm. 'maxrects' is more space-efficient, 'shelf' is faster, 'skyline' is "
+        "nearly as dense as 'maxrects' and fast enough for very large glyph sets, 'best' tries several variants of "
+        "'maxrects' in parallel and keeps the smallest atlas"},
     glyphHelp{"Add the specified glyphs to the atlas"},
     charcodeHelp{"Add glyphs to the atlas by specifying their character codes, separated by spaces"},
     fontnameHelp{"Use the font with the specified name"},
     fontpathHelp{"Use the font file at the specified path"},
+    fontcacheHelp{"Remember font name lookups in this file to speed up later runs"},
     paddingHelp{"Add padding to each glyph"},
     fontsizeHelp{"Specify the font size in pixels"},
     dynamicrangeHelp{
@@ -19,14 +23,51 @@ std::string
         "value will make the distance fields brighter. In most cases, the black value should be lower than the white "
         "value. However, swapping the black and white value will invert the colors of the atlas"},
     asciiHelp{"Add all printable ASCII glyphs"},
+    allGlyphsHelp{"Add every glyph that the font maps to a character code"},
     aOutfileHelp{"Output the font atlas to the specified path"},
     configHelp{
         "Read options from a configuration file. Options passed as arguments will override the configuration file. You "
         "can find an example file in the 'config' directory"},
     fntHelp{"Generate a font file in the FNT format"},
+    bundleHelp{
+        "Generate a memory-mappable font bundle with glyph metrics, kerning and, unless the atlas is streamed, its "
+        "pixels"},
+    fntFormatHelp{"Write the FNT file in this format. 'binary' files are faster to load"},
+    memoryBudgetHelp{
+        "Limit the memory used to compose the atlas to this many MiB. Atlases that would exceed it are streamed to "
+        "the output file row by row"},
+    incrementalHelp{
+        "Record the atlas layout in a manifest next to it and, if one exists for the same font and settings, only "
+        "render the glyphs that are not in the atlas yet"},
+    tileCacheHelp{
+        "Keep the distance field of every glyph in this directory and reuse it in later runs with the same font and "
+        "settings. The directory can be shared by concurrent runs"},
+    maxTextureSizeHelp{
+        "Never make the atlas wider or higher than this, e.g. the maximum texture size of the target GPU. Larger "
+        "atlases are split into pages of this size, written to numbered PNG files and composed in parallel"},
+    smallestHelp{
+        "Search for the atlas size with the smallest area that the glyphs fit into, instead of doubling the width or "
+        "height until they fit. Slower, as the glyphs are packed many times"},
+    alignHelp{
+        "Make the width and height of atlases found with --smallest or cropped with --crop a multiple of this, e.g. 4 "
+        "for block compressed textures"},
+    cropHelp{"Crop the atlas to the bounding box of its glyphs"},
+    profileHelp{
+        "Record how long each stage of the atlas build takes and write it to this file as a Chrome trace, which "
+        "chrome://tracing and Perfetto can open"},
+    transformThreadsHelp{
+        "Compute the distance fields of this many glyphs at once while the next glyphs are rendered. Defaults to one "
+        "thread per hardware thread, or to one in a batch of several jobs"},
+    queueDepthHelp{
+        "Let at most this many glyphs wait between rendering, the distance transform and composing. Deeper queues "
+        "smooth out glyphs of different sizes but hold more memory"},
     downsamplingRatioHelp{"Downsample the atlas by this factor."},
     downsamplingHelp{"Use a different downsampling algorithm"},
 
+    batchHelp{"Create many atlases in one process, as listed in a manifest"},
+    manifestHelp{"JSON or INI file that lists the atlases with the options of 'atlas' for each, see the README"},
+    jobsHelp{"Number of atlases built at once. Defaults to one per hardware thread"},
+
     dfHelp{"Apply a distance transform to an image"},
     algorithmHelp{"Apply a different distance transform algorithm to the atlas"},
     imageHelp{"Apply the distance transform to the image at this path"},
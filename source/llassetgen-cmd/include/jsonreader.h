@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+/*
+ * Reads the JSON of batch manifests and performance results: objects, arrays of scalars, strings with all escapes,
+ * numbers and booleans. Malformed documents throw std::runtime_error naming `document` and the offset of the error,
+ * e.g. "invalid manifest at offset 12: ':' expected".
+ */
+class JsonReader {
+   public:
+    JsonReader(const std::string& _text, const std::string& _document) : text(_text), document(_document) {}
+
+    // Calls `readMember(key)` for every member of the object at the current position
+    template <class Func>
+    void readObject(Func readMember) {
+        expect('{');
+        if (accept('}')) {
+            return;
+        }
+        do {
+            std::string key = readString();
+            expect(':');
+            readMember(key);
+        } while (accept(','));
+        expect('}');
+    }
+
+    // A string, number or boolean, or an array of them, each as the text it stands for
+    std::vector<std::string> readValues() {
+        std::vector<std::string> values;
+        if (accept('[')) {
+            if (accept(']')) {
+                return values;
+            }
+            do {
+                values.push_back(readScalar());
+            } while (accept(','));
+            expect(']');
+        } else {
+            values.push_back(readScalar());
+        }
+        return values;
+    }
+
+    std::string readScalar() {
+        if (peek() == '"') {
+            return readString();
+        }
+        size_t begin = pos;
+        while (pos < text.size() && (std::isalnum(text[pos] & 0xff) || text[pos] == '-' || text[pos] == '+' ||
+                                     text[pos] == '.')) {
+            pos++;
+        }
+        std::string scalar = text.substr(begin, pos - begin);
+        if (scalar.empty() || scalar == "null") {
+            fail("value expected");
+        }
+        return scalar;
+    }
+
+    double readNumber() {
+        peek();
+        const char* begin = text.c_str() + pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) {
+            fail("number expected");
+        }
+        pos += size_t(end - begin);
+        return value;
+    }
+
+    std::string readString() {
+        expect('"');
+        std::string value;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                value += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                break;
+            }
+            c = text[pos++];
+            if (c == 'u') {
+                appendUtf8(value, readHex());
+            } else {
+                const std::string escapes = "\"\"\\\\//b\bf\fn\nr\rt\t";
+                size_t escape = escapes.find(c);
+                if (escape == std::string::npos || escape % 2 != 0) {
+                    pos--;
+                    fail("invalid escape sequence");
+                }
+                value += escapes[escape + 1];
+            }
+        }
+        expect('"');
+        return value;
+    }
+
+    void expectEnd() {
+        if (peek() != '\0') {
+            fail("trailing characters");
+        }
+    }
+
+   private:
+    // The code point of a \u escape, with the digits at the current position
+    unsigned long readHex() {
+        size_t begin = pos;
+        unsigned long code = readCodeUnit();
+        if (code >= 0xDC00 && code < 0xE000) {
+            pos = begin;
+            fail("unpaired low surrogate");
+        }
+        // characters outside of the BMP are escaped as surrogate pairs
+        if (code >= 0xD800 && code < 0xDC00) {
+            if (text.compare(pos, 2, "\\u") != 0) {
+                fail("unpaired high surrogate");
+            }
+            pos += 2;
+            begin = pos;
+            unsigned long low = readCodeUnit();
+            if (low < 0xDC00 || low >= 0xE000) {
+                pos = begin;
+                fail("invalid low surrogate");
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return code;
+    }
+
+    // Exactly four hex digits
+    unsigned long readCodeUnit() {
+        unsigned long code = 0;
+        for (size_t end = pos + 4; pos < end; pos++) {
+            if (pos >= text.size() || !std::isxdigit(text[pos] & 0xff)) {
+                fail("four hex digits expected");
+            }
+            char digit = char(std::tolower(text[pos] & 0xff));
+            code = code << 4 | (digit <= '9' ? digit - '0' : digit - 'a' + 10);
+        }
+        return code;
+    }
+
+    static void appendUtf8(std::string& str, unsigned long code) {
+        if (code < 0x80) {
+            str += char(code);
+        } else if (code < 0x800) {
+            str += char(0xC0 | code >> 6);
+            str += char(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            str += char(0xE0 | code >> 12);
+            str += char(0x80 | (code >> 6 & 0x3F));
+            str += char(0x80 | (code & 0x3F));
+        } else {
+            str += char(0xF0 | code >> 18);
+            str += char(0x80 | (code >> 12 & 0x3F));
+            str += char(0x80 | (code >> 6 & 0x3F));
+            str += char(0x80 | (code & 0x3F));
+        }
+    }
+
+    char peek() {
+        while (pos < text.size() && std::isspace(text[pos] & 0xff)) {
+            pos++;
+        }
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    bool accept(char c) {
+        if (peek() == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!accept(c)) {
+            fail(std::string{"'"} + c + "' expected");
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& message) {
+        throw std::runtime_error(document + " at offset " + std::to_string(pos) + ": " + message);
+    }
+
+    const std::string& text;
+    std::string document;
+    size_t pos = 0;
+};
@@ -0,0 +1,528 @@
+#include <atlas.h>
+
+#include <CLI11.h>
+#include <codecvt>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <algorithms.h>
+#include <helpstrings.h>
+
+#include <llassetgen/Atlas.h>
+#include <llassetgen/AtlasManifest.h>
+#include <llassetgen/BundleWriter.h>
+#include <llassetgen/FntWriter.h>
+
+using namespace llassetgen;
+
+namespace {
+// all printable ascii characters, except for space
+constexpr char ascii[] =
+    "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+
+std::u32string UTF8toUCS4(const std::string& str) {
+#if _MSC_VER >= 1900  // handle Visual Studio bug
+    std::wstring_convert<std::codecvt_utf8<uint32_t>, uint32_t> ucs4conv;
+    auto convStr = ucs4conv.from_bytes(str);
+    return std::u32string(reinterpret_cast<const char32_t*>(convStr.data()), convStr.size());
+#else
+    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> ucs4conv;
+    return ucs4conv.from_bytes(str);
+#endif
+}
+
+std::vector<Vec2<size_t>> sizes(const std::vector<Vec2<size_t>>& glyphSizes, unsigned int downsamplingRatio) {
+    std::vector<Vec2<size_t>> imageSizes(glyphSizes.size());
+    std::transform(glyphSizes.begin(), glyphSizes.end(), imageSizes.begin(),
+                   [downsamplingRatio](const Vec2<size_t>& size) { return size / downsamplingRatio; });
+    return imageSizes;
+}
+
+std::tuple<std::string, std::string, std::string, std::string> outNames(const std::string& outPath) {
+    std::string pathWithoutExtension;
+    if (outPath.substr(outPath.length() - 4) == ".png") {
+        pathWithoutExtension = outPath.substr(0, outPath.length() - 4);
+    } else {
+        pathWithoutExtension = outPath;
+    }
+    return std::make_tuple(pathWithoutExtension + ".png", pathWithoutExtension + ".fnt", pathWithoutExtension + ".llfb",
+                           pathWithoutExtension + ".manifest");
+}
+
+// One PNG path per atlas page. The pages are numbered with the same number of digits, as binary FNT files require
+// page file names of the same length.
+std::vector<std::string> pagePaths(const std::string& pngPath, size_t pageCount) {
+    const std::string pathWithoutExtension = pngPath.substr(0, pngPath.length() - 4);
+    const size_t digits = std::to_string(pageCount - 1).length();
+    std::vector<std::string> paths;
+    for (size_t page = 0; page < pageCount; page++) {
+        std::string number = std::to_string(page);
+        paths.push_back(pathWithoutExtension + "_" + std::string(digits - number.length(), '0') + number + ".png");
+    }
+    return paths;
+}
+
+// The FNT file is written next to the atlas, so its pages are referenced by file name only.
+std::string fileName(const std::string& path) {
+    return path.substr(path.find_last_of("/\\") + 1);
+}
+
+Vec2<size_t> pngSize(const std::string& pngPath) {
+    // the width and height are the first fields of the IHDR chunk, which directly follows the signature
+    unsigned char header[24] = {};
+    std::ifstream file(pngPath, std::ios::binary);
+    file.read(reinterpret_cast<char*>(header), sizeof header);
+    auto readU32 = [&header](size_t offset) {
+        return size_t(header[offset]) << 24 | size_t(header[offset + 1]) << 16 | size_t(header[offset + 2]) << 8 |
+               size_t(header[offset + 3]);
+    };
+    return file ? Vec2<size_t>{readU32(16), readU32(20)} : Vec2<size_t>{0, 0};
+}
+
+// Packing that keeps the glyphs of the previous atlas at the output path. Has no rects if there is no
+// matching previous atlas or the new glyphs do not fit into it, and the atlas has to be rebuilt.
+IncrementalPacking previousPacking(const std::string& manifestPath, const std::string& pngPath,
+                                   const AtlasSettings& settings, const std::vector<GlyphRecord>& records,
+                                   const std::vector<Vec2<size_t>>& imageSizes, std::ostream& err) {
+    if (!std::ifstream(manifestPath)) {
+        return {};
+    }
+
+    AtlasManifest previous;
+    try {
+        previous = AtlasManifest::load(manifestPath);
+    } catch (const std::exception& e) {
+        err << "Warning: rebuilding the atlas, " << e.what() << std::endl;
+        return {};
+    }
+    if (previous.settings != settings || pngSize(pngPath) != previous.atlasSize) {
+        return {};
+    }
+
+    std::vector<unsigned long> charcodes(records.size());
+    std::transform(records.begin(), records.end(), charcodes.begin(),
+                   [](const GlyphRecord& record) { return record.charcode; });
+    return incrementalPacking(previous, charcodes, imageSizes);
+}
+
+std::set<unsigned long> makeGlyphSet(const std::string& glyphs, const std::vector<unsigned int>& charCodes,
+                                     bool includeAscii) {
+    std::set<unsigned long> set;
+    for (const auto c : UTF8toUCS4(glyphs)) {
+        set.insert(c);
+    }
+
+    for (const auto c : charCodes) {
+        set.insert(c);
+    }
+
+    if (includeAscii) {
+        const char* p = ascii;
+        while (*p) {
+            set.insert(static_cast<unsigned long>(*p++));
+        }
+    }
+    return set;
+}
+
+// How the glyphs of an atlas are composed.
+struct Composition {
+    bool distanceField;
+    ImageTransform distanceTransform;
+    ImageTransform downsampling;
+    DistanceTransform::OutputType black;
+    DistanceTransform::OutputType white;
+    const TileCache* tileCache;
+    // the atlas is streamed to disk if composing it in memory would need more, 0 for no limit
+    size_t budgetBytes;
+    AtlasPipeline pipeline;
+};
+
+// The widest pipeline within the budget: the queues are made shallower first, then the transform threads fewer.
+// Returns false if not even a single glyph in flight per stage fits.
+bool fitPipeline(const Packing& p, const std::vector<Vec2<size_t>>& glyphSizes, size_t budgetBytes,
+                 AtlasPipeline& pipeline) {
+    pipeline.transformThreads = pipeline.transformThreadCount();
+    while (atlasPeakBytes(p, glyphSizes, true, pipeline) > budgetBytes) {
+        if (pipeline.queueDepth > 1) {
+            pipeline.queueDepth /= 2;
+        } else if (pipeline.transformThreads > 1) {
+            pipeline.transformThreads /= 2;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compose the atlas of a packing and write it to `pngPath`. `glyphSizes` and, with a tile cache, `glyphIndices` belong
+// to the rects of the packing. Returns the atlas, or nothing if it was streamed to disk to stay within the budget.
+std::unique_ptr<Image> writeAtlas(const Packing& p, const std::function<Image(size_t)>& renderGlyph,
+                                  const std::vector<Vec2<size_t>>& glyphSizes,
+                                  const std::vector<uint32_t>& glyphIndices, const Composition& composition,
+                                  const std::string& pngPath) {
+    const size_t budgetBytes = composition.budgetBytes;
+    AtlasPipeline pipeline = composition.pipeline;
+    const bool stream = budgetBytes > 0 && (composition.distanceField
+                                                ? !fitPipeline(p, glyphSizes, budgetBytes, pipeline)
+                                                : atlasPeakBytes(p, glyphSizes, false) > budgetBytes);
+    if (stream && streamedAtlasPeakBytes(p, glyphSizes, composition.distanceField) > budgetBytes) {
+        size_t requiredMiB = (streamedAtlasPeakBytes(p, glyphSizes, composition.distanceField) >> 20) + 1;
+        throw std::runtime_error("memory budget too small, at least " + std::to_string(requiredMiB) +
+                                 " MiB are required for this atlas");
+    }
+
+    std::unique_ptr<Image> atlas;
+    if (composition.distanceField && stream) {
+        streamDistanceFieldAtlas(p, renderGlyph, composition.distanceTransform, composition.downsampling, pngPath,
+                                 composition.black, composition.white, composition.tileCache, glyphIndices);
+    } else if (composition.distanceField) {
+        atlas.reset(new Image{distanceFieldAtlas(p, renderGlyph, composition.distanceTransform,
+                                                 composition.downsampling, composition.black, composition.white,
+                                                 composition.tileCache, glyphIndices, pipeline)});
+        atlas->exportPng<uint16_t>(pngPath);
+    } else if (stream) {
+        streamFontAtlas(p, renderGlyph, pngPath);
+    } else {
+        atlas.reset(new Image{fontAtlas(p, renderGlyph)});
+        atlas->exportPng<uint8_t>(pngPath);
+    }
+    return atlas;
+}
+
+}  // namespace
+
+void addAtlasOptions(CLI::App& app, AtlasOptions& options) {
+    // positional arguments
+    app.add_option("outfile", options.outPath, aOutfileHelp)->required();
+
+    // algorithms
+    CLI::Option* distfieldOpt = app.add_set("-d, --distfield", options.algorithm, algoNames(dtAlgos), distfieldHelp);
+    app.add_set("-k, --packing", options.packing, algoNames(packingAlgos), packingHelp, true);
+
+    // glyphs
+    app.add_option("-g, --glyph", options.glyphs, glyphHelp);
+    app.add_option("-c, --charcode", options.charCodes, charcodeHelp);
+    app.add_flag("--ascii", options.includeAscii, asciiHelp);
+    app.add_flag("--all-glyphs", options.includeAll, allGlyphsHelp);
+
+    // font
+    app.add_option("-s, --fontsize", options.fontSize, fontsizeHelp, true);
+    app.add_option("-f, --fontname", options.fontName, fontnameHelp);
+    app.add_option("--fontpath", options.fontPath, fontpathHelp)->check(CLI::ExistingFile);
+    app.add_option("--fontcache", options.fontCache, fontcacheHelp);
+
+    // other options
+    app.add_option("-p, --padding", options.padding, paddingHelp);
+    app.add_option("-w, --downsampling", options.downsamplingRatio, downsamplingRatioHelp);
+    app.add_set("--dsalgo", options.downsampling, algoNames(downsamplingAlgos), downsamplingHelp, true);
+    app.add_option("-r, --dynamicrange", options.dynamicRange, dynamicrangeHelp, true)
+        ->requires(distfieldOpt)
+        ->expected(2);
+    CLI::Option* fntOpt = app.add_flag("--fnt", options.createFnt, fntHelp);
+    app.add_set("--fntformat", options.fntFormat, algoNames(fntFormats), fntFormatHelp, true)->requires(fntOpt);
+    app.add_flag("--bundle", options.createBundle, bundleHelp);
+    CLI::Option* memoryBudgetOpt = app.add_option("--memory-budget", options.memoryBudget, memoryBudgetHelp);
+    app.add_option("--max-texture-size", options.maxTextureSize, maxTextureSizeHelp);
+    app.add_flag("--smallest", options.smallest, smallestHelp);
+    app.add_option("--align", options.alignment, alignHelp, true);
+    app.add_flag("--crop", options.crop, cropHelp);
+    app.add_flag("--incremental", options.incremental, incrementalHelp)->excludes(memoryBudgetOpt);
+    app.add_option("--tilecache", options.tileCacheDir, tileCacheHelp)->requires(distfieldOpt);
+    app.add_option("--transform-threads", options.transformThreads, transformThreadsHelp)->requires(distfieldOpt);
+    app.add_option("--queue-depth", options.queueDepth, queueDepthHelp, true)->requires(distfieldOpt);
+}
+
+FontFinder openFont(const AtlasOptions& options) {
+    if (options.fontName.empty() && options.fontPath.empty()) {
+        throw std::runtime_error("no font specified");
+    }
+    if (!options.fontCache.empty()) {
+        FontFinder::setFontCacheFile(options.fontCache);
+    }
+    return !options.fontPath.empty() ? FontFinder::fromPath(options.fontPath) : FontFinder::fromName(options.fontName);
+}
+
+FontFinder FontPool::open(const AtlasOptions& options, unsigned int worker) {
+    std::shared_ptr<const FontSource> source = fontSource(options);
+    std::map<const FontSource*, FontFinder>& faces = workerFaces[worker];
+    auto face = faces.find(source.get());
+    if (face == faces.end()) {
+        face = faces.emplace(source.get(), FontFinder::fromSource(source)).first;
+    }
+    return face->second;
+}
+
+std::shared_ptr<const FontSource> FontPool::fontSource(const AtlasOptions& options) {
+    const std::string key = options.fontPath.empty() ? "name:" + options.fontName : "path:" + options.fontPath;
+    std::lock_guard<std::mutex> lock{mutex};
+    auto source = sources.find(key);
+    if (source == sources.end()) {
+        source = sources.emplace(key, openFont(options).source).first;
+    }
+    return source->second;
+}
+
+uint64_t AtlasCache::fontHash(const FontFinder& font) {
+    auto hash = fontHashes.find(font.source.get());
+    if (hash == fontHashes.end()) {
+        hash = fontHashes.emplace(font.source.get(), font.source->contentHash()).first;
+    }
+    return hash->second;
+}
+
+std::vector<GlyphRecord> AtlasCache::glyphRecords(FontFinder& font, const std::set<unsigned long>& glyphs,
+                                                  const AtlasOptions& options) {
+    std::set<unsigned long> missing;
+    for (unsigned long glyph : glyphs) {
+        if (records.find(glyphKey(font, glyph, options)) == records.end()) {
+            missing.insert(glyph);
+        }
+    }
+    // the face may be shared with atlases of other sizes, rendering and the FNT file need this one
+    font.setFontSize(options.fontSize);
+    for (const GlyphRecord& record :
+         font.glyphRecords(missing, options.fontSize, options.padding, options.downsamplingRatio)) {
+        records.emplace(glyphKey(font, record.charcode, options), record);
+    }
+
+    std::vector<GlyphRecord> glyphRecords;
+    glyphRecords.reserve(glyphs.size());
+    for (unsigned long glyph : glyphs) {
+        glyphRecords.push_back(records.at(glyphKey(font, glyph, options)));
+    }
+    return glyphRecords;
+}
+
+Image AtlasCache::renderGlyph(FontFinder& font, const GlyphRecord& record, const AtlasOptions& options) {
+    const GlyphKey key = glyphKey(font, record.charcode, options);
+    auto cached = bitmapIndex.find(key);
+    if (cached == bitmapIndex.end()) {
+        Image rendered = font.renderGlyph(record, options.padding, options.downsamplingRatio);
+        if (rendered.getByteSize() > capacityBytes) {
+            return rendered;
+        }
+        usedBytes += rendered.getByteSize();
+        bitmaps.emplace_front(key, std::move(rendered));
+        cached = bitmapIndex.emplace(key, bitmaps.begin()).first;
+        while (usedBytes > capacityBytes) {
+            usedBytes -= bitmaps.back().second.getByteSize();
+            bitmapIndex.erase(bitmaps.back().first);
+            bitmaps.pop_back();
+        }
+    } else {
+        bitmaps.splice(bitmaps.begin(), bitmaps, cached->second);
+    }
+
+    const Image& bitmap = cached->second->second;
+    Image copy{bitmap.getWidth(), bitmap.getHeight(), bitmap.getBitDepth()};
+    copy.copyDataFrom(bitmap);
+    return copy;
+}
+
+AtlasCache::GlyphKey AtlasCache::glyphKey(const FontFinder& font, unsigned long charcode,
+                                          const AtlasOptions& options) {
+    return GlyphKey{font.source.get(), options.fontSize, options.padding, options.downsamplingRatio, charcode};
+}
+
+// Build an atlas and write all its files. Throws if it can not be built.
+void buildAtlas(AtlasOptions options, const FontOpener& fontOpener, std::ostream& err, AtlasCache* cache) {
+    std::string fntPath, bundlePath, manifestPath;
+    std::tie(options.outPath, fntPath, bundlePath, manifestPath) = outNames(options.outPath);
+
+    std::set<unsigned long> glyphSet = makeGlyphSet(options.glyphs, options.charCodes, options.includeAscii);
+    if (glyphSet.empty() && !options.includeAll) {
+        throw std::runtime_error("at least one glyph required");
+    }
+
+    FontFinder fontFinder = fontOpener(options);
+    if (options.includeAll) {
+        std::set<unsigned long> allGlyphs = fontFinder.allGlyphs();
+        glyphSet.insert(allGlyphs.begin(), allGlyphs.end());
+    }
+
+    // Phase one: record each glyph's metrics with a single load and pack the sizes computed from its
+    // outline, without rendering.
+    std::vector<GlyphRecord> records =
+        cache ? cache->glyphRecords(fontFinder, glyphSet, options)
+              : fontFinder.glyphRecords(glyphSet, options.fontSize, options.padding, options.downsamplingRatio);
+    for (const GlyphRecord& record : records) {
+        if (record.gindex == 0) {
+            err << "Warning: font does not contain glyph with code " << record.charcode << std::endl;
+        }
+    }
+    std::vector<Vec2<size_t>> glyphSizes(records.size());
+    std::transform(records.begin(), records.end(), glyphSizes.begin(),
+                   [](const GlyphRecord& record) { return record.size; });
+    std::vector<Vec2<size_t>> imageSizes = sizes(glyphSizes, options.downsamplingRatio);
+
+    // Everything besides the glyph set that affects the atlas, to recognize reusable glyphs and tiles.
+    AtlasSettings settings;
+    const bool useTiles = !options.tileCacheDir.empty() || (cache && !options.algorithm.empty());
+    if (options.incremental || useTiles) {
+        settings.fontHash = cache ? cache->fontHash(fontFinder) : fontFinder.source->contentHash();
+        settings.fontSize = options.fontSize;
+        settings.padding = options.padding;
+        settings.downsampling = options.downsamplingRatio;
+        settings.downsamplingAlgorithm = options.downsampling;
+        settings.distanceTransform = options.algorithm;
+        if (!options.algorithm.empty()) {
+            settings.dynamicRangeMin = options.dynamicRange[0];
+            settings.dynamicRangeMax = options.dynamicRange[1];
+        }
+        settings.packing = options.packing;
+    }
+
+    // In incremental mode, keep the glyphs of the previous atlas whose rects still fit and only render the
+    // remaining ones, unless the settings changed or they do not fit into the previous atlas.
+    IncrementalPacking update;
+    if (options.incremental) {
+        update = previousPacking(manifestPath, options.outPath, settings, records, imageSizes, err);
+    }
+    const bool isUpdate = !update.packing.rects.empty();
+    Packing p;
+    if (isUpdate) {
+        p = update.packing;
+    } else if (options.smallest) {
+        p = packSmallestAtlas(imageSizes, fixedPackingAlgos[options.packing], false, options.alignment);
+    } else {
+        p = packingAlgos[options.packing](imageSizes.begin(), imageSizes.end(), false);
+    }
+    if (options.crop && !isUpdate) {
+        p.crop(options.alignment);
+    }
+
+    // Split the atlas into pages of the maximum texture size if it grew larger.
+    PagedPacking pages;
+    const bool isPaged = options.maxTextureSize > 0 && std::max(p.atlasSize.x, p.atlasSize.y) > options.maxTextureSize;
+    if (isPaged) {
+        if (options.incremental || options.createBundle) {
+            throw std::runtime_error("the atlas exceeds the maximum texture size, atlases with several pages "
+                                     "can not be updated incrementally or bundled");
+        }
+        pages = pagedPackingAlgos[options.packing](imageSizes.begin(), imageSizes.end(),
+                                                   {options.maxTextureSize, options.maxTextureSize}, false);
+        if (pages.rects.empty()) {
+            throw std::runtime_error("a glyph is larger than the maximum texture size");
+        }
+    }
+
+    // Phase two: render each glyph straight into its atlas rect, unless its distance field tile is cached.
+    auto renderGlyph = [&](size_t i) {
+        return cache ? cache->renderGlyph(fontFinder, records[i], options)
+                     : fontFinder.renderGlyph(records[i], options.padding, options.downsamplingRatio);
+    };
+    std::unique_ptr<TileCache> tileCache;
+    std::vector<uint32_t> glyphIndices;
+    if (useTiles) {
+        tileCache.reset(new TileCache{options.tileCacheDir, settings, cache ? &cache->tiles : nullptr});
+        for (const GlyphRecord& record : records) {
+            glyphIndices.push_back(record.gindex);
+        }
+    }
+
+    // Stream the atlas to disk if composing it in memory would exceed the memory budget.
+    const bool isDistanceField = !options.algorithm.empty();
+    Composition composition{isDistanceField,
+                            isDistanceField ? dtAlgos[options.algorithm] : nullptr,
+                            downsamplingAlgos[options.downsampling],
+                            DistanceTransform::OutputType(-options.dynamicRange[0]),
+                            DistanceTransform::OutputType(-options.dynamicRange[1]),
+                            tileCache.get(),
+                            size_t(options.memoryBudget) << 20,
+                            AtlasPipeline{}};
+    composition.pipeline.transformThreads = options.transformThreads;
+    composition.pipeline.queueDepth = options.queueDepth;
+
+    BundleWriter bundleWriter{fontFinder.fontFace, options.fontSize};
+    if (options.createBundle) {
+        bundleWriter.setGlyphs(records, p, options.padding, options.downsamplingRatio);
+    }
+
+    if (isDistanceField && isUpdate) {
+        Image atlas{options.outPath, 16};
+        updateDistanceFieldAtlas(atlas, update, renderGlyph, dtAlgos[options.algorithm],
+                                 downsamplingAlgos[options.downsampling], -options.dynamicRange[0],
+                                 -options.dynamicRange[1], tileCache.get(), glyphIndices, composition.pipeline);
+        atlas.exportPng<uint16_t>(options.outPath);
+        if (options.createBundle) {
+            bundleWriter.setAtlas(atlas);
+        }
+    } else if (isUpdate) {
+        Image atlas{options.outPath, 1};
+        updateFontAtlas(atlas, update, renderGlyph);
+        atlas.exportPng<uint8_t>(options.outPath);
+        if (options.createBundle) {
+            bundleWriter.setAtlas(atlas);
+        }
+    } else if (isPaged) {
+        // Every page is composed on its own thread. FreeType faces must not be used by several threads at
+        // once, so only rendering is serialized. Pages composed at the same time would share the memory budget.
+        // The pages already keep the hardware threads busy, so each transforms its glyphs on one more thread.
+        std::mutex renderMutex;
+        Composition pageComposition = composition;
+        if (options.transformThreads == 0) {
+            pageComposition.pipeline.transformThreads = 1;
+        }
+        const std::vector<std::string> paths = pagePaths(options.outPath, pages.pageCount);
+        buildPages(pages,
+                   [&](size_t page, const Packing& pagePacking, const std::vector<size_t>& rectIndices) {
+                       std::vector<Vec2<size_t>> pageGlyphSizes;
+                       std::vector<uint32_t> pageGlyphIndices;
+                       for (size_t i : rectIndices) {
+                           pageGlyphSizes.push_back(glyphSizes[i]);
+                           if (tileCache) {
+                               pageGlyphIndices.push_back(glyphIndices[i]);
+                           }
+                       }
+                       auto renderPageGlyph = [&](size_t i) -> Image {
+                           std::lock_guard<std::mutex> lock{renderMutex};
+                           return renderGlyph(rectIndices[i]);
+                       };
+                       writeAtlas(pagePacking, renderPageGlyph, pageGlyphSizes, pageGlyphIndices, pageComposition,
+                                  paths[page]);
+                   },
+                   options.memoryBudget > 0 ? 1 : 0);
+    } else {
+        std::unique_ptr<Image> atlas =
+            writeAtlas(p, renderGlyph, glyphSizes, glyphIndices, composition, options.outPath);
+        if (options.createBundle && atlas) {
+            bundleWriter.setAtlas(*atlas);
+        }
+    }
+
+    if (options.createBundle) {
+        bundleWriter.saveBundle(bundlePath);
+    }
+
+    if (options.incremental) {
+        AtlasManifest manifest;
+        manifest.settings = settings;
+        manifest.atlasSize = p.atlasSize;
+        for (size_t i = 0; i < records.size(); i++) {
+            manifest.glyphs.push_back({records[i].charcode, p.rects[i]});
+        }
+        manifest.save(manifestPath);
+    }
+
+    if (options.createFnt) {
+        FntWriter writer{fontFinder.fontFace, fileName(options.outPath), options.fontSize, 1, false};
+        writer.readFont(records);
+        if (isPaged) {
+            std::vector<std::string> pageFiles = pagePaths(options.outPath, pages.pageCount);
+            std::transform(pageFiles.begin(), pageFiles.end(), pageFiles.begin(), fileName);
+            writer.setPageFiles(pageFiles);
+            writer.setAtlasProperties(pages.pageSize, options.fontSize, options.padding);
+            for (size_t i = 0; i < pages.rects.size(); i++) {
+                writer.setCharInfo(records[i], pages.rects[i], {0, 0}, int(pages.pageIndices[i]));
+            }
+        } else {
+            writer.setAtlasProperties(p.atlasSize, options.fontSize, options.padding);
+            for (size_t i = 0; i < p.rects.size(); i++) {
+                writer.setCharInfo(records[i], p.rects[i], {0, 0});
+            }
+        }
+        writer.saveFnt(fntPath, fntFormats[options.fntFormat]);
+    }
+}
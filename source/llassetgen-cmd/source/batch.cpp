@@ -0,0 +1,158 @@
+#include <batch.h>
+#include <jsonreader.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Options of a job in the order they were given, each with its values as on the command line
+using OptionList = std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+void setOption(OptionList& options, const std::string& key, std::vector<std::string> values) {
+    auto it = std::find_if(options.begin(), options.end(),
+                           [&key](const OptionList::value_type& option) { return option.first == key; });
+    if (it != options.end()) {
+        it->second = std::move(values);
+    } else {
+        options.emplace_back(key, std::move(values));
+    }
+}
+
+BatchJob makeJob(const std::string& name, const OptionList& defaults, const OptionList& jobOptions) {
+    OptionList options = defaults;
+    for (const auto& option : jobOptions) {
+        setOption(options, option.first, option.second);
+    }
+
+    // the output file is the positional argument, it goes first so that no list option swallows it
+    BatchJob job{name, {}};
+    for (const auto& option : options) {
+        if (option.first == "outfile") {
+            job.args.insert(job.args.end(), option.second.begin(), option.second.end());
+        }
+    }
+    for (const auto& option : options) {
+        if (option.first == "outfile" || option.second == std::vector<std::string>{"false"}) {
+            continue;
+        }
+        job.args.push_back("--" + option.first);
+        if (option.second != std::vector<std::string>{"true"}) {
+            job.args.insert(job.args.end(), option.second.begin(), option.second.end());
+        }
+    }
+    return job;
+}
+
+std::string trim(const std::string& str) {
+    const auto begin = std::find_if_not(str.begin(), str.end(), [](char c) { return std::isspace(c & 0xff); });
+    const auto end = std::find_if_not(str.rbegin(), str.rend(), [](char c) { return std::isspace(c & 0xff); });
+    return begin < end.base() ? std::string(begin, end.base()) : std::string{};
+}
+
+// Values separated by spaces, double quotes group values with spaces
+std::vector<std::string> splitValues(const std::string& str) {
+    std::vector<std::string> values;
+    std::string value;
+    bool quoted = false, inValue = false;
+    for (char c : str) {
+        if (c == '"') {
+            quoted = !quoted;
+            inValue = true;
+        } else if (!quoted && std::isspace(c & 0xff)) {
+            if (inValue) {
+                values.push_back(value);
+            }
+            value.clear();
+            inValue = false;
+        } else {
+            value += c;
+            inValue = true;
+        }
+    }
+    if (inValue) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+std::vector<BatchJob> loadIni(std::istream& in) {
+    OptionList defaults;
+    std::vector<std::pair<std::string, OptionList>> sections;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(in, line); lineNumber++) {
+        line = trim(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[' && line.back() == ']') {
+            sections.emplace_back(trim(line.substr(1, line.size() - 2)), OptionList{});
+            continue;
+        }
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error("line " + std::to_string(lineNumber) + " of the manifest is no option");
+        }
+        setOption(sections.empty() ? defaults : sections.back().second, trim(line.substr(0, equals)),
+                  splitValues(line.substr(equals + 1)));
+    }
+
+    std::vector<BatchJob> jobs;
+    for (const auto& section : sections) {
+        jobs.push_back(makeJob(section.first, defaults, section.second));
+    }
+    return jobs;
+}
+
+// The options of the object at the position of `reader`
+OptionList readOptions(JsonReader& reader) {
+    OptionList options;
+    reader.readObject([&](const std::string& key) { setOption(options, key, reader.readValues()); });
+    return options;
+}
+
+std::vector<BatchJob> loadJson(std::istream& in) {
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    OptionList defaults;
+    std::vector<std::pair<std::string, OptionList>> jobOptions;
+    JsonReader reader{text, "invalid manifest"};
+    reader.readObject([&](const std::string& key) {
+        if (key == "defaults") {
+            defaults = readOptions(reader);
+        } else if (key == "jobs") {
+            reader.readObject([&](const std::string& name) { jobOptions.emplace_back(name, readOptions(reader)); });
+        } else {
+            throw std::runtime_error("unknown key \"" + key + "\" in the manifest");
+        }
+    });
+    reader.expectEnd();
+
+    std::vector<BatchJob> jobs;
+    for (const auto& job : jobOptions) {
+        jobs.push_back(makeJob(job.first, defaults, job.second));
+    }
+    return jobs;
+}
+
+}  // namespace
+
+std::vector<BatchJob> loadBatchManifest(const std::string& manifestPath) {
+    std::ifstream in{manifestPath};
+    if (!in) {
+        throw std::runtime_error("manifest " + manifestPath + " could not be opened");
+    }
+    const bool isJson =
+        manifestPath.size() >= 5 && manifestPath.compare(manifestPath.size() - 5, 5, ".json") == 0;
+    std::vector<BatchJob> jobs = isJson ? loadJson(in) : loadIni(in);
+    if (jobs.empty()) {
+        throw std::runtime_error("manifest " + manifestPath + " has no jobs");
+    }
+    return jobs;
+}
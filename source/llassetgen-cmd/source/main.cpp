@@ -1,176 +1,164 @@
 #include <CLI11.h>
-#include <codecvt>
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
 #include <ostream>
+#include <sstream>
+#include <thread>
 
 #include <algorithms.h>
+#include <atlas.h>
+#include <batch.h>
 #include <helpstrings.h>
 
 #include <llassetgen/llassetgen.h>
-#include <llassetgen/Atlas.h>
-#include <llassetgen/FntWriter.h>
-#include <llassetgen/FontFinder.h>
+#include <llassetgen/Profiler.h>
 
 using namespace llassetgen;
 
-// all printable ascii characters, except for space
-constexpr char ascii[] =
-    "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
-
-std::u32string UTF8toUCS4(const std::string& str) {
-#if _MSC_VER >= 1900  // handle Visual Studio bug
-    std::wstring_convert<std::codecvt_utf8<uint32_t>, uint32_t> ucs4conv;
-    auto convStr = ucs4conv.from_bytes(str);
-    return std::u32string(reinterpret_cast<const char32_t*>(convStr.data()), convStr.size());
-#else
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> ucs4conv;
-    return ucs4conv.from_bytes(str);
-#endif
-}
-
-std::vector<Vec2<size_t>> sizes(const std::vector<Image>& images, unsigned int downsamplingRatio) {
-    std::vector<Vec2<size_t>> imageSizes(images.size());
-    std::transform(images.begin(), images.end(), imageSizes.begin(),
-                   [downsamplingRatio](const Image& img) { return img.getSize() / downsamplingRatio; });
-    return imageSizes;
-}
-
-std::pair<std::string, std::string> outNames(const std::string& outPath) {
-    std::string pathWithoutExtension;
-    if (outPath.substr(outPath.length() - 4) == ".png") {
-        pathWithoutExtension = outPath.substr(0, outPath.length() - 4);
-    } else {
-        pathWithoutExtension = outPath;
-    }
-    return std::make_pair(pathWithoutExtension + ".png", pathWithoutExtension + ".fnt");
-}
-
-std::set<unsigned long> makeGlyphSet(const std::string& glyphs, const std::vector<unsigned int>& charCodes,
-                                     bool includeAscii) {
-    std::set<unsigned long> set;
-    for (const auto c : UTF8toUCS4(glyphs)) {
-        set.insert(c);
-    }
-
-    for (const auto c : charCodes) {
-        set.insert(c);
-    }
-
-    if (includeAscii) {
-        const char* p = ascii;
-        while (*p) {
-            set.insert(static_cast<unsigned long>(*p++));
-        }
-    }
-    return set;
-}
-
-void checkIfFontSet(CLI::Option* nameOpt, CLI::Option* pathOpt) {
-    if (!static_cast<bool>(*nameOpt) && !static_cast<bool>(*pathOpt)) {
-        throw std::runtime_error("no font specified");
-    }
-}
-
 int parseAtlasArgs(int argc, char **argv) {
     // Example: llassetgen-cmd atlas -d parabola --ascii -f Verdana atlas.png
     CLI::App app{atlasHelp};
 
-    // positional arguments
-    std::string outPath;
-    app.add_option("outfile", outPath, aOutfileHelp)->required();
-
-    // algorithms
-    std::string algorithm;
-    CLI::Option* distfieldOpt = app.add_set("-d, --distfield", algorithm, algoNames(dtAlgos), distfieldHelp);
-
-    std::string packing = "shelf";
-    app.add_set("-k, --packing", packing, algoNames(packingAlgos), packingHelp, true);
+    AtlasOptions options;
+    addAtlasOptions(app, options);
 
-    // glyphs
-    std::string glyphs;
-    app.add_option("-g, --glyph", glyphs, glyphHelp);
+    std::string profilePath;
+    app.add_option("--profile", profilePath, profileHelp);
 
-    std::vector<unsigned int> charCodes;
-    app.add_option("-c, --charcode", charCodes, charcodeHelp);
-
-    bool includeAscii = false;
-    app.add_flag("--ascii", includeAscii, asciiHelp);
-
-    // font
-    unsigned int fontSize = 128;
-    app.add_option("-s, --fontsize", fontSize, fontsizeHelp, true);
-
-    std::string fontName;
-    CLI::Option* fontNameOpt = app.add_option("-f, --fontname", fontName, fontnameHelp);
+    app.set_config("--config", "", configHelp);
 
-    std::string fontPath;
-    CLI::Option* fontPathOpt = app.add_option("--fontpath", fontPath, fontpathHelp)->check(CLI::ExistingFile);
+    CLI11_PARSE(app, argc, argv);
 
-    // other options
-    unsigned int padding = 0;
-    app.add_option("-p, --padding", padding, paddingHelp);
+    try {
+        if (!profilePath.empty()) {
+            Profiler::enable();
+        }
+        buildAtlas(options, openFont, std::cerr);
+        if (!profilePath.empty()) {
+            Profiler::disable();
+            Profiler::writeTrace(profilePath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
 
-    unsigned int downsamplingRatio = 1;
-    app.add_option("-w, --downsampling", downsamplingRatio, downsamplingRatioHelp);
+    return 0;
+}
 
-    std::string downsampling = "center";
-    app.add_set("--dsalgo", downsampling, algoNames(downsamplingAlgos), downsamplingHelp, true);
+int parseBatchArgs(int argc, char **argv) {
+    // Example: llassetgen-cmd batch --jobs 8 atlases.ini
+    CLI::App app{batchHelp};
 
-    std::vector<int> dynamicRange = {-30, 20};
-    app.add_option("-r, --dynamicrange", dynamicRange, dynamicrangeHelp, true)->requires(distfieldOpt)->expected(2);
+    std::string manifestPath;
+    app.add_option("manifest", manifestPath, manifestHelp)->required()->check(CLI::ExistingFile);
 
-    bool createFnt = false;
-    app.add_flag("--fnt", createFnt, fntHelp);
+    unsigned int threadCount = 0;
+    app.add_option("-j, --jobs", threadCount, jobsHelp);
 
-    app.set_config("--config", "", configHelp);
+    std::string profilePath;
+    app.add_option("--profile", profilePath, profileHelp);
 
     CLI11_PARSE(app, argc, argv);
 
-    std::string fntPath;
-    std::tie(outPath, fntPath) = outNames(outPath);
-
-    std::set<unsigned long> glyphSet = makeGlyphSet(glyphs, charCodes, includeAscii);
-    if (glyphSet.empty()) {
-        std::cerr << "Error: at least one glyph required" << std::endl;
+    // Parse the options of all jobs first, so that a mistake in the manifest fails before anything is built.
+    std::vector<BatchJob> jobs;
+    std::vector<AtlasOptions> jobOptions;
+    try {
+        jobs = loadBatchManifest(manifestPath);
+        jobOptions.resize(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            CLI::App jobApp{atlasHelp};
+            addAtlasOptions(jobApp, jobOptions[i]);
+            // CLI11 expects the arguments in reverse
+            std::vector<std::string> args(jobs[i].args.rbegin(), jobs[i].args.rend());
+            try {
+                jobApp.parse(args);
+            } catch (const CLI::Error& e) {
+                throw std::runtime_error("job " + jobs[i].name + ": " + e.what());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 2;
     }
 
-    try {
-        checkIfFontSet(fontNameOpt, fontPathOpt);
-        FontFinder fontFinder = static_cast<bool>(*fontPathOpt) ? FontFinder::fromPath(fontPath)
-                                                               : FontFinder::fromName(fontName);
-
-        std::vector<Image> glyphImages = fontFinder.renderGlyphs(glyphSet, fontSize, padding, downsamplingRatio);
-        std::vector<Vec2<size_t>> imageSizes = sizes(glyphImages, downsamplingRatio);
-        Packing p = packingAlgos[packing](imageSizes.begin(), imageSizes.end(), false);
-
-        if (static_cast<bool>(*distfieldOpt)) {
-            Image atlas = distanceFieldAtlas(glyphImages.begin(), glyphImages.end(), p, dtAlgos[algorithm],
-                                             downsamplingAlgos[downsampling]);
-            atlas.exportPng<DistanceTransform::OutputType>(outPath, -dynamicRange[0], -dynamicRange[1]);
-        } else {
-            Image atlas = fontAtlas(glyphImages.begin(), glyphImages.end(), p);
-            atlas.exportPng<uint8_t>(outPath);
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, jobs.size()));
+    // Concurrent jobs already keep the hardware threads busy, so each transforms its glyphs on one more thread.
+    if (threadCount > 1) {
+        for (AtlasOptions& options : jobOptions) {
+            if (options.transformThreads == 0) {
+                options.transformThreads = 1;
+            }
         }
+    }
+    if (!profilePath.empty()) {
+        Profiler::enable();
+    }
 
-        if (createFnt) {
-            std::string faceName = static_cast<bool>(*fontNameOpt) ? fontName : "Unknown";
-            FntWriter writer{fontFinder.fontFace, faceName, fontSize, 1, false};
-            writer.setAtlasProperties(p.atlasSize, fontSize, padding);
-            writer.readFont(glyphSet.begin(), glyphSet.end());
-            auto gIt = glyphSet.begin();
-            for (auto rectIt = p.rects.begin(); rectIt < p.rects.end(); gIt++, rectIt++) {
-                FT_UInt charIndex = FT_Get_Char_Index(fontFinder.fontFace, static_cast<FT_ULong>(*gIt));
-                writer.setCharInfo(charIndex, *rectIt, {0, 0});
+    // Every worker takes the next job until none are left.
+    FontPool fonts{threadCount};
+    std::atomic<size_t> nextJob{0};
+    std::mutex outputMutex;
+    size_t finishedJobs = 0, failedJobs = 0;
+    const auto batchStart = std::chrono::steady_clock::now();
+    auto work = [&](unsigned int worker) {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            const auto start = std::chrono::steady_clock::now();
+            // warnings are printed with the job, so that those of concurrent jobs do not interleave
+            std::ostringstream warnings;
+            std::string error;
+            try {
+                ProfileScope scope{"batch job"};
+                buildAtlas(jobOptions[i], [&](const AtlasOptions& options) { return fonts.open(options, worker); },
+                           warnings);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard<std::mutex> lock{outputMutex};
+            std::cerr << warnings.str();
+            finishedJobs++;
+            if (error.empty()) {
+                std::cout << "[" << finishedJobs << "/" << jobs.size() << "] " << jobs[i].name << ": " << std::fixed
+                          << std::setprecision(1) << time.count() << " ms" << std::endl;
+            } else {
+                failedJobs++;
+                std::cerr << "[" << finishedJobs << "/" << jobs.size() << "] Error in " << jobs[i].name << ": "
+                          << error << std::endl;
             }
-            writer.saveFnt(fntPath);
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 2;
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int worker = 1; worker < threadCount; worker++) {
+        workers.emplace_back(work, worker);
+    }
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
     }
 
-    return 0;
+    const std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - batchStart;
+    std::cout << "Built " << jobs.size() - failedJobs << " of " << jobs.size() << " atlases in " << std::fixed
+              << std::setprecision(2) << batchTime.count() << " s on " << threadCount
+              << (threadCount == 1 ? " thread" : " threads") << std::endl;
+
+    if (!profilePath.empty()) {
+        Profiler::disable();
+        try {
+            Profiler::writeTrace(profilePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 2;
+        }
+    }
+    return failedJobs > 0 ? 2 : 0;
 }
 
 int parseDistfieldArgs(int argc, char **argv) {
@@ -213,10 +201,12 @@ int main(int argc, char** argv) {
     // pseudo-subcommands to generate a help message, the actual parsing happens in the subcommand functions
     CLI::App* atlas = app.add_subcommand("atlas", atlasHelp)->allow_extras();
     CLI::App* distfield = app.add_subcommand("distfield", dfHelp)->allow_extras();
+    CLI::App* batch = app.add_subcommand("batch", batchHelp)->allow_extras();
 
     atlas->set_help_flag();  // do not let the pseudo-subcommands parse the help flag
                              // let the actual subcommands handle it
     distfield->set_help_flag();
+    batch->set_help_flag();
 
     CLI11_PARSE(app, argc, argv);
     --argc;
@@ -226,6 +216,8 @@ int main(int argc, char** argv) {
         return parseAtlasArgs(argc, argv);
     } else if (app.got_subcommand(distfield)) {
         return parseDistfieldArgs(argc, argv);
+    } else if (app.got_subcommand(batch)) {
+        return parseBatchArgs(argc, argv);
     }
     return app.exit(CLI::CallForHelp());
 }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+/*
+ * llassetgen-client and llassetgen-server talk over a Unix domain socket, one request and one reply per connection.
+ * Both are lists of strings, sent as a little endian 32 bit count followed by every string as a 32 bit length and its
+ * bytes.
+ *
+ * A request is the working directory of the client, a command and its arguments. The commands are `atlas`, which takes
+ * the arguments of `llassetgen-cmd atlas`, `status` and `stop`. A reply is the exit code, the standard output and the
+ * standard error of the command.
+ */
+
+// $XDG_RUNTIME_DIR/llassetgen.sock, or /tmp/llassetgen-<user id>.sock without a runtime directory.
+std::string defaultSocketPath();
+
+// Both throw std::runtime_error if the other side hung up or the message is malformed.
+void sendMessage(int socket, const std::vector<std::string>& message);
+std::vector<std::string> receiveMessage(int socket);
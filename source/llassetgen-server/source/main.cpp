@@ -0,0 +1,197 @@
+#include <CLI11.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <atlas.h>
+#include <helpstrings.h>
+#include <protocol.h>
+
+#include <llassetgen/llassetgen.h>
+
+using namespace llassetgen;
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) { stopRequested = 1; }
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path) {
+        throw std::runtime_error("socket path " + path + " is too long");
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+// Bind the socket, replacing a stale one of a server that did not shut down cleanly, but never a live one.
+int listenOn(const std::string& path) {
+    const sockaddr_un address = socketAddress(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string{"socket could not be created: "} + std::strerror(errno));
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) == 0) {
+        close(fd);
+        throw std::runtime_error("another server is listening on " + path);
+    }
+    close(fd);
+    unlink(path.c_str());
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // only the user running the server may connect, as it writes files wherever it is asked to
+    const mode_t previousMask = umask(0177);
+    const bool bound = bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) == 0;
+    umask(previousMask);
+    if (!bound || listen(fd, 16) != 0) {
+        const std::string reason = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error("could not listen on " + path + ": " + reason);
+    }
+    return fd;
+}
+
+// Everything the server keeps warm between requests.
+struct ServerState {
+    explicit ServerState(size_t cacheBytes) : fonts(1), cache(cacheBytes) {}
+
+    FontPool fonts;
+    AtlasCache cache;
+    size_t requests = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+int runAtlas(const std::string& workingDir, const std::vector<std::string>& args, ServerState& state,
+             std::ostream& out, std::ostream& err) {
+    CLI::App app{atlasHelp};
+    AtlasOptions options;
+    addAtlasOptions(app, options);
+    app.set_config("--config", "", configHelp);
+
+    // named like the subcommand of llassetgen-cmd in the help message
+    std::vector<std::string> argStrings{"atlas"};
+    argStrings.insert(argStrings.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (std::string& arg : argStrings) {
+        argv.push_back(&arg[0]);
+    }
+    try {
+        app.parse(int(argv.size()), argv.data());
+    } catch (const CLI::Error& e) {
+        return app.exit(e, out, err);
+    }
+    // fonts are kept open by path, which must not depend on the directory of the client
+    if (!options.fontPath.empty() && options.fontPath[0] != '/') {
+        options.fontPath = workingDir + "/" + options.fontPath;
+    }
+
+    try {
+        buildAtlas(options, [&state](const AtlasOptions& o) { return state.fonts.open(o, 0); }, err, &state.cache);
+    } catch (const std::exception& e) {
+        err << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+void writeStatus(const ServerState& state, std::ostream& out) {
+    const std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - state.start;
+    out << std::fixed << std::setprecision(2) << "Served " << state.requests << " requests in " << uptime.count()
+        << " s, caching " << state.cache.glyphBytes() / 1048576.0 << " MiB of glyphs and "
+        << state.cache.tiles.sizeBytes() / 1048576.0 << " MiB of distance field tiles" << std::endl;
+}
+
+// Runs a request in the working directory of the client, so that relative paths mean the same as on its command line.
+std::vector<std::string> handleRequest(const std::vector<std::string>& request, ServerState& state) {
+    std::ostringstream out, err;
+    int exitCode = 2;
+    if (request.size() < 2) {
+        err << "Error: malformed request" << std::endl;
+    } else if (chdir(request[0].c_str()) != 0) {
+        err << "Error: the server can not enter " << request[0] << std::endl;
+    } else if (request[1] == "atlas") {
+        const auto start = std::chrono::steady_clock::now();
+        exitCode = runAtlas(request[0], {request.begin() + 2, request.end()}, state, out, err);
+        const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+        std::cout << "atlas" << (exitCode == 0 ? "" : " failed") << ": " << std::fixed << std::setprecision(1)
+                  << time.count() << " ms" << std::endl;
+    } else if (request[1] == "status") {
+        writeStatus(state, out);
+        exitCode = 0;
+    } else if (request[1] == "stop") {
+        stopRequested = 1;
+        exitCode = 0;
+    } else {
+        err << "Error: unknown command " << request[1] << std::endl;
+    }
+    state.requests++;
+    return {std::to_string(exitCode), out.str(), err.str()};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    // Example: llassetgen-server --cache-size 1024
+    CLI::App app{"Build font atlases for llassetgen-client, keeping fonts, glyphs and distance fields warm in memory"};
+
+    std::string socketPath = defaultSocketPath();
+    app.add_option("--socket", socketPath, "Listen on the Unix domain socket at this path", true);
+
+    unsigned int cacheMiB = 512;
+    app.add_option("--cache-size", cacheMiB,
+                   "Keep at most this many MiB of rendered glyphs, and as many of distance field tiles, in memory",
+                   true);
+
+    CLI11_PARSE(app, argc, argv);
+
+    llassetgen::init();
+
+    int listener;
+    try {
+        listener = listenOn(socketPath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+
+    // Stop between requests on SIGINT and SIGTERM. Without SA_RESTART, a pending accept returns with EINTR.
+    struct sigaction action {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Listening on " << socketPath << std::endl;
+    ServerState state{size_t(cacheMiB) << 20};
+    while (!stopRequested) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        try {
+            sendMessage(client, handleRequest(receiveMessage(client), state));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        close(client);
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    std::cout << "Stopped" << std::endl;
+    return 0;
+}
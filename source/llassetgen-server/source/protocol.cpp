@@ -0,0 +1,97 @@
+#include <protocol.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Requests are a few hundred bytes, this only guards against reading garbage from something that is no client.
+constexpr uint32_t maxMessageBytes = 64 << 20;
+
+// A client that hung up must not kill the server with SIGPIPE. Platforms without this flag ignore the signal instead.
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+void readAll(int socket, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t received = recv(socket, data, length, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            throw std::runtime_error("connection closed before the message was complete");
+        }
+        data += received;
+        length -= size_t(received);
+    }
+}
+
+uint32_t readU32(int socket) {
+    unsigned char bytes[4];
+    readAll(socket, reinterpret_cast<char*>(bytes), 4);
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+}  // namespace
+
+std::string defaultSocketPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) {
+        return std::string{runtimeDir} + "/llassetgen.sock";
+    }
+    return "/tmp/llassetgen-" + std::to_string(getuid()) + ".sock";
+}
+
+void sendMessage(int socket, const std::vector<std::string>& message) {
+    std::string data;
+    putU32(data, static_cast<uint32_t>(message.size()));
+    for (const std::string& str : message) {
+        putU32(data, static_cast<uint32_t>(str.size()));
+        data += str;
+    }
+
+    const char* pos = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t sent = send(socket, pos, remaining, sendFlags);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            throw std::runtime_error("connection closed before the message was sent");
+        }
+        pos += sent;
+        remaining -= size_t(sent);
+    }
+}
+
+std::vector<std::string> receiveMessage(int socket) {
+    const uint32_t count = readU32(socket);
+    std::vector<std::string> message;
+    size_t totalBytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t length = readU32(socket);
+        totalBytes += length + 4;
+        if (totalBytes > maxMessageBytes) {
+            throw std::runtime_error("message too large");
+        }
+        std::string str(length, '\0');
+        readAll(socket, &str[0], length);
+        message.push_back(std::move(str));
+    }
+    return message;
+}
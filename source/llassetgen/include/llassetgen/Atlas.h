@@ -2,8 +2,24 @@
 #pragma once
 
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llassetgen/AtlasManifest.h>
+#include <llassetgen/BoundedQueue.h>
 #include <llassetgen/DistanceTransform.h>
 #include <llassetgen/Image.h>
+#include <llassetgen/PngRowWriter.h>
+#include <llassetgen/Profiler.h>
+#include <llassetgen/TileCache.h>
 #include <llassetgen/packing/Types.h>
 
 
@@ -14,6 +30,30 @@ namespace llassetgen
 using ImageTransform = void (*)(Image&, Image&);
 
 
+/*
+ * Stages of the distance field atlas builders that produce glyphs on demand.
+ *
+ * Glyphs are rendered on `renderThreads` threads, transformed, downsampled and quantized on
+ * `transformThreads` threads and copied into the atlas by the calling thread. The stages are
+ * connected by lock-free queues of `queueDepth` glyphs each (rounded up to a power of two), so
+ * rendering overlaps with the distance transforms and at most that many glyphs wait between two
+ * stages. The glyph renderer must be safe to call from several threads at once if
+ * `renderThreads` is larger than 1.
+ */
+struct AtlasPipeline
+{
+    unsigned int renderThreads = 1;
+    // one per hardware thread if 0
+    unsigned int transformThreads = 0;
+    size_t queueDepth = 16;
+
+    unsigned int transformThreadCount() const
+    {
+        return transformThreads > 0 ? transformThreads : std::max(1u, std::thread::hardware_concurrency());
+    }
+};
+
+
 namespace internal
 {
 
@@ -31,12 +71,388 @@ constexpr int checkImageIteratorType()
 }
 
 
+/*
+ * Compose the atlas row by row and pass each row to `writer`.
+ *
+ * `produceTile(i, transientBytes)` must return the content of the i-th Rect with the atlas
+ * bit depth and report the size of any intermediate images it used. It is called when the
+ * first row of the Rect is reached, and the tile is released after its last row was written.
+ * Returns the peak number of bytes held by tiles, the row buffer and intermediate images.
+ */
+template <class TileProducer>
+size_t streamAtlasRows(const Packing & packing, const uint8_t bitDepth, const uint16_t background,
+                       TileProducer produceTile, PngRowWriter & writer)
+{
+    struct ActiveTile
+    {
+        Rect<PackingSizeType> rect;
+        Image tile;
+    };
+
+    std::vector<size_t> order(packing.rects.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&packing](size_t i1, size_t i2) {
+        return packing.rects[i1].position.y < packing.rects[i2].position.y;
+    });
+
+    Image row{packing.atlasSize.x, 1, bitDepth};
+    std::list<ActiveTile> active;
+    size_t tileBytes = 0;
+    size_t peakBytes = row.getByteSize();
+
+    auto next = order.begin();
+    for (PackingSizeType y = 0; y < packing.atlasSize.y; ++y)
+    {
+        for (; next != order.end() && packing.rects[*next].position.y == y; ++next)
+        {
+            const Rect<PackingSizeType>& rect = packing.rects[*next];
+            if (rect.size.x == 0 || rect.size.y == 0)
+            {
+                continue;
+            }
+
+            size_t transientBytes = 0;
+            Image tile = produceTile(*next, transientBytes);
+            peakBytes = std::max(peakBytes, row.getByteSize() + tileBytes + transientBytes + tile.getByteSize());
+            tileBytes += tile.getByteSize();
+            active.push_back({rect, std::move(tile)});
+        }
+
+        row.fillRect<uint16_t>({0, 0}, row.getSize(), background);
+        for (auto it = active.begin(); it != active.end();)
+        {
+            const PackingSizeType tileY = y - it->rect.position.y;
+            Image target = row.view({it->rect.position.x, 0}, {it->rect.position.x + it->rect.size.x, 1});
+            target.copyDataFrom(it->tile.view({0, tileY}, {it->rect.size.x, tileY + 1}));
+
+            if (tileY + 1 == it->rect.size.y)
+            {
+                tileBytes -= it->tile.getByteSize();
+                it = active.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        writer.writeRow(row);
+    }
+
+    writer.finish();
+    return peakBytes;
+}
+
+
+/*
+ * Transform, downsample and quantize a glyph into a 16 bit tile of the given size, the way
+ * Image::exportPng<float> quantizes distance field atlases. Reports the size of the
+ * intermediate images in `transientBytes`.
+ */
+inline Image quantizedDistanceField(Image glyph, const Vec2<PackingSizeType> & size,
+                                    const ImageTransform distanceTransform, const ImageTransform downSampling,
+                                    const DistanceTransform::OutputType black,
+                                    const DistanceTransform::OutputType white, size_t & transientBytes)
+{
+    Image distField{glyph.getWidth(), glyph.getHeight(), DistanceTransform::bitDepth};
+    distanceTransform(glyph, distField);
+
+    Image output{size.x, size.y, DistanceTransform::bitDepth};
+    downSampling(output, distField);
+
+    Image tile{size.x, size.y, 16};
+    tile.quantizeFrom(output, black, white);
+    transientBytes = glyph.getByteSize() + distField.getByteSize() + output.getByteSize();
+    return tile;
+}
+
+
+/*
+ * The cached tile of the i-th Rect, or nothing if there is no `cache` or it misses.
+ */
+inline std::unique_ptr<Image> cachedTile(size_t i, const Packing & packing, const TileCache * cache,
+                                         const std::vector<uint32_t> & glyphIndices)
+{
+    const Vec2<PackingSizeType>& size = packing.rects[i].size;
+    std::unique_ptr<Image> tile;
+    if (cache)
+    {
+        tile.reset(new Image{size.x, size.y, 16});
+        if (!cache->load(glyphIndices[i], *tile))
+        {
+            tile.reset();
+        }
+    }
+    return tile;
+}
+
+/*
+ * Transform the rendered glyph of the i-th Rect with quantizedDistanceField and store the
+ * tile in `cache`.
+ */
+inline Image transformedTile(size_t i, Image glyph, const Packing & packing, const ImageTransform distanceTransform,
+                             const ImageTransform downSampling, const DistanceTransform::OutputType black,
+                             const DistanceTransform::OutputType white, const TileCache * cache,
+                             const std::vector<uint32_t> & glyphIndices, size_t & transientBytes)
+{
+    Image tile = quantizedDistanceField(std::move(glyph), packing.rects[i].size, distanceTransform, downSampling,
+                                        black, white, transientBytes);
+    if (cache)
+    {
+        cache->store(glyphIndices[i], tile);
+    }
+    return tile;
+}
+
+/*
+ * The quantized tile of the i-th Rect. It is taken from `cache` if possible, otherwise the glyph
+ * is rendered, transformed with quantizedDistanceField and stored in `cache`.
+ */
+template <class GlyphRenderer>
+Image distanceFieldTile(size_t i, const Packing & packing, GlyphRenderer & renderGlyph,
+                        const ImageTransform distanceTransform, const ImageTransform downSampling,
+                        const DistanceTransform::OutputType black, const DistanceTransform::OutputType white,
+                        const TileCache * cache, const std::vector<uint32_t> & glyphIndices, size_t & transientBytes)
+{
+    std::unique_ptr<Image> cached = cachedTile(i, packing, cache, glyphIndices);
+    if (cached)
+    {
+        transientBytes = 0;
+        return std::move(*cached);
+    }
+    return transformedTile(i, renderGlyph(i), packing, distanceTransform, downSampling, black, white, cache,
+                           glyphIndices, transientBytes);
+}
+
+
+/*
+ * A glyph on its way through the pipeline: the rendered glyph, or its finished tile.
+ */
+struct GlyphWork
+{
+    size_t index = 0;
+    std::unique_ptr<Image> image;
+    bool isTile = false;
+};
+
+/*
+ * Run the glyphs of the given rects through the stages of `pipeline`.
+ *
+ * `produce(i, work)` puts the rendered glyph of the i-th Rect into `work`, or its finished tile
+ * with `isTile` set, which skips the transform stage. `transform(work)` replaces the glyph with
+ * its tile, and `compose(work)` copies the tile into the atlas on the calling thread. The first
+ * exception thrown by any stage stops all of them and is rethrown.
+ */
+template <class Producer, class Transformer, class Composer>
+void runGlyphPipeline(const std::vector<size_t> & rectIndices, const AtlasPipeline & pipeline, Producer produce,
+                      Transformer transform, Composer compose)
+{
+    const unsigned int renderThreads = std::max(1u, pipeline.renderThreads);
+    const unsigned int transformThreads = pipeline.transformThreadCount();
+    BoundedQueue<GlyphWork> rendered{pipeline.queueDepth};
+    BoundedQueue<GlyphWork> finished{pipeline.queueDepth};
+
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock{errorMutex};
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+        failed = true;
+        rendered.close();
+        finished.close();
+    };
+
+    // the last renderer closes the queue of rendered glyphs, the last of all producers the one of tiles
+    std::atomic<unsigned int> renderersLeft{renderThreads};
+    std::atomic<unsigned int> producersLeft{renderThreads + transformThreads};
+    auto finishProducer = [&]() {
+        if (--producersLeft == 0)
+        {
+            finished.close();
+        }
+    };
+
+    std::atomic<size_t> next{0};
+    auto render = [&]() {
+        try
+        {
+            for (size_t n = next++; n < rectIndices.size() && !failed; n = next++)
+            {
+                GlyphWork work;
+                work.index = rectIndices[n];
+                produce(work.index, work);
+                if (!(work.isTile ? finished.push(work) : rendered.push(work)))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        if (--renderersLeft == 0)
+        {
+            rendered.close();
+        }
+        finishProducer();
+    };
+    auto transformGlyphs = [&]() {
+        try
+        {
+            GlyphWork work;
+            while (!failed && rendered.pop(work))
+            {
+                transform(work);
+                work.isTile = true;
+                if (!finished.push(work))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        finishProducer();
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < renderThreads; ++i)
+    {
+        threads.emplace_back(render);
+    }
+    for (unsigned int i = 0; i < transformThreads; ++i)
+    {
+        threads.emplace_back(transformGlyphs);
+    }
+
+    try
+    {
+        GlyphWork work;
+        while (!failed && finished.pop(work))
+        {
+            compose(work);
+        }
+    }
+    catch (...)
+    {
+        fail();
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/*
+ * Indices of the rects that hold a glyph, optionally skipping the reused ones of an update.
+ */
+inline std::vector<size_t> glyphRects(const Packing & packing, const std::vector<bool> * reused = nullptr)
+{
+    std::vector<size_t> indices;
+    indices.reserve(packing.rects.size());
+    for (size_t i = 0; i < packing.rects.size(); ++i)
+    {
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+        if (rect.size.x > 0 && rect.size.y > 0 && !(reused && (*reused)[i]))
+        {
+            indices.push_back(i);
+        }
+    }
+    return indices;
+}
+
+/*
+ * Quantized distance field tiles of the given rects, copied into a 16 bit `atlas` by the stages
+ * of `pipeline`. Cached tiles are loaded by the render stage and skip the transform stage.
+ */
+template <class GlyphRenderer>
+void composeDistanceFieldTiles(Image & atlas, const Packing & packing, const std::vector<size_t> & rectIndices,
+                               GlyphRenderer & renderGlyph, const ImageTransform distanceTransform,
+                               const ImageTransform downSampling, const DistanceTransform::OutputType black,
+                               const DistanceTransform::OutputType white, const TileCache * cache,
+                               const std::vector<uint32_t> & glyphIndices, const AtlasPipeline & pipeline)
+{
+    runGlyphPipeline(rectIndices, pipeline,
+        [&](size_t i, GlyphWork& work) {
+            work.image = cachedTile(i, packing, cache, glyphIndices);
+            work.isTile = static_cast<bool>(work.image);
+            if (!work.isTile)
+            {
+                work.image.reset(new Image{renderGlyph(i)});
+            }
+        },
+        [&](GlyphWork& work) {
+            size_t transientBytes;
+            work.image.reset(new Image{transformedTile(work.index, std::move(*work.image), packing, distanceTransform,
+                                                       downSampling, black, white, cache, glyphIndices,
+                                                       transientBytes)});
+        },
+        [&](GlyphWork& work) {
+            const Rect<PackingSizeType>& rect = packing.rects[work.index];
+            atlas.view(rect.position, rect.position + rect.size).copyDataFrom(*work.image);
+        });
+}
+
+
+/*
+ * The quantized value of DistanceTransform::backgroundVal, see quantizedDistanceField.
+ */
+inline uint16_t quantizedBackground(const DistanceTransform::OutputType black,
+                                    const DistanceTransform::OutputType white)
+{
+    Image backgroundVal{1, 1, DistanceTransform::bitDepth};
+    backgroundVal.setPixel<DistanceTransform::OutputType>({0, 0}, DistanceTransform::backgroundVal);
+    Image background{1, 1, 16};
+    background.quantizeFrom(backgroundVal, black, white);
+    return background.getPixel<uint16_t>({0, 0});
+}
+
+
 } // namespace
 
 
+/*
+ * Create an atlas from glyphs that are produced on demand, one at a time.
+ *
+ * `renderGlyph(i)` must return the Image for the i-th Rect of the packing. Each Image is
+ * copied into its Rect and released before the next one is requested, so only a single
+ * glyph bitmap is alive at any time.
+ */
+template <class GlyphRenderer>
+Image fontAtlas(const Packing & packing, GlyphRenderer renderGlyph, const uint8_t bitDepth = 1)
+{
+    ProfileScope scope{"font atlas"};
+    scope.setCount("glyphs", packing.rects.size());
+    Image atlas{packing.atlasSize.x, packing.atlasSize.y, bitDepth};
+    atlas.clear();
+
+    for (size_t i = 0; i < packing.rects.size(); ++i)
+    {
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+        Image view = atlas.view(rect.position, rect.position + rect.size);
+        view.copyDataFrom(renderGlyph(i));
+    }
+    return atlas;
+}
+
 template <class ImageIter>
 Image fontAtlas(const ImageIter imgBegin, const ImageIter imgEnd, const Packing & packing, const uint8_t bitDepth = 1)
 {
+    ProfileScope scope{"font atlas"};
+    scope.setCount("glyphs", packing.rects.size());
     internal::checkImageIteratorType<ImageIter>();
     assert(std::distance(imgBegin, imgEnd) == static_cast<typename std::iterator_traits<ImageIter>::difference_type>(packing.rects.size()));
 
@@ -62,6 +478,8 @@ template <class ImageIter>
 Image distanceFieldAtlas(const ImageIter imgBegin, const ImageIter imgEnd, const Packing & packing,
                          const ImageTransform distanceTransform, const ImageTransform downSampling)
 {
+    ProfileScope scope{"distance field atlas"};
+    scope.setCount("glyphs", packing.rects.size());
     internal::checkImageIteratorType<ImageIter>();
     assert(std::distance(imgBegin, imgEnd) == static_cast<typename std::iterator_traits<ImageIter>::difference_type>(packing.rects.size()));
 
@@ -82,4 +500,259 @@ Image distanceFieldAtlas(const ImageIter imgBegin, const ImageIter imgEnd, const
 }
 
 
+/*
+ * Create a distance field atlas from glyphs that are produced on demand.
+ *
+ * `renderGlyph(i)` must return the Image for the i-th Rect of the packing, see the iterator
+ * overload for the downsampling rules. The glyphs are rendered, transformed and copied into
+ * their Rects by the stages of `pipeline`, so peak memory is the atlas plus the glyphs in
+ * flight, see atlasPeakBytes.
+ */
+template <class GlyphRenderer>
+Image distanceFieldAtlas(const Packing & packing, GlyphRenderer renderGlyph, const ImageTransform distanceTransform,
+                         const ImageTransform downSampling, const AtlasPipeline & pipeline = AtlasPipeline{})
+{
+    ProfileScope scope{"distance field atlas"};
+    scope.setCount("glyphs", packing.rects.size());
+    Image atlas{packing.atlasSize.x, packing.atlasSize.y, DistanceTransform::bitDepth};
+    atlas.fillRect({0, 0}, atlas.getSize(), DistanceTransform::backgroundVal);
+
+    internal::runGlyphPipeline(internal::glyphRects(packing), pipeline,
+        [&renderGlyph](size_t i, internal::GlyphWork& work) { work.image.reset(new Image{renderGlyph(i)}); },
+        [&](internal::GlyphWork& work) {
+            Image& glyph = *work.image;
+            Image distField{glyph.getWidth(), glyph.getHeight(), DistanceTransform::bitDepth};
+            distanceTransform(glyph, distField);
+
+            const Vec2<PackingSizeType>& size = packing.rects[work.index].size;
+            work.image.reset(new Image{size.x, size.y, DistanceTransform::bitDepth});
+            downSampling(*work.image, distField);
+        },
+        [&](internal::GlyphWork& work) {
+            const Rect<PackingSizeType>& rect = packing.rects[work.index];
+            atlas.view(rect.position, rect.position + rect.size).copyDataFrom(*work.image);
+        });
+
+    return atlas;
+}
+
+
+/*
+ * Create a 16 bit distance field atlas from glyphs that are produced on demand, quantized like
+ * Image::exportPng<float> quantizes the result of the overload above.
+ *
+ * If a `cache` is given, `glyphIndices[i]` must be the glyph index of the i-th Rect. Tiles found
+ * in the cache are used without rendering their glyphs, all others are stored in it. The cache
+ * is used by the render and transform stages of `pipeline`.
+ */
+template <class GlyphRenderer>
+Image distanceFieldAtlas(const Packing & packing, GlyphRenderer renderGlyph, const ImageTransform distanceTransform,
+                         const ImageTransform downSampling, const DistanceTransform::OutputType black,
+                         const DistanceTransform::OutputType white, const TileCache * cache = nullptr,
+                         const std::vector<uint32_t> & glyphIndices = {},
+                         const AtlasPipeline & pipeline = AtlasPipeline{})
+{
+    ProfileScope scope{"distance field atlas"};
+    scope.setCount("glyphs", packing.rects.size());
+    Image atlas{packing.atlasSize.x, packing.atlasSize.y, 16};
+    atlas.fillRect<uint16_t>({0, 0}, atlas.getSize(), internal::quantizedBackground(black, white));
+    internal::composeDistanceFieldTiles(atlas, packing, internal::glyphRects(packing), renderGlyph, distanceTransform,
+                                        downSampling, black, white, cache, glyphIndices, pipeline);
+    return atlas;
+}
+
+
+/*
+ * Write a font atlas straight to a PNG file, without holding the atlas in memory.
+ *
+ * Glyphs are requested from `renderGlyph(i)` like in the on-demand fontAtlas overload, but
+ * only when the output reaches the first row of their Rect, and are released once the output
+ * has passed their last row. Returns the peak number of bytes used, which never exceeds
+ * streamedAtlasPeakBytes.
+ */
+template <class GlyphRenderer>
+size_t streamFontAtlas(const Packing & packing, GlyphRenderer renderGlyph, const std::string & filepath)
+{
+    ProfileScope scope{"stream font atlas"};
+    scope.setCount("glyphs", packing.rects.size());
+    PngRowWriter writer{filepath, packing.atlasSize.x, packing.atlasSize.y, 1};
+    return internal::streamAtlasRows(packing, 1, 0,
+        [&renderGlyph](size_t i, size_t& transientBytes) {
+            transientBytes = 0;
+            return renderGlyph(i);
+        },
+        writer);
+}
+
+/*
+ * Write a distance field atlas straight to a 16 bit PNG file, without holding the atlas in memory.
+ *
+ * Each glyph is rendered, transformed, downsampled and quantized when the output reaches the
+ * first row of its Rect. Only the quantized tiles crossing the current row are kept, so peak
+ * memory depends on the atlas width and glyph height instead of the glyph count. The output
+ * is identical to exporting the result of distanceFieldAtlas with Image::exportPng<float>.
+ * Returns the peak number of bytes used, which never exceeds streamedAtlasPeakBytes.
+ * See the quantized distanceFieldAtlas overload for `cache` and `glyphIndices`. Unlike there,
+ * glyphs are produced one at a time on the calling thread, which keeps the peak memory this low.
+ */
+template <class GlyphRenderer>
+size_t streamDistanceFieldAtlas(const Packing & packing, GlyphRenderer renderGlyph,
+                                const ImageTransform distanceTransform, const ImageTransform downSampling,
+                                const std::string & filepath, const DistanceTransform::OutputType black,
+                                const DistanceTransform::OutputType white, const TileCache * cache = nullptr,
+                                const std::vector<uint32_t> & glyphIndices = {})
+{
+    ProfileScope scope{"stream distance field atlas"};
+    scope.setCount("glyphs", packing.rects.size());
+    PngRowWriter writer{filepath, packing.atlasSize.x, packing.atlasSize.y, 16};
+    return internal::streamAtlasRows(packing, 16, internal::quantizedBackground(black, white),
+        [&](size_t i, size_t& transientBytes) {
+            return internal::distanceFieldTile(i, packing, renderGlyph, distanceTransform, downSampling, black, white,
+                                               cache, glyphIndices, transientBytes);
+        },
+        writer);
+}
+
+/*
+ * Update a font atlas created from a previous packing to the glyphs of `update`.
+ *
+ * The stale rects are cleared and only the glyphs whose rects are not reused are requested
+ * from `renderGlyph(i)`, the pixels of all other glyphs are kept as they are.
+ */
+template <class GlyphRenderer>
+void updateFontAtlas(Image & atlas, const IncrementalPacking & update, GlyphRenderer renderGlyph)
+{
+    ProfileScope scope{"update font atlas"};
+    scope.setCount("glyphs", update.packing.rects.size());
+    for (const Rect<PackingSizeType>& stale : update.staleRects)
+    {
+        atlas.fillRect<uint8_t>(stale.position, stale.position + stale.size, 0);
+    }
+
+    const Packing& packing = update.packing;
+    for (size_t i = 0; i < packing.rects.size(); ++i)
+    {
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+        if (update.reused[i] || rect.size.x == 0 || rect.size.y == 0)
+        {
+            continue;
+        }
+        Image view = atlas.view(rect.position, rect.position + rect.size);
+        view.copyDataFrom(renderGlyph(i));
+    }
+}
+
+/*
+ * Update a quantized distance field atlas, as exported by streamDistanceFieldAtlas or
+ * Image::exportPng<float> and loaded with a bit depth of 16, see updateFontAtlas.
+ *
+ * Only the new glyphs are transformed. `black` and `white` must be the values the atlas
+ * was quantized with. See the quantized distanceFieldAtlas overload for `cache`, `glyphIndices`
+ * and `pipeline`.
+ */
+template <class GlyphRenderer>
+void updateDistanceFieldAtlas(Image & atlas, const IncrementalPacking & update, GlyphRenderer renderGlyph,
+                              const ImageTransform distanceTransform, const ImageTransform downSampling,
+                              const DistanceTransform::OutputType black, const DistanceTransform::OutputType white,
+                              const TileCache * cache = nullptr, const std::vector<uint32_t> & glyphIndices = {},
+                              const AtlasPipeline & pipeline = AtlasPipeline{})
+{
+    ProfileScope scope{"update distance field atlas"};
+    scope.setCount("glyphs", update.packing.rects.size());
+    const uint16_t background = internal::quantizedBackground(black, white);
+    for (const Rect<PackingSizeType>& stale : update.staleRects)
+    {
+        atlas.fillRect<uint16_t>(stale.position, stale.position + stale.size, background);
+    }
+
+    internal::composeDistanceFieldTiles(atlas, update.packing, internal::glyphRects(update.packing, &update.reused),
+                                        renderGlyph, distanceTransform, downSampling, black, white, cache,
+                                        glyphIndices, pipeline);
+}
+
+/*
+ * Build every page of a paged atlas, several pages at a time.
+ *
+ * `buildPage(page, packing, rectIndices)` is called once for every page, with the packing of the page
+ * and the index of each of its rects in `paged.rects`, see PagedPacking::page. The pages are built on up
+ * to `threadCount` threads, one per hardware thread if 0, so `buildPage` and the glyph renderers it uses
+ * must be safe to call for different pages at the same time. If building a page throws, the pages that
+ * have not been started yet are skipped and the first exception is rethrown.
+ */
+template <class PageBuilder>
+void buildPages(const PagedPacking & paged, PageBuilder buildPage, unsigned int threadCount = 0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, paged.pageCount));
+
+    std::atomic<size_t> nextPage{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto work = [&]() {
+        std::vector<size_t> rectIndices;
+        for (size_t page = nextPage++; page < paged.pageCount; page = nextPage++)
+        {
+            try
+            {
+                ProfileScope scope{"page"};
+                scope.setCount("page", page);
+                const Packing packing = paged.page(page, rectIndices);
+                buildPage(page, packing, rectIndices);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{errorMutex};
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                nextPage = paged.pageCount;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * Upper bound for the memory needed to create and export an atlas in memory.
+ *
+ * @param glyphSizes
+ *   Sizes of the glyph Images before downsampling, in packing order.
+ * @param distanceField
+ *   Whether a distance field atlas is created, as opposed to a plain font atlas.
+ * @param pipeline
+ *   Stages the distance field atlas is built with. Every glyph that is rendered, waits in a
+ *   queue or is transformed adds to the peak.
+ */
+LLASSETGEN_API size_t atlasPeakBytes(const Packing & packing, const std::vector<Vec2<size_t>> & glyphSizes,
+                                     bool distanceField, const AtlasPipeline & pipeline = AtlasPipeline{});
+
+/**
+ * Upper bound for the memory needed by streamFontAtlas and streamDistanceFieldAtlas.
+ *
+ * Includes the intermediate images of one glyph and the scratch buffers of the distance
+ * transforms. See atlasPeakBytes for the parameters.
+ */
+LLASSETGEN_API size_t streamedAtlasPeakBytes(const Packing & packing, const std::vector<Vec2<size_t>> & glyphSizes,
+                                             bool distanceField);
+
+
 } // namespace llassetgen
@@ -0,0 +1,92 @@
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Everything besides the glyph set that determines the pixels of an atlas.
+ * Glyphs of a previous atlas can only be reused if all settings are equal.
+ */
+struct LLASSETGEN_API AtlasSettings
+{
+    uint64_t fontHash = 0;            // FontSource::contentHash of the font file
+    unsigned int fontSize = 0;
+    unsigned int padding = 0;
+    unsigned int downsampling = 1;
+    std::string downsamplingAlgorithm;
+    std::string distanceTransform;    // empty for plain font atlases
+    int dynamicRangeMin = 0;
+    int dynamicRangeMax = 0;
+    std::string packing;
+
+    bool operator==(const AtlasSettings& other) const;
+    bool operator!=(const AtlasSettings& other) const;
+};
+
+
+struct ManifestGlyph
+{
+    unsigned long charcode;
+    Rect<PackingSizeType> rect;
+};
+
+
+/*
+ * Sidecar file of an atlas that records how it was created, so that a later
+ * run can update the atlas instead of building it from scratch.
+ *
+ * The manifest is a small text file with one setting per line, followed by
+ * one "glyph <charcode> <x> <y> <width> <height>" line per glyph.
+ */
+class LLASSETGEN_API AtlasManifest
+{
+public:
+    AtlasSettings settings;
+    Vec2<PackingSizeType> atlasSize{};
+    std::vector<ManifestGlyph> glyphs;
+
+    /*
+     * Throws a std::runtime_error if the file can not be read or is malformed.
+     */
+    static AtlasManifest load(const std::string& filepath);
+
+    void save(const std::string& filepath) const;
+};
+
+
+/*
+ * Packing of an atlas update, see incrementalPacking.
+ */
+struct IncrementalPacking
+{
+    Packing packing;
+    std::vector<bool> reused;                          // whether rect i already holds its glyph
+    std::vector<Rect<PackingSizeType>> staleRects;     // rects of previous glyphs that are not reused
+};
+
+
+/*
+ * Pack glyphs into the atlas described by a previous manifest.
+ *
+ * Glyphs that are in the manifest with an unchanged rect size keep their
+ * rects, the remaining ones are placed into the free space around them with
+ * the max rects algorithm, without growing the atlas. If they do not fit, the
+ * returned packing has no rects and the atlas has to be packed from scratch.
+ * The settings of the manifest are not checked.
+ */
+LLASSETGEN_API IncrementalPacking incrementalPacking(const AtlasManifest& previous,
+                                                     const std::vector<unsigned long>& charcodes,
+                                                     const std::vector<Vec2<PackingSizeType>>& rectSizes);
+
+
+} // namespace llassetgen
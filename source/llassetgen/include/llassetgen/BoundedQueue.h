@@ -0,0 +1,200 @@
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Lock-free queue of a fixed capacity for any number of producer and consumer threads.
+ *
+ * Every slot carries a sequence number that tells producers and consumers whose turn it is,
+ * so pushing and popping never take a lock (D. Vyukov's bounded MPMC queue). The capacity is
+ * rounded up to a power of two of at least 2, as a single slot could not tell full from free.
+ * T must be default constructible and movable.
+ *
+ * push and pop wait while the queue is full or empty, spinning briefly and then sleeping.
+ * Once the queue is closed, push fails and pop fails as soon as the queue is empty, which
+ * ends the consumers after the last producer closed the queue, or all stages on an error.
+ */
+template <class T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    : mask(capacityFor(capacity) - 1)
+    , cells(new Cell[mask + 1])
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+    /*
+     * Move `value` into the queue. Returns false, leaving `value` untouched, if the queue is full.
+     */
+    bool tryPush(T & value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Move the oldest element into `value`. Returns false if the queue is empty.
+     */
+    bool tryPop(T & value)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Wait until `value` fits into the queue. Returns false if the queue was closed instead.
+     */
+    bool push(T & value)
+    {
+        for (unsigned int attempt = 0; !closed.load(std::memory_order_acquire); ++attempt)
+        {
+            if (tryPush(value))
+            {
+                return true;
+            }
+            backOff(attempt);
+        }
+        return false;
+    }
+
+    /*
+     * Wait for the next element. Returns false once the queue is closed and empty.
+     */
+    bool pop(T & value)
+    {
+        for (unsigned int attempt = 0;; ++attempt)
+        {
+            if (tryPop(value))
+            {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire))
+            {
+                // elements pushed right before closing are still delivered
+                return tryPop(value);
+            }
+            backOff(attempt);
+        }
+    }
+
+    void close()
+    {
+        closed.store(true, std::memory_order_release);
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /*
+     * The capacity of a queue constructed with the given one.
+     */
+    static size_t capacityFor(size_t capacity)
+    {
+        size_t power = 2;
+        while (power < capacity)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Waiting stages spin for short stalls, but must not steal the CPU from the stage they wait for.
+    static void backOff(unsigned int attempt)
+    {
+        if (attempt < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    // on separate cache lines, so that producers and consumers do not slow each other down
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    std::atomic<bool> closed{false};
+};
+
+
+} // namespace llassetgen
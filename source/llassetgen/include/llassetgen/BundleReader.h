@@ -0,0 +1,211 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Layout of a font asset bundle, as written by BundleWriter.
+ *
+ * A bundle is meant to be memory-mapped and used in place: all sections
+ * start at 8 byte aligned offsets given in the header and consist of the
+ * fixed-size records below, stored in little endian byte order. Glyphs are
+ * sorted by codepoint and found through a minimal perfect hash, kerning
+ * pairs are sorted by their codepoints.
+ *
+ * This header has no dependencies on the rest of the library, so renderers
+ * can include it on its own.
+ */
+namespace bundle
+{
+
+
+constexpr char magic[4] = {'L', 'L', 'F', 'B'};
+constexpr uint32_t version = 1;
+
+
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t glyphCount;
+    uint32_t kerningCount;
+    uint32_t bucketCount;     // buckets of the perfect hash
+    uint32_t hashSeed;
+    float fontSize;           // size the glyphs were rendered at, in pixels
+    float lineHeight;         // in atlas pixels, like all following metrics
+    float base;
+    uint32_t atlasWidth;
+    uint32_t atlasHeight;
+    uint32_t atlasBitDepth;   // 8 or 16, 0 if the bundle holds no pixels
+    uint64_t glyphOffset;     // Glyph[glyphCount]
+    uint64_t bucketOffset;    // uint32_t[bucketCount], displacement seed of each bucket
+    uint64_t slotOffset;      // uint32_t[glyphCount], glyph index of each hash slot
+    uint64_t kerningOffset;   // Kerning[kerningCount]
+    uint64_t atlasOffset;     // atlasWidth * atlasHeight pixels, rows top to bottom
+};
+
+
+struct Glyph
+{
+    uint32_t codepoint;
+    uint32_t gindex;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    float xOffset;            // from the pen position to the left edge of the glyph's rect
+    float yOffset;            // from the base line's top to the top edge of the glyph's rect
+    float xAdvance;
+    uint32_t page;
+};
+
+
+struct Kerning
+{
+    uint32_t first;
+    uint32_t second;
+    float amount;
+};
+
+
+static_assert(sizeof(Header) == 88, "bundle header must not contain padding");
+static_assert(sizeof(Glyph) == 40, "bundle glyphs must not contain padding");
+static_assert(sizeof(Kerning) == 12, "bundle kernings must not contain padding");
+
+
+/*
+ * Hash of a codepoint for a given seed, the finalizer of MurmurHash3.
+ */
+inline uint32_t hash(uint32_t codepoint, uint32_t seed)
+{
+    uint32_t h = codepoint ^ (seed * 0x9e3779b9u);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+
+} // namespace bundle
+
+
+/*
+ * Read-only view of a bundle in memory, typically a memory mapping of the
+ * file. The view does not copy or own the data.
+ */
+class BundleReader
+{
+public:
+    BundleReader(const void* data, size_t size)
+    : bytes(static_cast<const uint8_t*>(data))
+    , size(size)
+    {
+        if (size < sizeof(bundle::Header) || reinterpret_cast<uintptr_t>(data) % 8 != 0)
+        {
+            return;
+        }
+        header = reinterpret_cast<const bundle::Header*>(bytes);
+        if (std::memcmp(header->magic, bundle::magic, 4) != 0 || header->version != bundle::version ||
+            !fits(header->glyphOffset, header->glyphCount, sizeof(bundle::Glyph)) ||
+            !fits(header->bucketOffset, header->bucketCount, sizeof(uint32_t)) ||
+            !fits(header->slotOffset, header->glyphCount, sizeof(uint32_t)) ||
+            !fits(header->kerningOffset, header->kerningCount, sizeof(bundle::Kerning)) ||
+            !fits(header->atlasOffset, uint64_t(header->atlasWidth) * header->atlasHeight, header->atlasBitDepth / 8) ||
+            (header->glyphCount > 0 && header->bucketCount == 0))
+        {
+            header = nullptr;
+        }
+    }
+
+    bool isValid() const
+    {
+        return header != nullptr;
+    }
+
+    const bundle::Header& info() const
+    {
+        return *header;
+    }
+
+    const bundle::Glyph* glyphs() const
+    {
+        return reinterpret_cast<const bundle::Glyph*>(bytes + header->glyphOffset);
+    }
+
+    const bundle::Kerning* kernings() const
+    {
+        return reinterpret_cast<const bundle::Kerning*>(bytes + header->kerningOffset);
+    }
+
+    /*
+     * The glyph of a codepoint, or nullptr if the bundle does not contain it.
+     */
+    const bundle::Glyph* findGlyph(uint32_t codepoint) const
+    {
+        if (header->glyphCount == 0)
+        {
+            return nullptr;
+        }
+        const uint32_t* seeds = reinterpret_cast<const uint32_t*>(bytes + header->bucketOffset);
+        const uint32_t* slots = reinterpret_cast<const uint32_t*>(bytes + header->slotOffset);
+        uint32_t bucket = bundle::hash(codepoint, header->hashSeed) % header->bucketCount;
+        uint32_t slot = bundle::hash(codepoint, seeds[bucket]) % header->glyphCount;
+        const bundle::Glyph* glyph = glyphs() + slots[slot] % header->glyphCount;
+        return glyph->codepoint == codepoint ? glyph : nullptr;
+    }
+
+    /*
+     * Kerning between two codepoints in atlas pixels, 0 if the pair is not kerned.
+     */
+    float kerning(uint32_t first, uint32_t second) const
+    {
+        const bundle::Kerning* begin = kernings();
+        size_t lo = 0, hi = header->kerningCount;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            const bundle::Kerning& pair = begin[mid];
+            if (pair.first < first || (pair.first == first && pair.second < second))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo < header->kerningCount && begin[lo].first == first && begin[lo].second == second
+                   ? begin[lo].amount
+                   : 0.f;
+    }
+
+    /*
+     * Atlas pixels, or nullptr if the bundle holds none.
+     */
+    const void* atlasPixels() const
+    {
+        return header->atlasBitDepth ? bytes + header->atlasOffset : nullptr;
+    }
+
+private:
+    bool fits(uint64_t offset, uint64_t count, uint64_t elementSize) const
+    {
+        return offset % 8 == 0 && offset <= size && count * elementSize <= size - offset;
+    }
+
+    const uint8_t* bytes;
+    size_t size;
+    const bundle::Header* header = nullptr;
+};
+
+
+} // namespace llassetgen
@@ -0,0 +1,61 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <llassetgen/BundleReader.h>
+#include <llassetgen/GlyphRecord.h>
+#include <llassetgen/Image.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Writes a font asset bundle that BundleReader can use in place, see
+ * BundleReader.h for the layout. Unlike FNT files, all metrics are in atlas
+ * pixels and kerning pairs are keyed by codepoint.
+ */
+class LLASSETGEN_API BundleWriter
+{
+public:
+    BundleWriter(FT_Face face, unsigned int fontSize);
+
+    /*
+     * Take the glyphs and their rects in the atlas, and read the kerning
+     * pairs between them. `padding` and `divisibleBy` are the values the
+     * glyphs were recorded and rendered with. Throws if two glyphs have
+     * the same codepoint.
+     */
+    void setGlyphs(const std::vector<GlyphRecord>& records, const Packing& packing, size_t padding = 0,
+                   size_t divisibleBy = 1);
+
+    /*
+     * Store the atlas pixels in the bundle. Images of up to 8 bits are
+     * scaled to 8 bits, 16 bit images are stored as they are.
+     */
+    void setAtlas(const Image& atlas);
+
+    void saveBundle(const std::string& filepath);
+
+private:
+    void buildHash();
+
+    const FT_Face face;
+    const unsigned int fontSize;
+    bundle::Header header;
+    std::vector<bundle::Glyph> glyphs;
+    std::vector<bundle::Kerning> kernings;
+    std::vector<uint32_t> bucketSeeds;
+    std::vector<uint32_t> slots;
+    std::vector<uint8_t> atlasPixels;
+};
+
+
+} // namespace llassetgen
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+
+#include <llassetgen/FntWriter.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Reads FNT files in the text or binary format, as written by FntWriter,
+ * so that the layout of an existing atlas can be reused.
+ *
+ * The whole file is read at once and parsed in place, without iostreams.
+ * The format is detected from the file's first bytes; malformed files throw
+ * a std::runtime_error.
+ */
+class LLASSETGEN_API FntReader
+{
+public:
+    explicit FntReader(const std::string & filepath);
+
+    FntFormat format() const;
+    const Info & info() const;
+    const Common & common() const;
+    const std::vector<std::string> & pages() const;
+    const std::vector<CharInfo> & chars() const;
+    const std::vector<KerningInfo> & kernings() const;
+
+    /*
+     * The atlas size and the rect of every char, in the order of chars().
+     */
+    Packing packing() const;
+
+private:
+    void parseText(const std::string & data);
+    void parseBinary(const std::string & data);
+
+    FntFormat fntFormat;
+    Info fontInfo;
+    Common fontCommon;
+    std::vector<std::string> pageFiles;
+    std::vector<CharInfo> charInfos;
+    std::vector<KerningInfo> kerningInfos;
+};
+
+
+} // namespace llassetgen
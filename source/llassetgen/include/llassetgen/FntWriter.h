@@ -9,6 +9,7 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <llassetgen/GlyphRecord.h>
 #include <llassetgen/Image.h>
 #include <llassetgen/packing/Types.h>
 
@@ -78,22 +79,48 @@ struct KerningInfo
 };
 
 
+enum class FntFormat
+{
+    Text,
+    Binary,  // BMFont binary format, version 3
+    Xml,
+    Json
+};
+
+
 class LLASSETGEN_API FntWriter
 {
 public:
     FntWriter(FT_Face face, const std::string & faceName, unsigned int fontSize, float scalingFactor, bool scaledGlyph);
     void readFont(std::set<FT_ULong>::iterator charcodesBegin, std::set<FT_ULong>::iterator charcodesEnd);
+    void readFont(const std::vector<GlyphRecord> & records);
     void setAtlasProperties(const Vec2<PackingSizeType> & size, int maxHeight, int padding);
-    void saveFnt(const std::string & filepath);
-    void setCharInfo(FT_UInt charcode, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset);
+    void saveFnt(const std::string & filepath, FntFormat format = FntFormat::Text);
+
+    // One texture file per atlas page, replaces the single page named after the face name.
+    void setPageFiles(const std::vector<std::string> & files);
+
+    // `page` is the index of the atlas page in the page files.
+    void setCharInfo(FT_UInt charcode, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset,
+                     int page = 0);
+
+    // Uses the metrics captured in the record and does not touch the face.
+    void setCharInfo(const GlyphRecord & record, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset,
+                     int page = 0);
 
 private:
     void setFontInfo();
-    void setKerningInfo(std::set<FT_ULong>::iterator charcodesBegin, std::set<FT_ULong>::iterator charcodesEnd);
+    void setKerningInfo(const std::vector<FT_UInt> & gindices);
+    void saveTextFnt(const std::string & filepath);
+    void saveBinaryFnt(const std::string & filepath);
+    void saveXmlFnt(const std::string & filepath);
+    void saveJsonFnt(const std::string & filepath);
+    void addCharInfo(FT_UInt gindex, FT_Fixed linearHoriAdvance, FT_Pos yBearing,
+                     const Rect<PackingSizeType> & charArea, const Vec2<float> & offset, int page);
 
 private:
     const FT_Face face;
-    const std::string faceName;
+    std::vector<std::string> pageFiles;
     Info fontInfo;
     Common fontCommon;
     std::vector<CharInfo> charInfos;
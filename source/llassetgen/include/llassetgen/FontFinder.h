@@ -1,18 +1,17 @@
 
 #pragma once
 
-#include <string>
-#ifdef _WIN32
-#include <vector>
-#endif
-
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include <llassetgen/llassetgen_api.h>
+#include <llassetgen/FontSource.h>
+#include <llassetgen/GlyphRecord.h>
 #include <llassetgen/Image.h>
 
 
@@ -25,27 +24,76 @@ class LLASSETGEN_API FontFinder
 public:
     static FontFinder fromName(const std::string& fontName);
     static FontFinder fromPath(const std::string& fontPath);
+    static FontFinder fromSource(std::shared_ptr<const FontSource> fontSource, long faceIndex = 0);
+
+    /**
+     * Persist font name resolutions of `fromName` to the given file.
+     *
+     * The cache is invalidated whenever the system font configuration
+     * changes. Only used on platforms that resolve names with fontconfig.
+     */
+    static void setFontCacheFile(const std::string& cacheFile);
 
     void setFontSize(int size);
     Image renderGlyph(unsigned long glyph, size_t padding, size_t divisibleBy);
 
+    /*
+     * Render a glyph into an Image of a previously computed size. Bitmaps that turn out
+     * larger or smaller than expected are cropped or padded at the bottom right.
+     */
+    Image renderGlyph(unsigned long glyph, size_t padding, size_t divisibleBy, const Vec2<size_t>& size);
+
+    /*
+     * Size of the Image that renderGlyph would return, computed from the glyph outline
+     * without rasterizing it.
+     */
+    Vec2<size_t> glyphSize(unsigned long glyph, size_t padding, size_t divisibleBy);
+
+    /*
+     * Glyph index, metrics and bitmap bounds of a glyph, read with a single glyph load.
+     * The record's size is what glyphSize returns. A glyph the font does not contain
+     * gets index 0, the font's missing glyph, which callers may warn about.
+     */
+    GlyphRecord glyphRecord(unsigned long glyph, size_t padding, size_t divisibleBy);
+
+    /*
+     * Render a recorded glyph into an Image of the record's size, without looking up
+     * its glyph index again.
+     */
+    Image renderGlyph(const GlyphRecord& record, size_t padding, size_t divisibleBy);
+
     std::vector<Image> renderGlyphs(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
                                     size_t divisibleBy = 1);
 
+    /*
+     * Character codes of all glyphs in the font's active charmap.
+     */
+    std::set<unsigned long> allGlyphs() const;
+
+    std::vector<Vec2<size_t>> glyphSizes(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
+                                         size_t divisibleBy = 1);
+
+    std::vector<GlyphRecord> glyphRecords(const std::set<unsigned long>& glyphs, int size, size_t padding = 0,
+                                          size_t divisibleBy = 1);
+
     FT_Face fontFace;
+    std::shared_ptr<const FontSource> source;
 
 private:
     FontFinder() = default;
 
+    // Closes fontFace once the last copy is gone, before the source it reads from.
+    std::shared_ptr<FT_FaceRec> face;
+
 #ifdef _WIN32
-    bool getFontData(const std::string& fontName);
+    static bool getFontData(const std::string& fontName, std::vector<FT_Byte>& fontData);
 #elif defined(__unix__) || defined(__APPLE__)
     static bool findFontPath(const std::string& fontName, std::string& fontPath);
 #endif
 
-#ifdef _WIN32
-    std::vector<FT_Byte> fontData;
-#endif
+    FT_UInt glyphIndex(unsigned long glyph) const;
+    Image renderIndex(FT_UInt charIndex, unsigned long glyph, size_t padding, size_t divisibleBy);
+    static Image fitImage(Image rendered, const Vec2<size_t>& size);
 };
 
 } // namespace llassetgen
@@ -0,0 +1,73 @@
+#pragma once
+
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <llassetgen/llassetgen_api.h>
+
+
+namespace llassetgen
+{
+
+
+/**
+ * Read-only font file contents shared by any number of faces.
+ *
+ * Files are memory-mapped once and every face is opened with
+ * `FT_New_Memory_Face` on the mapping, so multiple faces, sizes and threads
+ * work on the same copy of the font data instead of each doing its own
+ * stream reads. Sources created from the same path are shared as long as
+ * one of them is alive.
+ */
+class LLASSETGEN_API FontSource
+{
+public:
+    static std::shared_ptr<const FontSource> fromFile(const std::string& fontPath);
+    static std::shared_ptr<const FontSource> fromMemory(std::vector<FT_Byte> fontData);
+
+    ~FontSource();
+    FontSource(const FontSource&) = delete;
+    FontSource& operator=(const FontSource&) = delete;
+
+    const FT_Byte* data() const;
+    size_t size() const;
+    const std::string& path() const;
+
+    /**
+     * 64 bit FNV-1a hash of the font data, to recognize unchanged fonts
+     * across runs. Reads the whole file on every call.
+     */
+    uint64_t contentHash() const;
+
+    /**
+     * Open a new FreeType face on the shared data.
+     *
+     * The returned face must not outlive this source and is released with
+     * closeFace. Opening and closing faces is safe from multiple threads,
+     * using a face is not.
+     */
+    FT_Face openFace(long faceIndex = 0) const;
+
+    static void closeFace(FT_Face face);
+
+private:
+    FontSource() = default;
+
+    std::string filePath;
+    const FT_Byte* mappedData = nullptr;
+    size_t mappedSize = 0;
+    std::vector<FT_Byte> ownedData;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+
+} // namespace llassetgen
@@ -0,0 +1,37 @@
+#pragma once
+
+
+#include <cstddef>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <llassetgen/Geometry.h>
+
+
+namespace llassetgen
+{
+
+
+/**
+ * Everything the atlas and FNT stages need to know about a glyph, captured
+ * from a single FreeType glyph load.
+ *
+ * Once recorded, the glyph can be rendered by its index and its FNT entry
+ * written without looking it up in the face again.
+ */
+struct GlyphRecord
+{
+    unsigned long charcode;
+    FT_UInt gindex;
+
+    FT_Fixed linearHoriAdvance;  // 16.16, unhinted
+    FT_Pos vertBearingY;         // 26.6
+
+    Vec2<FT_Int> bitmapOrigin;   // left and top of the bitmap relative to the pen position, in pixels
+    Vec2<size_t> bitmapSize;     // size of the bitmap FreeType renders, in pixels
+    Vec2<size_t> size;           // size of the rendered Image, including padding
+};
+
+
+} // namespace llassetgen
@@ -33,7 +33,6 @@ class LLASSETGEN_API Image
     LLASSETGEN_NO_EXPORT static void readData(png_struct_def* png, uint8_t* data, size_t length);
     LLASSETGEN_NO_EXPORT static void writeData(png_struct_def* png, uint8_t* data, size_t length);
     LLASSETGEN_NO_EXPORT static void flushData(png_struct_def* png);
-    LLASSETGEN_NO_EXPORT static size_t divisiblePadding(size_t size, size_t padding, size_t divisor);
 
     LLASSETGEN_NO_EXPORT void fillPadding(Rect<size_t> image);
 
@@ -47,10 +46,13 @@ public:
     Image(FT_Bitmap_ bitmap, size_t padding = 0, size_t divisibleBy = 1);
     Image view(Vec2<size_t> _min, Vec2<size_t> _max, size_t padding = 0) const;
 
+    static size_t divisiblePadding(size_t size, size_t padding, size_t divisor);
+
     size_t getWidth() const;
     size_t getHeight() const;
     size_t getBitDepth() const;
     Vec2<size_t> getSize() const;
+    size_t getByteSize() const;
 
     bool isValid(Vec2<size_t> pos) const;
     template <typename pixelType>
@@ -63,6 +65,13 @@ public:
     void clear() const;
     void copyDataFrom(const Image& copy);
 
+    /*
+     * Fill this 16 bit Image with the values of `src`, scaled so that `black` maps to 0 and
+     * `white` to the maximum value. Uses the same mapping as exportPng.
+     */
+    template <typename pixelType>
+    void quantizeFrom(const Image& src, pixelType black, pixelType white) const;
+
     template <typename pixelType>
     void centerDownsampling(const Image& src) const;
     template <typename pixelType>
@@ -71,6 +80,11 @@ public:
     void minDownsampling(const Image& src) const;
 
     void load(const FT_Bitmap_& ft_bitmap);
+
+    /*
+     * Read and write grayscale PNG files. A file that can not be opened, read
+     * or written throws std::runtime_error.
+     */
     Image(const std::string& filepath, uint8_t _bitDepth = 0);
     template <typename pixelType>
     void exportPng(const std::string& filepath,
@@ -0,0 +1,40 @@
+#pragma once
+
+
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <llassetgen/llassetgen_api.h>
+
+
+namespace llassetgen
+{
+
+
+struct KerningPair
+{
+    FT_UInt left;
+    FT_UInt right;
+    FT_Pos amount;  // unscaled, in font units
+};
+
+
+/**
+ * Enumerate the kerning pairs of a face whose glyphs are both in `glyphs`.
+ *
+ * SFNT fonts are read straight from their `kern` table, as `FT_Get_Kerning`
+ * does, or from the pair adjustments of the `kern` feature in `GPOS` if the
+ * font has no `kern` table. Only the pairs stored in the font are visited, so
+ * the cost grows with the number of pairs instead of with the square of the
+ * glyph count. Other formats fall back to probing `FT_Get_Kerning` for every
+ * pair of distinct glyph indices.
+ *
+ * The pairs are sorted by left, then right glyph index and have a nonzero
+ * amount.
+ */
+LLASSETGEN_API std::vector<KerningPair> kerningPairs(FT_Face face, const std::vector<FT_UInt>& glyphs);
+
+
+} // namespace llassetgen
@@ -0,0 +1,50 @@
+#pragma once
+
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <llassetgen/Image.h>
+#include <llassetgen/llassetgen_api.h>
+
+
+struct png_struct_def;
+struct png_info_def;
+
+
+namespace llassetgen
+{
+
+
+/**
+ * Write a grayscale PNG file one row at a time.
+ *
+ * Used to export images that are never held in memory as a whole. Rows are
+ * given as single row Images with the bit depth passed to the constructor
+ * (1, 2, 4, 8 or 16 bits).
+ */
+class LLASSETGEN_API PngRowWriter
+{
+public:
+    PngRowWriter(const std::string& filepath, size_t width, size_t height, uint8_t bitDepth);
+    ~PngRowWriter();
+    PngRowWriter(const PngRowWriter&) = delete;
+    PngRowWriter& operator=(const PngRowWriter&) = delete;
+
+    void writeRow(const Image& row);
+    void finish();
+
+private:
+    std::FILE* file;
+    png_struct_def* png;
+    png_info_def* info;
+    size_t width;
+    size_t height;
+    size_t rowsWritten;
+    uint8_t bitDepth;
+    std::vector<uint8_t> rowBuffer;
+};
+
+
+} // namespace llassetgen
@@ -0,0 +1,143 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+
+
+namespace llassetgen
+{
+
+
+/**
+ * All recorded events of one name, e.g. all "render glyph" events.
+ */
+struct ProfileStage
+{
+    std::string name;
+    size_t calls;
+    double seconds;
+    uint64_t imageBytes;
+};
+
+
+/**
+ * Records the wall time of the stages of an atlas build, e.g. font lookup,
+ * glyph rendering, packing, distance transforms, downsampling, PNG encoding
+ * and FNT writing, and exports them as a Chrome trace.
+ *
+ * Recording is off by default. While it is off, a ProfileScope costs a
+ * single relaxed atomic load. Each thread that records an event gets its own
+ * track in the trace, the thread that enabled recording is named "main".
+ */
+class LLASSETGEN_API Profiler
+{
+public:
+    /**
+     * Start recording, dropping all events recorded so far.
+     */
+    static void enable();
+
+    static void disable();
+
+    static bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Count the bytes of an image allocated on this thread. Each event reports
+     * the image bytes allocated on its thread while it lasted.
+     */
+    static void countImageBytes(size_t bytes)
+    {
+        if (isEnabled())
+        {
+            addImageBytes(bytes);
+        }
+    }
+
+    /**
+     * Write all recorded events in the Chrome trace event format, which
+     * chrome://tracing and Perfetto can open.
+     */
+    static void writeTrace(const std::string& filepath);
+
+    /**
+     * Sum up the recorded events by name, in the order their names first
+     * occurred. Nested stages are contained in the time of their parents.
+     */
+    static std::vector<ProfileStage> stages();
+
+private:
+    static void addImageBytes(size_t bytes);
+
+    static std::atomic<bool> enabled;
+};
+
+
+/**
+ * Records the time from its construction to its destruction as an event in
+ * the Profiler, if recording is enabled.
+ *
+ * Scopes can be nested. `name` must outlive the Profiler, e.g. be a string
+ * literal.
+ */
+class LLASSETGEN_API ProfileScope
+{
+public:
+    explicit ProfileScope(const char* _name)
+    {
+        if (Profiler::isEnabled())
+        {
+            begin(_name);
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (name)
+        {
+            end();
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    /**
+     * Attach a number to the event, e.g. the number of glyphs of a stage or
+     * the glyph index of a per glyph event. `countName` must be a string
+     * literal as well.
+     */
+    void setCount(const char* countName, uint64_t value)
+    {
+        if (name)
+        {
+            count = {countName, value};
+        }
+    }
+
+private:
+    void begin(const char* _name);
+    void end();
+
+    struct Count
+    {
+        const char* name;
+        uint64_t value;
+    };
+
+    const char* name = nullptr;
+    Count count = {nullptr, 0};
+    int64_t start = 0;
+    uint64_t startImageBytes = 0;
+};
+
+
+} // namespace llassetgen
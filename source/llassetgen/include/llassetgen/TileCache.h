@@ -0,0 +1,120 @@
+#pragma once
+
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/AtlasManifest.h>
+#include <llassetgen/Image.h>
+
+
+namespace llassetgen
+{
+
+
+/*
+ * Quantized distance field tiles kept in memory, shared by the TileCaches of
+ * any number of atlases within one long-running process.
+ *
+ * Holds at most `capacityBytes` of pixels. When full, the least recently used
+ * tiles are dropped first. Thread-safe.
+ */
+class LLASSETGEN_API TileMemory
+{
+public:
+    explicit TileMemory(size_t capacityBytes);
+
+    TileMemory(const TileMemory &) = delete;
+    TileMemory & operator=(const TileMemory &) = delete;
+
+    /*
+     * Copy the tile stored under `key` into `tile`, a 16 bit Image of the
+     * expected size. Returns false if no tile of that size is stored.
+     */
+    bool load(const std::string & key, Image & tile);
+
+    void store(const std::string & key, const Image & tile);
+
+    /*
+     * Bytes of pixels currently held.
+     */
+    size_t sizeBytes() const;
+
+private:
+    struct Tile
+    {
+        std::string key;
+        size_t width;
+        size_t height;
+        std::vector<uint16_t> pixels;
+    };
+
+    LLASSETGEN_NO_EXPORT void evict();
+
+    mutable std::mutex mutex;
+    // most recently used first
+    std::list<Tile> tiles;
+    std::unordered_map<std::string, std::list<Tile>::iterator> index;
+    size_t capacityBytes;
+    size_t usedBytes = 0;
+};
+
+
+/*
+ * Directory of quantized distance field tiles, shared by any number of runs
+ * and processes on one machine.
+ *
+ * A tile is addressed by the glyph index and every setting that affects its
+ * pixels: the font hash, size, padding, downsampling ratio and algorithm,
+ * distance transform and dynamic range. The packing setting is ignored.
+ * Tiles are stored zlib compressed, one file per tile. Files are written to
+ * a temporary name and renamed into place, so concurrent runs never see
+ * partially written tiles.
+ *
+ * With a TileMemory, tiles are looked up in memory before the directory and
+ * stored in both. Without a directory, tiles are only kept in memory.
+ */
+class LLASSETGEN_API TileCache
+{
+public:
+    /*
+     * Creates the directory if it does not exist yet. `directory` may be
+     * empty if a `memory` is given.
+     */
+    TileCache(const std::string & directory, const AtlasSettings & settings, TileMemory * memory = nullptr);
+
+    /*
+     * Read the cached tile of a glyph into `tile`, a 16 bit Image of the
+     * expected size. Returns false if no tile of that size is cached.
+     */
+    bool load(uint32_t glyphIndex, Image & tile) const;
+
+    /*
+     * Store the 16 bit tile of a glyph. Failing to write is not an error,
+     * the tile will just be computed again next time.
+     */
+    void store(uint32_t glyphIndex, const Image & tile) const;
+
+    /*
+     * The file that holds the tile of a glyph, whether it is cached or not.
+     */
+    std::string tilePath(uint32_t glyphIndex) const;
+
+private:
+    bool loadFile(const std::string & key, Image & tile) const;
+    void storeFile(const std::string & key, const Image & tile) const;
+    std::string key(uint32_t glyphIndex) const;
+    std::string path(const std::string & key) const;
+
+    std::string directory;
+    AtlasSettings settings;
+    TileMemory * memory;
+};
+
+
+} // namespace llassetgen
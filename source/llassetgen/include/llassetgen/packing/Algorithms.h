@@ -5,9 +5,11 @@
 #include <cassert>
 
 #include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/BestPacking.h>
 #include <llassetgen/packing/internal/Common.h>
 #include <llassetgen/packing/internal/MaxRectsPacker.h>
 #include <llassetgen/packing/internal/ShelfPacker.h>
+#include <llassetgen/packing/internal/SkylinePacker.h>
 
 
 namespace llassetgen
@@ -112,5 +114,173 @@ Packing maxRectsPackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<Packing
     return internal::packAtlas<internal::MaxRectsPacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize);
 }
 
+/**
+ * Use the skyline algorithm to pack a texture atlas.
+ *
+ * See the fixed size overload for a description of the algorithm.
+ *
+ * @param sizesBegin
+ *   Begin iterator for the sizes of the input rectangles. This iterators
+ *   items must be convertible to `Vec2<PackingSizeType>`.
+ * @param sizesEnd
+ *   End iterator for the rectangle sizes.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @return
+ *   Resulting packing.
+ */
+template <class InputIter>
+Packing skylinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations)
+{
+    return internal::packAtlas<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations);
+}
+
+/**
+ * Use the skyline algorithm to pack a fixed size texture atlas.
+ *
+ * Only the upper outline of the placed rectangles is tracked. Each rectangle
+ * is placed as low as possible on it, and where it leaves the least unusable
+ * space below itself on ties (Skyline-BL with the waste of Skyline-MW as tie
+ * breaker, see (Jylänki, 2010)). This gets close to the density of max rects,
+ * while each placement only takes time linear in the length of the skyline.
+ *
+ * @param sizesBegin
+ *   Begin iterator for the sizes of the input rectangles. This iterators
+ *   items must be convertible to `Vec2<PackingSizeType>`.
+ * @param sizesEnd
+ *   End iterator for the rectangle sizes.
+ * @param fixedAtlasSize
+ *   Size of the atlas to pack into.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @return
+ *   Resulting packing. If the given rectangles can't be fit into the atlas
+ *   size, the list of rectangles will be empty.
+ */
+template <class InputIter>
+Packing skylinePackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> fixedAtlasSize,
+                         bool allowRotations)
+{
+    return internal::packAtlas<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations, fixedAtlasSize);
+}
+
+/**
+ * Try several variants of the max rects algorithm to pack a texture atlas.
+ *
+ * See the fixed size overload for a description of the algorithm.
+ *
+ * @param sizesBegin
+ *   Begin iterator for the sizes of the input rectangles. This iterators
+ *   items must be convertible to `Vec2<PackingSizeType>`.
+ * @param sizesEnd
+ *   End iterator for the rectangle sizes.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @return
+ *   Resulting packing, with the smallest atlas of all variants.
+ */
+template <class InputIter>
+Packing bestPackAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations)
+{
+    Packing packing = internal::initPacking(sizesBegin, sizesEnd);
+    packing.atlasSize = internal::predictAtlasSize(packing);
+    return internal::packBest(packing, allowRotations, true);
+}
+
+/**
+ * Try several variants of the max rects algorithm to pack a fixed size
+ * texture atlas.
+ *
+ * Every combination of a rule for choosing free space (best short side,
+ * best long side and best area fit, bottom left and contact point) and an
+ * input sort order (shortest side, longest side, height, area and perimeter
+ * descending) is packed at the same time, one per hardware thread, and the
+ * densest packing is kept. Ties are broken in a fixed order, so the result
+ * is deterministic. This takes about 25 times the work of maxRectsPackAtlas,
+ * and most variants compare each rectangle against all free space, so it is
+ * meant for glyph sets of up to a few thousand rectangles. See
+ * internal::packBest.
+ *
+ * @param sizesBegin
+ *   Begin iterator for the sizes of the input rectangles. This iterators
+ *   items must be convertible to `Vec2<PackingSizeType>`.
+ * @param sizesEnd
+ *   End iterator for the rectangle sizes.
+ * @param fixedAtlasSize
+ *   Size of the atlas to pack into.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @return
+ *   Resulting packing, with the smallest bounding box of all variants. If
+ *   no variant fits the given rectangles into the atlas size, the list of
+ *   rectangles will be empty.
+ */
+template <class InputIter>
+Packing bestPackAtlas(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> fixedAtlasSize,
+                      bool allowRotations)
+{
+    Packing packing = internal::initPacking(sizesBegin, sizesEnd);
+    packing.atlasSize = fixedAtlasSize;
+    return internal::packBest(packing, allowRotations, false);
+}
+
+/**
+ * Pack a texture atlas into as many pages of a fixed size as needed.
+ *
+ * Each page is packed like a fixed size atlas with the shelf next fit
+ * algorithm, and every rectangle is placed on the first page with enough
+ * space left, see internal::packPages.
+ *
+ * @param sizesBegin
+ *   Begin iterator for the sizes of the input rectangles. This iterators
+ *   items must be convertible to `Vec2<PackingSizeType>`.
+ * @param sizesEnd
+ *   End iterator for the rectangle sizes.
+ * @param pageSize
+ *   Size of every page, e.g. the maximum texture size of the target hardware.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @return
+ *   Resulting packing. If a rectangle is larger than a page, the list of
+ *   rectangles will be empty.
+ */
+template <class InputIter>
+PagedPacking shelfPackPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> pageSize,
+                            bool allowRotations)
+{
+    return internal::packPages<internal::ShelfPacker>(sizesBegin, sizesEnd, allowRotations, pageSize);
+}
+
+/**
+ * Pack a texture atlas into as many pages of a fixed size as needed, see shelfPackPages.
+ */
+template <class InputIter>
+PagedPacking maxRectsPackPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> pageSize,
+                               bool allowRotations)
+{
+    return internal::packPages<internal::MaxRectsPacker>(sizesBegin, sizesEnd, allowRotations, pageSize);
+}
+
+/**
+ * Pack a texture atlas into as many pages of a fixed size as needed, see shelfPackPages.
+ */
+template <class InputIter>
+PagedPacking skylinePackPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> pageSize,
+                              bool allowRotations)
+{
+    return internal::packPages<internal::SkylinePacker>(sizesBegin, sizesEnd, allowRotations, pageSize);
+}
+
+/**
+ * Pack a texture atlas into as few pages of a fixed size as several variants
+ * of the max rects algorithm manage, see bestPackAtlas and shelfPackPages.
+ */
+template <class InputIter>
+PagedPacking bestPackPages(InputIter sizesBegin, InputIter sizesEnd, Vec2<PackingSizeType> pageSize,
+                           bool allowRotations)
+{
+    return internal::packBestPages(internal::initPacking(sizesBegin, sizesEnd), allowRotations, pageSize);
+}
+
 
 } // namespace llassetgen
@@ -0,0 +1,155 @@
+#pragma once
+
+
+#include <cstddef>
+
+#include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/MaxRectsPacker.h>
+#include <llassetgen/packing/internal/ShelfPacker.h>
+
+
+namespace llassetgen
+{
+
+
+/**
+ * Place rectangles one at a time into an atlas that is kept around, e.g. the
+ * glyph atlas of a text renderer that adds glyphs when they are first shown
+ * and removes them when they are no longer needed.
+ *
+ * Unlike the packing algorithms, which sort all rectangles before packing
+ * them, rectangles are placed in the order they are inserted. This packs less
+ * densely, but each insertion only takes a few microseconds.
+ *
+ * @tparam Packer
+ *   Packer class, see internal::packAtlas. Must additionally provide
+ *   `void release(const Rect<PackingSizeType>& rect)`, which returns the
+ *   space of a packed rectangle.
+ */
+template <class Packer>
+class AtlasAllocator
+{
+public:
+    /**
+     * @param atlasSize
+     *   Size of the atlas, or its initial size if it may grow.
+     * @param allowRotations
+     *   Whether to allow rotating rectangles by 90˚.
+     * @param allowGrowth
+     *   Whether to double the atlas size when a rectangle does not fit.
+     */
+    explicit AtlasAllocator(const Vec2<PackingSizeType>& atlasSize, bool allowRotations = false,
+                            bool allowGrowth = false)
+    : packer{atlasSize, allowRotations, allowGrowth}
+    , allowRotations_{allowRotations}
+    , allowGrowth_{allowGrowth}
+    {
+    }
+
+    /**
+     * Place a rectangle of the given size.
+     *
+     * @param size
+     *   Size of the rectangle.
+     * @param rect
+     *   Receives the placed rectangle. Its size is rotated if the rectangle
+     *   was rotated.
+     * @return
+     *   False if the atlas has no space left for the rectangle, `rect` is not
+     *   changed then.
+     */
+    bool insert(const Vec2<PackingSizeType>& size, Rect<PackingSizeType>& rect)
+    {
+        Rect<PackingSizeType> placed{{0, 0}, size};
+        if (!packer.pack(placed))
+        {
+            return false;
+        }
+
+        rect = placed;
+        usedArea_ += size.x * size.y;
+        ++rectCount_;
+        return true;
+    }
+
+    /**
+     * Remove a rectangle and return its space to the atlas. It must have been
+     * returned by insert and not been removed since. Once the last rectangle
+     * is removed, the whole atlas can be used again.
+     */
+    void remove(const Rect<PackingSizeType>& rect)
+    {
+        if (--rectCount_ == 0)
+        {
+            clear();
+            return;
+        }
+
+        packer.release(rect);
+        usedArea_ -= rect.size.x * rect.size.y;
+    }
+
+    /**
+     * Remove all rectangles. The atlas keeps its current size.
+     */
+    void clear()
+    {
+        packer = Packer{packer.atlasSize(), allowRotations_, allowGrowth_};
+        usedArea_ = 0;
+        rectCount_ = 0;
+    }
+
+    Vec2<PackingSizeType> atlasSize() const
+    {
+        return packer.atlasSize();
+    }
+
+    /**
+     * Number of rectangles in the atlas.
+     */
+    size_t rectCount() const
+    {
+        return rectCount_;
+    }
+
+    /**
+     * Area covered by the rectangles in the atlas.
+     */
+    PackingSizeType usedArea() const
+    {
+        return usedArea_;
+    }
+
+    /**
+     * Fraction of the atlas area that is covered by rectangles, from 0 to 1.
+     */
+    double occupancy() const
+    {
+        const Vec2<PackingSizeType> size = packer.atlasSize();
+        return size.x == 0 || size.y == 0 ? 0. : double(usedArea_) / (double(size.x) * double(size.y));
+    }
+
+private:
+    Packer packer;
+    bool allowRotations_;
+    bool allowGrowth_;
+    PackingSizeType usedArea_ = 0;
+    size_t rectCount_ = 0;
+};
+
+
+/**
+ * Allocator that places each rectangle into the best fitting free space, see
+ * maxRectsPackAtlas. Removed rectangles leave space that can be used again.
+ */
+using MaxRectsAtlasAllocator = AtlasAllocator<internal::MaxRectsPacker>;
+
+/**
+ * Allocator that places the rectangles next to each other on shelves, see
+ * shelfPackAtlas. The space of removed rectangles can only be used again if
+ * they were the last ones placed, or once the atlas is empty.
+ */
+using ShelfAtlasAllocator = AtlasAllocator<internal::ShelfPacker>;
+
+
+} // namespace llassetgen
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+
+
+/**
+ * Fixed size overload of a packing algorithm, e.g. `maxRectsPackAtlas`.
+ */
+using FixedSizePackingAlgorithm = Packing (*)(std::vector<Vec2<PackingSizeType>>::const_iterator,
+                                              std::vector<Vec2<PackingSizeType>>::const_iterator,
+                                              Vec2<PackingSizeType>, bool);
+
+
+/**
+ * Search for the atlas size with the smallest area that a packing algorithm
+ * fits the given rectangles into.
+ *
+ * The flexible size algorithms only produce power of two sizes and double
+ * one side whenever a rectangle does not fit, which can leave nearly half
+ * of the atlas empty. Instead, for a range of widths around the square root
+ * of the rectangle area, the smallest height that fits is binary searched.
+ * The widths are tried at the same time on up to `threadCount` threads, one
+ * per hardware thread if 0. Ties are broken in favour of the squarer, then
+ * the narrower atlas, so the result does not depend on the number of
+ * threads. The power of two size is always a candidate, so the result is
+ * never larger.
+ *
+ * @param rectSizes
+ *   Sizes of the rectangles to pack.
+ * @param algorithm
+ *   Fixed size packing algorithm to use.
+ * @param allowRotations
+ *   Whether to allow rotating rectangles by 90˚.
+ * @param alignment
+ *   Both sides of the atlas are multiples of this, e.g. 4 for block
+ *   compressed textures.
+ * @return
+ *   Resulting packing.
+ */
+LLASSETGEN_API Packing packSmallestAtlas(const std::vector<Vec2<PackingSizeType>>& rectSizes,
+                                         FixedSizePackingAlgorithm algorithm, bool allowRotations,
+                                         PackingSizeType alignment = 1, unsigned int threadCount = 0);
+
+
+} // namespace llassetgen
@@ -2,6 +2,7 @@
 #pragma once
 
 
+#include <algorithm>
 #include <vector>
 
 #include <llassetgen/Geometry.h>
@@ -27,6 +28,64 @@ public:
     std::vector<Rect<PackingSizeType>> rects{};
 
     Packing() = default;
+
+    /*
+     * Shrink the atlas to the bounding box of the rectangles, rounded up to a
+     * multiple of `alignment` unless that is larger than the atlas.
+     */
+    void crop(PackingSizeType alignment = 1)
+    {
+        Vec2<PackingSizeType> used{1, 1};
+        for (const auto& rect : rects)
+        {
+            used.x = std::max(used.x, rect.position.x + rect.size.x);
+            used.y = std::max(used.y, rect.position.y + rect.size.y);
+        }
+
+        alignment = std::max<PackingSizeType>(alignment, 1);
+        atlasSize.x = std::min(atlasSize.x, (used.x + alignment - 1) / alignment * alignment);
+        atlasSize.y = std::min(atlasSize.y, (used.y + alignment - 1) / alignment * alignment);
+    }
+};
+
+
+/*
+ * Describes the packing of a texture atlas that is split into pages of the
+ * same size.
+ *
+ * The rectangles in `rects` correspond to the input rectangles like in
+ * Packing. Their positions are relative to the page at the same position
+ * in `pageIndices`.
+ */
+struct PagedPacking
+{
+public:
+    Vec2<PackingSizeType> pageSize{};
+    size_t pageCount = 0;
+    std::vector<Rect<PackingSizeType>> rects{};
+    std::vector<size_t> pageIndices{};
+
+    PagedPacking() = default;
+
+    /*
+     * The packing of a single page. `rectIndices` receives the index in
+     * `rects` of each of its rectangles.
+     */
+    Packing page(size_t page, std::vector<size_t>& rectIndices) const
+    {
+        Packing packing;
+        packing.atlasSize = pageSize;
+        rectIndices.clear();
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            if (pageIndices[i] == page)
+            {
+                packing.rects.push_back(rects[i]);
+                rectIndices.push_back(i);
+            }
+        }
+        return packing;
+    }
 };
 
 
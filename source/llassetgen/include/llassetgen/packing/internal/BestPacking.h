@@ -0,0 +1,49 @@
+#pragma once
+
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+/**
+ * Pack with the max rects algorithm once for every combination of a
+ * heuristic and an input sort order and keep the packing with the smallest
+ * atlas.
+ *
+ * The combinations are packed at the same time on up to `threadCount`
+ * threads, one per hardware thread if 0. Ties are broken by the area of the
+ * bounding box of the rectangles, then by a fixed order of the combinations
+ * that starts with the one of maxRectsPackAtlas. So the result does not
+ * depend on the number of threads, and is never larger than that of plain
+ * max rects.
+ *
+ * @param packing
+ *   Rectangles to pack, and the fixed or initial atlas size.
+ * @param allowGrowth
+ *   Whether to grow the atlas when the rectangles do not fit.
+ * @return
+ *   If no combination fits the rectangles into a fixed size atlas, the list
+ *   of rectangles will be empty.
+ */
+LLASSETGEN_API Packing packBest(const Packing& packing, bool allowRotations, bool allowGrowth,
+                                unsigned int threadCount = 0);
+
+/**
+ * Pack into pages of a fixed size like packPages, once for every
+ * combination of packBest, and keep the packing with the fewest pages.
+ *
+ * Ties are broken by the summed up areas of the bounding boxes of the
+ * rectangles on each page, then by the order of the combinations.
+ */
+LLASSETGEN_API PagedPacking packBestPages(const Packing& packing, bool allowRotations,
+                                          const Vec2<PackingSizeType>& pageSize, unsigned int threadCount = 0);
+
+
+} // namespace internal
+} // namespace llassetgen
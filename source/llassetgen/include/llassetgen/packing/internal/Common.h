@@ -3,13 +3,18 @@
 
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iterator>
-#include <numeric>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include <llassetgen/llassetgen_api.h>
+#include <llassetgen/Profiler.h>
 #include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/CompactRects.h>
 
 
 namespace llassetgen
@@ -79,6 +84,40 @@ LLASSETGEN_API unsigned int ceilLog2(uint64_t num);
 LLASSETGEN_API Vec2<PackingSizeType> predictAtlasSize(const Packing& packing);
 
 
+/**
+ * Call `func(i)` for every i from 0 to `count` - 1, on up to `threadCount`
+ * threads, one per hardware thread if 0. `func` must not throw.
+ */
+template <class Func>
+void parallelFor(size_t count, unsigned int threadCount, Func func)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, count));
+
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
 /**
  * Given rect sizes, create a packing with rectangles with those sizes.
  */
@@ -98,15 +137,35 @@ Packing initPacking(InputIter sizesBegin, InputIter sizesEnd) {
 }
 
 
+/**
+ * Sort keys of the rects of a packing, see sortDescending.
+ */
+template <class SortKey>
+std::vector<uint64_t> sortKeys(const Packing& packing, SortKey sortKey)
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(packing.rects.size());
+    for (const auto& rect : packing.rects)
+    {
+        keys.push_back(sortKey(rect.size));
+    }
+    return keys;
+}
+
+
+template <class Packer, class SortKey>
+bool packAll(Packing& packing, Packer& packer, SortKey sortKey) {
+    ProfileScope scope{"pack"};
+    scope.setCount("rects", packing.rects.size());
+    const std::vector<uint32_t> order = sortDescending(sortKeys(packing, sortKey));
+    return std::all_of(std::begin(order), std::end(order),
+                       [&](uint32_t i) { return packer.pack(packing.rects[i]); });
+}
+
+
 template <class Packer>
 bool packAll(Packing& packing, Packer& packer) {
-    std::vector<size_t> indices(packing.rects.size());
-    std::iota(indices.begin(), indices.end(), 0);
-    std::sort(indices.begin(), indices.end(), [&packing](size_t i1, size_t i2) {
-        return Packer::inputSortingComparator(packing.rects[i1], packing.rects[i2]);
-    });
-    return std::all_of(std::begin(indices), std::end(indices),
-                       [&](size_t i) { return packer.pack(packing.rects[i]); });
+    return packAll(packing, packer, Packer::inputSortingKey);
 }
 
 
@@ -116,10 +175,10 @@ bool packAll(Packing& packing, Packer& packer) {
  * @tparam Packer
  *   Packer class. Must provide the following methods:
  *    - `Packer(const Vec2<PackingSizeType>& initialAtlasSize, bool allowRotations, bool allowGrowth)`
- *    - `static bool inputSortingComparator(const Rect<PackingSizeType>& rect1,
- *                                          const Rect<PackingSizeType>& * rect2)`:
+ *    - `static uint64_t inputSortingKey(const Vec2<PackingSizeType>& size)`:
  *      Used to sort the input rectangles before packing. The input
- *      rectangles will be passed to `pack` ordered by this comparator.
+ *      rectangles will be passed to `pack` from the largest key to the
+ *      smallest, rectangles with equal keys in input order.
  *    - `bool pack(Rect<PackingSizeType>& rect)`: Packs the rectangle at
  *      a position, the size is pre-filled. Returns false if the space
  *      is insufficient.
@@ -173,6 +232,82 @@ Packing packAtlas(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
 }
 
 
+/**
+ * Pack rectangles into pages in the order of the given sort key.
+ *
+ * @param packerArgs
+ *   Arguments passed to the constructor of each page's packer after the
+ *   usual ones.
+ */
+template <class Packer, class SortKey, class... PackerArgs>
+PagedPacking packPages(Packing packing, bool allowRotations, const Vec2<PackingSizeType>& pageSize, SortKey sortKey,
+                       PackerArgs... packerArgs)
+{
+    ProfileScope scope{"pack pages"};
+    scope.setCount("rects", packing.rects.size());
+    const std::vector<uint32_t> order = sortDescending(sortKeys(packing, sortKey));
+
+    PagedPacking paged;
+    paged.pageSize = pageSize;
+    paged.pageIndices.resize(packing.rects.size());
+
+    std::vector<Packer> packers;
+    for (uint32_t i : order)
+    {
+        Rect<PackingSizeType>& rect = packing.rects[i];
+        size_t page = 0;
+        for (; page < packers.size(); ++page)
+        {
+            // Packers may change the rectangle even if it does not fit
+            Rect<PackingSizeType> candidate = rect;
+            if (packers[page].pack(candidate))
+            {
+                rect = candidate;
+                break;
+            }
+        }
+
+        if (page == packers.size())
+        {
+            packers.emplace_back(pageSize, allowRotations, false, packerArgs...);
+            if (!packers.back().pack(rect))
+            {
+                paged.pageIndices.clear();
+                return paged;
+            }
+        }
+        paged.pageIndices[i] = page;
+    }
+
+    paged.pageCount = packers.size();
+    paged.rects = std::move(packing.rects);
+    return paged;
+}
+
+
+/**
+ * Create a packing with as many fixed size pages as needed from given
+ * rectangle sizes.
+ *
+ * The rectangles are passed to the packers in the order of their sort key
+ * and placed on the first page they fit on. A new page is only added when
+ * none of the previous ones has enough space left.
+ *
+ * @tparam Packer
+ *   Refer to flexible size overload of packAtlas.
+ * @return
+ *   If a rectangle does not even fit on an empty page, the list of
+ *   rectangles will be empty.
+ */
+template <class Packer, class InputIter>
+PagedPacking packPages(InputIter sizesBegin, InputIter sizesEnd, bool allowRotations,
+                       const Vec2<PackingSizeType>& pageSize)
+{
+    return packPages<Packer>(initPacking(sizesBegin, sizesEnd), allowRotations, pageSize,
+                             Packer::inputSortingKey);
+}
+
+
 class LLASSETGEN_API BasePacker
 {
 public:
@@ -0,0 +1,91 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+/**
+ * List of rects with 32 bit coordinates, stored as one array per coordinate.
+ *
+ * A Rect<PackingSizeType> takes 32 bytes, a rect in this list 16, and loops
+ * that only compare sizes read 8 bytes per rect. Rects are converted to and
+ * from Rect<PackingSizeType> on access. Coordinates that do not fit into
+ * 32 bits throw std::runtime_error.
+ */
+struct LLASSETGEN_API CompactRects
+{
+    using Coordinate = uint32_t;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+
+    bool empty() const
+    {
+        return x.empty();
+    }
+
+    Rect<PackingSizeType> operator[](size_t i) const
+    {
+        return {{x[i], y[i]}, {width[i], height[i]}};
+    }
+
+    Rect<PackingSizeType> back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    void set(size_t i, const Rect<PackingSizeType>& rect);
+    void push_back(const Rect<PackingSizeType>& rect);
+    void swap(size_t i1, size_t i2);
+    void resize(size_t count);
+    void reserve(size_t count);
+    void clear();
+
+    std::vector<Coordinate> x;
+    std::vector<Coordinate> y;
+    std::vector<Coordinate> width;
+    std::vector<Coordinate> height;
+};
+
+
+/**
+ * Convert a coordinate to 32 bits, throws std::runtime_error if it does not fit.
+ */
+LLASSETGEN_API CompactRects::Coordinate compactCoordinate(PackingSizeType value);
+
+
+/**
+ * Order of the given keys from largest to smallest, equal keys in the order
+ * they are given.
+ *
+ * Radix sorts the keys together with their indices, 8 bits per pass. Passes
+ * over bits that are the same in all keys are skipped, so small keys only
+ * take a few passes.
+ */
+LLASSETGEN_API std::vector<uint32_t> sortDescending(const std::vector<uint64_t>& keys);
+
+
+/**
+ * Two coordinates in one sort key, ordered by `high` first.
+ */
+inline uint64_t sortKey(PackingSizeType high, PackingSizeType low)
+{
+    return (static_cast<uint64_t>(compactCoordinate(high)) << 32) | compactCoordinate(low);
+}
+
+
+} // namespace internal
+} // namespace llassetgen
@@ -3,11 +3,17 @@
 
 
 #include <algorithm>
+#include <cstdint>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include <llassetgen/llassetgen_api.h>
 #include <llassetgen/packing/Types.h>
 #include <llassetgen/packing/internal/Common.h>
+#include <llassetgen/packing/internal/CompactRects.h>
+#include <llassetgen/packing/internal/RectGrid.h>
+#include <llassetgen/packing/internal/SizeIndex.h>
 
 
 namespace llassetgen
@@ -16,27 +22,110 @@ namespace internal
 {
 
 
+/**
+ * Rules for choosing the free rect a rect is placed in, see (Jylänki, 2010).
+ * The rect is always placed in the top left corner of the free rect.
+ */
+enum class MaxRectsHeuristic
+{
+    BestShortSideFit,   // least space left along the shorter side
+    BestLongSideFit,    // least space left along the longer side
+    BestAreaFit,        // smallest free rect
+    BottomLeft,         // lowest bottom edge, then leftmost
+    ContactPoint        // longest edges shared with the atlas border and placed rects
+};
+
+
 class LLASSETGEN_API MaxRectsPacker : public BasePacker
 {
 public:
-    MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth)
-    : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}
-    , freeList{{{0, 0}, initialAtlasSize}}
-    {
-    }
+    /**
+     * Only the best short side fit heuristic uses an index to find free rects,
+     * all others compare the rect against every free rect.
+     */
+    MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth,
+                   MaxRectsHeuristic _heuristic = MaxRectsHeuristic::BestShortSideFit);
 
-    static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2);
+    static uint64_t inputSortingKey(const Vec2<PackingSizeType>& size);
 
     bool pack(Rect<PackingSizeType>& rect);
 
+    /**
+     * Mark a rect at a given position as used, e.g. one that is kept from
+     * an earlier packing. The rect must lie within the atlas.
+     */
+    void occupy(const Rect<PackingSizeType>& rect);
+
+    /**
+     * Mark many rects as used at once, e.g. all glyphs kept by an incremental
+     * update. The rects must lie within the atlas and must not overlap.
+     */
+    void occupy(const std::vector<Rect<PackingSizeType>>& rects);
+
+    /**
+     * Return the space of a packed rect to the free list. The rect must have
+     * been placed by pack and not been released since.
+     */
+    void release(const Rect<PackingSizeType>& rect);
+
 private:
-    LLASSETGEN_NO_EXPORT std::vector<Rect<PackingSizeType>>::const_iterator findFreeRect(
-        Rect<PackingSizeType>& rect) const;
+    LLASSETGEN_NO_EXPORT size_t findFreeRect(Rect<PackingSizeType>& rect) const;
+    LLASSETGEN_NO_EXPORT size_t bestFreeRect(const Vec2<PackingSizeType>& size) const;
+    LLASSETGEN_NO_EXPORT size_t scanFreeRects(Rect<PackingSizeType>& rect) const;
+    LLASSETGEN_NO_EXPORT std::pair<PackingSizeType, PackingSizeType> score(const Rect<PackingSizeType>& free,
+                                                                           const Vec2<PackingSizeType>& size) const;
+    LLASSETGEN_NO_EXPORT PackingSizeType contactLength(const Rect<PackingSizeType>& rect) const;
     LLASSETGEN_NO_EXPORT void grow();
     LLASSETGEN_NO_EXPORT void cropRects(const Rect<PackingSizeType>& placedRect);
     LLASSETGEN_NO_EXPORT void pruneFreeList();
+    LLASSETGEN_NO_EXPORT void addPlacedRect(const Rect<PackingSizeType>& rect);
+    LLASSETGEN_NO_EXPORT Rect<PackingSizeType> extendFreeRect(Rect<PackingSizeType> rect, bool widthFirst) const;
+
+    LLASSETGEN_NO_EXPORT void rebuildIndex();
+    LLASSETGEN_NO_EXPORT uint32_t addId(size_t position);
+    LLASSETGEN_NO_EXPORT void swapFreeRects(size_t position1, size_t position2);
+    LLASSETGEN_NO_EXPORT void indexFreeRect(uint32_t id);
+    LLASSETGEN_NO_EXPORT void insertIntoIndex(uint32_t id);
+    LLASSETGEN_NO_EXPORT void unindexFreeRect(uint32_t id, const Rect<PackingSizeType>& rect);
+    LLASSETGEN_NO_EXPORT void addContainment(uint32_t id1, uint32_t id2);
+    LLASSETGEN_NO_EXPORT void removeContainment(uint32_t id, uint32_t other);
+
+    MaxRectsHeuristic heuristic;
+
+    /**
+     * Free rects, most of them tiny compared to the atlas, so 32 bit
+     * coordinates are plenty. findFreeRect returns freeList.size() if there is
+     * no free rect at all.
+     */
+    CompactRects freeList;
+
+    /**
+     * Indices of the free list, so that cropping and pruning only look at free
+     * rects near the placed one, and finding the best free rect only looks at
+     * rects of fitting sizes. The order of freeList decides between equally
+     * good free rects, so it is kept exactly as without the index.
+     *
+     * Free rects are referred to by ids, which stay the same while rects are
+     * moved around in freeList. For each id, `containments` holds the ids of all
+     * free rects that contain it or are contained in it, which are the only
+     * pairs pruneFreeList has to look at.
+     */
+    RectGrid grid;
+    SizeIndex sizes;
+    std::vector<uint32_t> freeListIds;                 // id of the free rect at each position
+    std::vector<size_t> freeListPositions;             // position of each id in freeList
+    std::vector<std::vector<uint32_t>> containments;
+    std::set<uint32_t> idsWithContainments;
+    std::vector<bool> indexedIds;
+    std::vector<uint32_t> unusedIds;
 
-    std::vector<Rect<PackingSizeType>> freeList;
+    /**
+     * Rects that were packed or occupied and not released, so that released
+     * space can be extended up to them.
+     */
+    RectGrid placedGrid;
+    std::vector<Rect<PackingSizeType>> placedRects;    // by id
+    std::vector<uint32_t> unusedPlacedIds;
 };
 
 
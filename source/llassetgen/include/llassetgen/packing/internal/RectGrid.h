@@ -0,0 +1,70 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+/**
+ * Hierarchy of uniform grids over an atlas, for finding the rects that
+ * intersect a given one.
+ *
+ * Each level has cells twice as large as the one below. A rect is stored
+ * once, together with an id chosen by the caller, in the cell of its top left
+ * corner on the lowest level with cells at least as large as the rect. So a
+ * query only has to look at the cells it covers and their neighbours on each
+ * level. A grid has to be reset when the atlas grows.
+ */
+class LLASSETGEN_API RectGrid
+{
+public:
+    /**
+     * Remove all rects and resize the grid to cover an area of the given size.
+     */
+    void reset(const Vec2<PackingSizeType>& areaSize);
+
+    void insert(uint32_t id, const Rect<PackingSizeType>& rect);
+
+    /**
+     * Remove a rect. `rect` must be the rect the id was inserted with.
+     */
+    void erase(uint32_t id, const Rect<PackingSizeType>& rect);
+
+    /**
+     * Append the ids of all rects that intersect or touch `rect` to `ids`.
+     */
+    void query(const Rect<PackingSizeType>& rect, std::vector<uint32_t>& ids) const;
+
+private:
+    struct Entry
+    {
+        uint32_t id;
+        Rect<PackingSizeType> rect;
+    };
+
+    struct Level
+    {
+        unsigned int cellShift;
+        Vec2<PackingSizeType> cellCount;
+        std::vector<std::vector<Entry>> cells;
+        size_t entryCount;
+    };
+
+    LLASSETGEN_NO_EXPORT std::vector<Entry>& cell(const Rect<PackingSizeType>& rect, Level*& level);
+
+    std::vector<Level> levels;
+};
+
+
+} // namespace internal
+} // namespace llassetgen
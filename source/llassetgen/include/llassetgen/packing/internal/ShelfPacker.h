@@ -2,6 +2,8 @@
 #pragma once
 
 
+#include <map>
+
 #include <llassetgen/llassetgen_api.h>
 #include <llassetgen/packing/Types.h>
 #include <llassetgen/packing/internal/Common.h>
@@ -21,10 +23,17 @@ public:
     {
     }
 
-    static bool inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2);
+    static uint64_t inputSortingKey(const Vec2<PackingSizeType>& size);
 
     bool pack(Rect<PackingSizeType>& rect);
 
+    /**
+     * Return the space of a packed rect. Shelves are only filled from left to
+     * right, so only the space of the rects at the end of the current shelf
+     * can be used again, once all rects after them are released as well.
+     */
+    void release(const Rect<PackingSizeType>& rect);
+
 private:
     LLASSETGEN_NO_EXPORT bool packNoRotations(Rect<PackingSizeType>& rect);
     LLASSETGEN_NO_EXPORT bool packWithRotations(Rect<PackingSizeType>& rect);
@@ -34,6 +43,8 @@ private:
 
     Vec2<PackingSizeType> currentShelfSize{0, 0};
     PackingSizeType usedHeight{0};
+    // Released rects on the current shelf, by their left edge
+    std::map<PackingSizeType, PackingSizeType> releasedWidths;
 };
 
 
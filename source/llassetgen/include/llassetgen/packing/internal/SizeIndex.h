@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+/**
+ * Index of the sizes of rects in a list, for finding the rects that fit a
+ * given size best.
+ *
+ * Rects are identified by their position in the list, so that ties can be
+ * broken by list order. Sizes may not exceed the maximum size given on reset.
+ */
+class LLASSETGEN_API SizeIndex
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void reset(const Vec2<PackingSizeType>& maxSize);
+
+    void insert(size_t position, const Vec2<PackingSizeType>& size);
+    void erase(size_t position, const Vec2<PackingSizeType>& size);
+
+    /**
+     * Update the positions of two rects that swapped places in the list.
+     * Rects that are not in the index are ignored.
+     */
+    void swap(size_t position1, const Vec2<PackingSizeType>& size1, size_t position2,
+              const Vec2<PackingSizeType>& size2);
+
+    /**
+     * Largest width of the rects that are at least `minHeight` high, 0 if there are none.
+     */
+    PackingSizeType maxWidth(PackingSizeType minHeight) const;
+
+    /**
+     * Largest height of the rects that are at least `minWidth` wide, 0 if there are none.
+     */
+    PackingSizeType maxHeight(PackingSizeType minWidth) const;
+
+    /**
+     * First position of a rect with exactly the given width and at least the
+     * given height, or npos.
+     */
+    size_t firstWithWidth(PackingSizeType width, PackingSizeType minHeight) const;
+
+    /**
+     * First position of a rect with exactly the given height and at least the
+     * given width, or npos.
+     */
+    size_t firstWithHeight(PackingSizeType height, PackingSizeType minWidth) const;
+
+private:
+    /**
+     * Rects keyed by the length of one of their sides.
+     */
+    class Axis
+    {
+    public:
+        void reset(PackingSizeType maxLength);
+        void insert(size_t position, PackingSizeType length, PackingSizeType otherLength);
+        bool erase(size_t position, PackingSizeType length, PackingSizeType otherLength);
+        void swap(size_t position1, PackingSizeType length1, PackingSizeType otherLength1, size_t position2,
+                  PackingSizeType length2, PackingSizeType otherLength2);
+        PackingSizeType maxOtherLength(PackingSizeType minLength) const;
+        size_t first(PackingSizeType length, PackingSizeType minOtherLength) const;
+
+    private:
+        LLASSETGEN_NO_EXPORT void setMax(PackingSizeType length, PackingSizeType otherLength);
+
+        // (position, other length) of the rects with each length, ordered by position
+        std::map<PackingSizeType, std::set<std::pair<size_t, PackingSizeType>>> rects;
+        // Segment tree of the largest other length for each length
+        std::vector<PackingSizeType> maxTree;
+        size_t leafCount = 0;
+    };
+
+    Axis widths;
+    Axis heights;
+};
+
+
+} // namespace internal
+} // namespace llassetgen
@@ -0,0 +1,63 @@
+#pragma once
+
+
+#include <vector>
+
+#include <llassetgen/llassetgen_api.h>
+#include <llassetgen/packing/Types.h>
+#include <llassetgen/packing/internal/Common.h>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+class LLASSETGEN_API SkylinePacker : public BasePacker
+{
+public:
+    SkylinePacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations, bool _allowGrowth)
+    : BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}
+    , skyline{{0, 0, initialAtlasSize.x}}
+    {
+    }
+
+    static uint64_t inputSortingKey(const Vec2<PackingSizeType>& size);
+
+    bool pack(Rect<PackingSizeType>& rect);
+
+private:
+    /**
+     * Horizontal part of the skyline, at the height of the highest rect
+     * placed below it. Segments are sorted by x and cover the atlas width.
+     */
+    struct Segment
+    {
+        PackingSizeType x;
+        PackingSizeType y;
+        PackingSizeType width;
+    };
+
+    /**
+     * Position and score of a rect placed at the start of a segment.
+     */
+    struct Fit
+    {
+        size_t segment;
+        Vec2<PackingSizeType> size;
+        PackingSizeType y;
+        PackingSizeType waste;
+    };
+
+    LLASSETGEN_NO_EXPORT bool fit(size_t segment, const Vec2<PackingSizeType>& size, Fit& result) const;
+    LLASSETGEN_NO_EXPORT bool findPosition(const Vec2<PackingSizeType>& size, Fit& best) const;
+    LLASSETGEN_NO_EXPORT void place(const Fit& fit);
+    LLASSETGEN_NO_EXPORT void grow();
+
+    std::vector<Segment> skyline;
+};
+
+
+} // namespace internal
+} // namespace llassetgen
@@ -0,0 +1,117 @@
+#include <llassetgen/Atlas.h>
+
+
+#include <cassert>
+
+
+namespace
+{
+
+
+using llassetgen::PackingSizeType;
+using llassetgen::Rect;
+using llassetgen::Vec2;
+
+
+size_t imageBytes(const Vec2<size_t>& size, const size_t bitDepth)
+{
+    return (size.x * bitDepth + 7) / 8 * size.y;
+}
+
+
+/*
+ * Bytes needed to turn one glyph into the content of its Rect, excluding the result itself.
+ */
+size_t glyphTransientBytes(const Vec2<size_t>& glyphSize, const Rect<PackingSizeType>& rect, bool distanceField)
+{
+    if (!distanceField)
+    {
+        return imageBytes(glyphSize, 1);
+    }
+
+    // Input bitmap, distance field, scratch buffers of the distance transform (the dead
+    // reckoning position buffer dominates), and the downsampled distance field.
+    const size_t pixels = glyphSize.x * glyphSize.y;
+    return imageBytes(glyphSize, 1) + pixels * sizeof(llassetgen::DistanceTransform::OutputType) +
+           pixels * sizeof(llassetgen::DistanceTransform::PositionType) + (glyphSize.x + glyphSize.y + 1) * 24 +
+           imageBytes(rect.size, llassetgen::DistanceTransform::bitDepth);
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+size_t atlasPeakBytes(const Packing & packing, const std::vector<Vec2<size_t>> & glyphSizes, bool distanceField,
+                      const AtlasPipeline & pipeline)
+{
+    assert(glyphSizes.size() == packing.rects.size());
+
+    size_t glyphBytes = 0;
+    size_t tileBytes = 0;
+    for (size_t i = 0; i < glyphSizes.size(); ++i)
+    {
+        glyphBytes = std::max(glyphBytes, glyphTransientBytes(glyphSizes[i], packing.rects[i], distanceField));
+        tileBytes = std::max(tileBytes, imageBytes(packing.rects[i].size, DistanceTransform::bitDepth));
+    }
+
+    // The atlas itself, the glyphs in flight and the row buffer of the PNG export. Font atlases
+    // are composed one glyph at a time. In the pipeline, glyphs are rendered, wait in the first
+    // queue or are transformed, and their tiles wait in the second queue or are copied.
+    const size_t atlasBitDepth = distanceField ? DistanceTransform::bitDepth : 1;
+    size_t inFlightBytes = glyphBytes;
+    if (distanceField)
+    {
+        const size_t queueDepth = BoundedQueue<internal::GlyphWork>::capacityFor(pipeline.queueDepth);
+        const size_t transformThreads = pipeline.transformThreadCount();
+        inFlightBytes = (std::max(1u, pipeline.renderThreads) + queueDepth + transformThreads) * glyphBytes +
+                        (queueDepth + 1 + transformThreads) * tileBytes;
+    }
+    return imageBytes(packing.atlasSize, atlasBitDepth) + inFlightBytes + packing.atlasSize.x * sizeof(uint16_t);
+}
+
+size_t streamedAtlasPeakBytes(const Packing & packing, const std::vector<Vec2<size_t>> & glyphSizes,
+                              bool distanceField)
+{
+    assert(glyphSizes.size() == packing.rects.size());
+
+    // Replay the order in which internal::streamAtlasRows creates and releases tiles.
+    const size_t tileBitDepth = distanceField ? 16 : 1;
+    std::vector<size_t> starts(packing.rects.size());
+    std::iota(starts.begin(), starts.end(), 0);
+    std::stable_sort(starts.begin(), starts.end(), [&packing](size_t i1, size_t i2) {
+        return packing.rects[i1].position.y < packing.rects[i2].position.y;
+    });
+    std::vector<size_t> ends = starts;
+    std::stable_sort(ends.begin(), ends.end(), [&packing](size_t i1, size_t i2) {
+        return packing.rects[i1].position.y + packing.rects[i1].size.y <
+               packing.rects[i2].position.y + packing.rects[i2].size.y;
+    });
+
+    const size_t rowBytes = imageBytes({packing.atlasSize.x, 1}, tileBitDepth);
+    size_t tileBytes = 0;
+    size_t peakBytes = rowBytes;
+    auto end = ends.begin();
+    for (const size_t i : starts)
+    {
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+        for (; end != ends.end() && packing.rects[*end].position.y + packing.rects[*end].size.y <= rect.position.y;
+             ++end)
+        {
+            tileBytes -= imageBytes(packing.rects[*end].size, tileBitDepth);
+        }
+
+        const size_t bytes = imageBytes(rect.size, tileBitDepth);
+        peakBytes = std::max(peakBytes,
+                             rowBytes + tileBytes + glyphTransientBytes(glyphSizes[i], rect, distanceField) + bytes);
+        tileBytes += bytes;
+    }
+
+    return peakBytes;
+}
+
+
+} // namespace llassetgen
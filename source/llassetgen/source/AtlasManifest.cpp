@@ -0,0 +1,238 @@
+#include <llassetgen/AtlasManifest.h>
+
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <llassetgen/packing/internal/MaxRectsPacker.h>
+
+
+namespace
+{
+
+
+constexpr char manifestMagic[] = "llassetgen-manifest";
+constexpr int manifestVersion = 1;
+
+
+// Empty strings are written as "-", so that every setting is a single token.
+std::string settingToken(const std::string& value)
+{
+    return value.empty() ? "-" : value;
+}
+
+std::string settingValue(const std::string& token)
+{
+    return token == "-" ? "" : token;
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+bool AtlasSettings::operator==(const AtlasSettings& other) const
+{
+    return fontHash == other.fontHash && fontSize == other.fontSize && padding == other.padding &&
+           downsampling == other.downsampling && downsamplingAlgorithm == other.downsamplingAlgorithm &&
+           distanceTransform == other.distanceTransform && dynamicRangeMin == other.dynamicRangeMin &&
+           dynamicRangeMax == other.dynamicRangeMax && packing == other.packing;
+}
+
+bool AtlasSettings::operator!=(const AtlasSettings& other) const
+{
+    return !(*this == other);
+}
+
+AtlasManifest AtlasManifest::load(const std::string& filepath)
+{
+    std::ifstream file(filepath);
+    if (!file)
+    {
+        throw std::runtime_error("manifest could not be read");
+    }
+
+    std::string line, tag;
+    int version = 0;
+    std::getline(file, line);
+    std::istringstream header(line);
+    if (!(header >> tag >> version) || tag != manifestMagic || version != manifestVersion)
+    {
+        throw std::runtime_error("unsupported manifest format");
+    }
+
+    AtlasManifest manifest;
+    AtlasSettings& settings = manifest.settings;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        if (!(fields >> tag))
+        {
+            continue;
+        }
+
+        bool valid;
+        std::string token;
+        if (tag == "glyph")
+        {
+            ManifestGlyph glyph;
+            valid = static_cast<bool>(fields >> glyph.charcode >> glyph.rect.position.x >> glyph.rect.position.y >>
+                                      glyph.rect.size.x >> glyph.rect.size.y);
+            manifest.glyphs.push_back(glyph);
+        }
+        else if (tag == "font")
+        {
+            valid = static_cast<bool>(fields >> std::hex >> settings.fontHash);
+        }
+        else if (tag == "size")
+        {
+            valid = static_cast<bool>(fields >> settings.fontSize);
+        }
+        else if (tag == "padding")
+        {
+            valid = static_cast<bool>(fields >> settings.padding);
+        }
+        else if (tag == "downsampling")
+        {
+            valid = static_cast<bool>(fields >> settings.downsampling >> token);
+            settings.downsamplingAlgorithm = settingValue(token);
+        }
+        else if (tag == "distfield")
+        {
+            valid = static_cast<bool>(fields >> token >> settings.dynamicRangeMin >> settings.dynamicRangeMax);
+            settings.distanceTransform = settingValue(token);
+        }
+        else if (tag == "packing")
+        {
+            valid = static_cast<bool>(fields >> token);
+            settings.packing = settingValue(token);
+        }
+        else if (tag == "atlas")
+        {
+            valid = static_cast<bool>(fields >> manifest.atlasSize.x >> manifest.atlasSize.y);
+        }
+        else
+        {
+            throw std::runtime_error("unknown manifest entry: " + tag);
+        }
+
+        if (!valid)
+        {
+            throw std::runtime_error("malformed manifest entry: " + tag);
+        }
+    }
+
+    for (const ManifestGlyph& glyph : manifest.glyphs)
+    {
+        const Vec2<PackingSizeType> end = glyph.rect.position + glyph.rect.size;
+        if (end.x > manifest.atlasSize.x || end.y > manifest.atlasSize.y)
+        {
+            throw std::runtime_error("manifest glyph lies outside of the atlas");
+        }
+    }
+
+    return manifest;
+}
+
+void AtlasManifest::save(const std::string& filepath) const
+{
+    std::ofstream file(filepath);
+    file << manifestMagic << ' ' << manifestVersion << '\n';
+    file << "font " << std::hex << settings.fontHash << std::dec << '\n';
+    file << "size " << settings.fontSize << '\n';
+    file << "padding " << settings.padding << '\n';
+    file << "downsampling " << settings.downsampling << ' ' << settingToken(settings.downsamplingAlgorithm) << '\n';
+    file << "distfield " << settingToken(settings.distanceTransform) << ' ' << settings.dynamicRangeMin << ' '
+         << settings.dynamicRangeMax << '\n';
+    file << "packing " << settingToken(settings.packing) << '\n';
+    file << "atlas " << atlasSize.x << ' ' << atlasSize.y << '\n';
+    for (const ManifestGlyph& glyph : glyphs)
+    {
+        file << "glyph " << glyph.charcode << ' ' << glyph.rect.position.x << ' ' << glyph.rect.position.y << ' '
+             << glyph.rect.size.x << ' ' << glyph.rect.size.y << '\n';
+    }
+
+    if (!file)
+    {
+        throw std::runtime_error("manifest could not be written");
+    }
+}
+
+IncrementalPacking incrementalPacking(const AtlasManifest& previous, const std::vector<unsigned long>& charcodes,
+                                      const std::vector<Vec2<PackingSizeType>>& rectSizes)
+{
+    if (charcodes.size() != rectSizes.size())
+    {
+        throw std::runtime_error("every glyph needs a rect size");
+    }
+
+    std::map<unsigned long, const ManifestGlyph*> previousGlyphs;
+    for (const ManifestGlyph& glyph : previous.glyphs)
+    {
+        previousGlyphs[glyph.charcode] = &glyph;
+    }
+
+    IncrementalPacking result;
+    Packing& packing = result.packing;
+    packing.atlasSize = previous.atlasSize;
+    packing.rects.resize(charcodes.size());
+    result.reused.assign(charcodes.size(), false);
+
+    std::vector<Rect<PackingSizeType>> kept;
+    std::vector<size_t> added;
+    for (size_t i = 0; i < charcodes.size(); ++i)
+    {
+        packing.rects[i].size = rectSizes[i];
+        auto found = previousGlyphs.find(charcodes[i]);
+        if (found != previousGlyphs.end() && found->second->rect.size == rectSizes[i])
+        {
+            packing.rects[i] = found->second->rect;
+            result.reused[i] = true;
+            kept.push_back(packing.rects[i]);
+            previousGlyphs.erase(found);
+        }
+        else
+        {
+            added.push_back(i);
+        }
+    }
+    internal::MaxRectsPacker packer{packing.atlasSize, false, false};
+    packer.occupy(kept);
+
+    for (const auto& stale : previousGlyphs)
+    {
+        result.staleRects.push_back(stale.second->rect);
+    }
+
+    std::vector<uint64_t> keys;
+    keys.reserve(added.size());
+    for (size_t i : added)
+    {
+        keys.push_back(internal::MaxRectsPacker::inputSortingKey(packing.rects[i].size));
+    }
+    for (uint32_t sorted : internal::sortDescending(keys))
+    {
+        const size_t i = added[sorted];
+        // empty glyphs like spaces need no pixels, even if the atlas is full
+        if (packing.rects[i].size.x == 0 || packing.rects[i].size.y == 0)
+        {
+            continue;
+        }
+        if (!packer.pack(packing.rects[i]))
+        {
+            packing.rects.clear();
+            break;
+        }
+    }
+
+    return result;
+}
+
+
+} // namespace llassetgen
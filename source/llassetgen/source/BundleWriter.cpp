@@ -0,0 +1,272 @@
+#include <llassetgen/BundleWriter.h>
+
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <llassetgen/Kerning.h>
+
+
+namespace
+{
+
+
+// Average number of glyphs per bucket of the perfect hash. Smaller buckets
+// make displacement seeds quicker to find, at 4 bytes per bucket.
+constexpr size_t glyphsPerBucket = 2;
+
+// Give up on a hash seed if a bucket can not be placed within this many
+// displacement seeds, and start over with the next one.
+constexpr uint32_t maxDisplacementTries = 1u << 20;
+
+// Distinct codepoints are placed with one of the first few hash seeds, so
+// running out of them means the hash is broken rather than unlucky.
+constexpr uint32_t maxHashSeeds = 64;
+
+
+uint64_t alignedOffset(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+BundleWriter::BundleWriter(FT_Face _face, unsigned int _fontSize)
+: face(_face)
+, fontSize(_fontSize)
+, header()
+{
+}
+
+void BundleWriter::setGlyphs(const std::vector<GlyphRecord>& records, const Packing& packing, size_t padding,
+                             size_t divisibleBy)
+{
+    if (records.size() != packing.rects.size())
+    {
+        throw std::runtime_error("every glyph needs a rect in the packing");
+    }
+
+    const float ratio = float(divisibleBy);
+    const float ascender = float(face->size->metrics.ascender) / 64.f;
+    header.fontSize = float(fontSize);
+    header.lineHeight = float(face->size->metrics.height) / 64.f / ratio;
+    header.base = ascender / ratio;
+    header.atlasWidth = static_cast<uint32_t>(packing.atlasSize.x);
+    header.atlasHeight = static_cast<uint32_t>(packing.atlasSize.y);
+
+    glyphs.clear();
+    glyphs.reserve(records.size());
+    std::vector<FT_UInt> gindices;
+    std::map<FT_UInt, std::vector<uint32_t>> codepoints;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const GlyphRecord& record = records[i];
+        const Rect<PackingSizeType>& rect = packing.rects[i];
+
+        bundle::Glyph glyph;
+        glyph.codepoint = static_cast<uint32_t>(record.charcode);
+        glyph.gindex = record.gindex;
+        glyph.x = static_cast<uint32_t>(rect.position.x);
+        glyph.y = static_cast<uint32_t>(rect.position.y);
+        glyph.width = static_cast<uint32_t>(rect.size.x);
+        glyph.height = static_cast<uint32_t>(rect.size.y);
+        glyph.xOffset = (float(record.bitmapOrigin.x) - float(padding)) / ratio;
+        glyph.yOffset = (ascender - float(record.bitmapOrigin.y) - float(padding)) / ratio;
+        glyph.xAdvance = float(record.linearHoriAdvance) / 65536.f / ratio;
+        glyph.page = 0;
+        glyphs.push_back(glyph);
+
+        gindices.push_back(record.gindex);
+        codepoints[record.gindex].push_back(glyph.codepoint);
+    }
+    std::sort(glyphs.begin(), glyphs.end(),
+              [](const bundle::Glyph& a, const bundle::Glyph& b) { return a.codepoint < b.codepoint; });
+    // equal codepoints collide for every hash seed
+    auto duplicate = std::adjacent_find(glyphs.begin(), glyphs.end(),
+                                        [](const bundle::Glyph& a, const bundle::Glyph& b) {
+                                            return a.codepoint == b.codepoint;
+                                        });
+    if (duplicate != glyphs.end())
+    {
+        throw std::runtime_error("codepoint " + std::to_string(duplicate->codepoint) + " is in the bundle twice");
+    }
+
+    // kerning pairs of glyph indices, for every codepoint that maps to them
+    kernings.clear();
+    for (const KerningPair& pair : kerningPairs(face, gindices))
+    {
+        const float amount = float(FT_MulFix(pair.amount, face->size->metrics.x_scale)) / 64.f / ratio;
+        for (uint32_t first : codepoints[pair.left])
+        {
+            for (uint32_t second : codepoints[pair.right])
+            {
+                kernings.push_back({first, second, amount});
+            }
+        }
+    }
+    std::sort(kernings.begin(), kernings.end(), [](const bundle::Kerning& a, const bundle::Kerning& b) {
+        return a.first < b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    buildHash();
+}
+
+void BundleWriter::buildHash()
+{
+    // Hash and displace: glyphs are distributed into buckets by the global
+    // hash seed, then each bucket, largest first, searches for a seed that
+    // moves all of its glyphs into free slots.
+    const uint32_t glyphCount = static_cast<uint32_t>(glyphs.size());
+    const uint32_t bucketCount = static_cast<uint32_t>(glyphs.size() / glyphsPerBucket + 1);
+    bucketSeeds.assign(bucketCount, 0);
+    slots.assign(glyphCount, 0);
+
+    for (uint32_t hashSeed = 0; hashSeed < maxHashSeeds; ++hashSeed)
+    {
+        std::vector<std::vector<uint32_t>> buckets(bucketCount);
+        for (uint32_t i = 0; i < glyphCount; ++i)
+        {
+            buckets[bundle::hash(glyphs[i].codepoint, hashSeed) % bucketCount].push_back(i);
+        }
+
+        std::vector<uint32_t> order(bucketCount);
+        for (uint32_t i = 0; i < bucketCount; ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        std::vector<bool> taken(glyphCount, false);
+        std::vector<uint32_t> bucketSlots;
+        bool placedAll = true;
+        for (uint32_t bucket : order)
+        {
+            const std::vector<uint32_t>& members = buckets[bucket];
+            if (members.empty())
+            {
+                break;
+            }
+
+            uint32_t seed = 0;
+            for (; seed < maxDisplacementTries; ++seed)
+            {
+                bucketSlots.clear();
+                for (uint32_t glyph : members)
+                {
+                    uint32_t slot = bundle::hash(glyphs[glyph].codepoint, seed) % glyphCount;
+                    if (taken[slot] || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                    {
+                        break;
+                    }
+                    bucketSlots.push_back(slot);
+                }
+                if (bucketSlots.size() == members.size())
+                {
+                    break;
+                }
+            }
+            if (seed == maxDisplacementTries)
+            {
+                placedAll = false;
+                break;
+            }
+
+            bucketSeeds[bucket] = seed;
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                taken[bucketSlots[i]] = true;
+                slots[bucketSlots[i]] = members[i];
+            }
+        }
+
+        if (placedAll)
+        {
+            header.hashSeed = hashSeed;
+            header.bucketCount = bucketCount;
+            return;
+        }
+    }
+    throw std::runtime_error("no perfect hash found for the glyphs of the bundle");
+}
+
+void BundleWriter::setAtlas(const Image& atlas)
+{
+    const size_t bitDepth = atlas.getBitDepth();
+    if (bitDepth > 16 || (bitDepth > 8 && bitDepth < 16))
+    {
+        throw std::runtime_error("bundles can only hold atlases of up to 8 or exactly 16 bits per pixel");
+    }
+
+    header.atlasWidth = static_cast<uint32_t>(atlas.getWidth());
+    header.atlasHeight = static_cast<uint32_t>(atlas.getHeight());
+    header.atlasBitDepth = bitDepth == 16 ? 16 : 8;
+
+    atlasPixels.clear();
+    atlasPixels.reserve(atlas.getWidth() * atlas.getHeight() * header.atlasBitDepth / 8);
+    const uint32_t maxValue = (1u << bitDepth) - 1;
+    for (size_t y = 0; y < atlas.getHeight(); ++y)
+    {
+        for (size_t x = 0; x < atlas.getWidth(); ++x)
+        {
+            if (bitDepth == 16)
+            {
+                uint16_t value = atlas.getPixel<uint16_t>({x, y});
+                atlasPixels.push_back(static_cast<uint8_t>(value));
+                atlasPixels.push_back(static_cast<uint8_t>(value >> 8));
+            }
+            else
+            {
+                atlasPixels.push_back(static_cast<uint8_t>(atlas.getPixel<uint8_t>({x, y}) * 255u / maxValue));
+            }
+        }
+    }
+}
+
+void BundleWriter::saveBundle(const std::string& filepath)
+{
+    std::memcpy(header.magic, bundle::magic, sizeof header.magic);
+    header.version = bundle::version;
+    header.glyphCount = static_cast<uint32_t>(glyphs.size());
+    header.kerningCount = static_cast<uint32_t>(kernings.size());
+    header.glyphOffset = alignedOffset(sizeof(bundle::Header));
+    header.bucketOffset = alignedOffset(header.glyphOffset + glyphs.size() * sizeof(bundle::Glyph));
+    header.slotOffset = alignedOffset(header.bucketOffset + bucketSeeds.size() * sizeof(uint32_t));
+    header.kerningOffset = alignedOffset(header.slotOffset + slots.size() * sizeof(uint32_t));
+    header.atlasOffset = alignedOffset(header.kerningOffset + kernings.size() * sizeof(bundle::Kerning));
+
+    // the sections are copied as they are in memory, which matches the file layout on little endian machines
+    std::vector<uint8_t> data(header.atlasOffset + atlasPixels.size(), 0);
+    auto copySection = [&data](uint64_t offset, const void* section, size_t size) {
+        if (size > 0)
+        {
+            std::memcpy(data.data() + offset, section, size);
+        }
+    };
+    copySection(0, &header, sizeof header);
+    copySection(header.glyphOffset, glyphs.data(), glyphs.size() * sizeof(bundle::Glyph));
+    copySection(header.bucketOffset, bucketSeeds.data(), bucketSeeds.size() * sizeof(uint32_t));
+    copySection(header.slotOffset, slots.data(), slots.size() * sizeof(uint32_t));
+    copySection(header.kerningOffset, kernings.data(), kernings.size() * sizeof(bundle::Kerning));
+    copySection(header.atlasOffset, atlasPixels.data(), atlasPixels.size());
+
+    std::ofstream file(filepath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file)
+    {
+        throw std::runtime_error("bundle could not be written");
+    }
+}
+
+
+} // namespace llassetgen
@@ -1,5 +1,6 @@
 
 #include <llassetgen/DistanceTransform.h>
+#include <llassetgen/Profiler.h>
 
 #include <cassert>
 #include <cmath>
@@ -65,6 +66,8 @@ void DeadReckoning::transformAt(PositionType pos, PositionType target, OutputTyp
 
 
 void DeadReckoning::transform() {
+    ProfileScope scope{"distance transform"};
+    scope.setCount("pixels", input.getWidth() * input.getHeight());
     assert(input.getWidth() > 0 && input.getHeight() > 0);
     posBuffer.reset(new PositionType[input.getWidth() * input.getHeight()]);
 
@@ -228,6 +231,8 @@ void ParabolaEnvelope::transformLine(DimensionType offset, DimensionType length)
 
 void ParabolaEnvelope::transform()
 {
+    ProfileScope scope{"distance transform"};
+    scope.setCount("pixels", input.getWidth() * input.getHeight());
     assert(input.getWidth() > 0 && input.getHeight() > 0);
 
     DimensionType length = std::max(input.getWidth(), input.getHeight());
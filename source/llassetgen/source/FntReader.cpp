@@ -0,0 +1,560 @@
+#include <llassetgen/FntReader.h>
+
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+
+namespace
+{
+
+
+using llassetgen::CharInfo;
+using llassetgen::Common;
+using llassetgen::Info;
+using llassetgen::KerningInfo;
+
+
+// A [begin, end) range of the file contents.
+struct Token
+{
+    const char * begin;
+    const char * end;
+
+    bool operator==(const char * text) const
+    {
+        const size_t length = std::strlen(text);
+        return size_t(end - begin) == length && std::memcmp(begin, text, length) == 0;
+    }
+
+    std::string str() const
+    {
+        return std::string(begin, end);
+    }
+};
+
+
+// Numbers as written by FntWriter: integers, or floats in "%g" notation.
+// Plain decimals are parsed directly, exponents fall back to strtod.
+double parseNumber(const Token & token)
+{
+    const char * p = token.begin;
+    const bool negative = p < token.end && *p == '-';
+    if (p < token.end && (*p == '-' || *p == '+'))
+    {
+        ++p;
+    }
+
+    double value = 0;
+    const char * digits = p;
+    for (; p < token.end && *p >= '0' && *p <= '9'; ++p)
+    {
+        value = value * 10 + (*p - '0');
+    }
+    if (p < token.end && *p == '.')
+    {
+        double scale = 1;
+        for (++p; p < token.end && *p >= '0' && *p <= '9'; ++p)
+        {
+            value = value * 10 + (*p - '0');
+            scale *= 10;
+        }
+        value /= scale;
+    }
+
+    if (p < token.end && (*p == 'e' || *p == 'E'))
+    {
+        // the token is followed by a separator, so strtod stops at its end
+        return std::strtod(token.begin, nullptr);
+    }
+    if (p != token.end || p == digits)
+    {
+        throw std::runtime_error("invalid number in FNT file: " + token.str());
+    }
+    return negative ? -value : value;
+}
+
+
+int parseInt(const Token & token)
+{
+    return static_cast<int>(std::lround(parseNumber(token)));
+}
+
+
+// Comma separated list of numbers, like the padding values.
+std::vector<float> parseList(const Token & token)
+{
+    std::vector<float> values;
+    const char * begin = token.begin;
+    for (const char * p = token.begin; p <= token.end; ++p)
+    {
+        if (p == token.end || *p == ',')
+        {
+            values.push_back(static_cast<float>(parseNumber({begin, p})));
+            begin = p + 1;
+        }
+    }
+    return values;
+}
+
+
+void setInfoField(Info & info, Common & common, const Token & key, const Token & value)
+{
+    if (key == "face")
+    {
+        info.face = value.str();
+    }
+    else if (key == "size")
+    {
+        info.size = parseInt(value);
+    }
+    else if (key == "bold")
+    {
+        info.isBold = parseInt(value) != 0;
+    }
+    else if (key == "italic")
+    {
+        info.isItalic = parseInt(value) != 0;
+    }
+    else if (key == "charset")
+    {
+        info.charset = value.str();
+    }
+    else if (key == "unicode")
+    {
+        info.useUnicode = parseInt(value) != 0;
+    }
+    else if (key == "padding")
+    {
+        std::vector<float> padding = parseList(value);
+        if (padding.size() == 4)
+        {
+            common.padding = {padding[3], padding[1], padding[0], padding[2]};
+        }
+    }
+}
+
+
+void setCommonField(Common & common, const Token & key, const Token & value)
+{
+    if (key == "lineHeight")
+    {
+        common.lineHeight = parseInt(value);
+    }
+    else if (key == "base")
+    {
+        common.base = parseInt(value);
+    }
+    else if (key == "scaleW")
+    {
+        common.scaleW = parseInt(value);
+    }
+    else if (key == "scaleH")
+    {
+        common.scaleH = parseInt(value);
+    }
+    else if (key == "pages")
+    {
+        common.pages = parseInt(value);
+    }
+    else if (key == "packed")
+    {
+        common.isPacked = parseInt(value) != 0;
+    }
+}
+
+
+void setCharField(CharInfo & charInfo, const Token & key, const Token & value)
+{
+    // ordered by how the fields appear in a line
+    if (key == "id")
+    {
+        charInfo.id = parseInt(value);
+    }
+    else if (key == "x")
+    {
+        charInfo.x = parseInt(value);
+    }
+    else if (key == "y")
+    {
+        charInfo.y = parseInt(value);
+    }
+    else if (key == "width")
+    {
+        charInfo.width = parseInt(value);
+    }
+    else if (key == "height")
+    {
+        charInfo.height = parseInt(value);
+    }
+    else if (key == "xoffset")
+    {
+        charInfo.xOffset = static_cast<float>(parseNumber(value));
+    }
+    else if (key == "yoffset")
+    {
+        charInfo.yOffset = static_cast<float>(parseNumber(value));
+    }
+    else if (key == "xadvance")
+    {
+        charInfo.xAdvance = static_cast<float>(parseNumber(value));
+    }
+    else if (key == "page")
+    {
+        charInfo.page = parseInt(value);
+    }
+    else if (key == "chnl")
+    {
+        charInfo.chnl = static_cast<uint8_t>(parseInt(value));
+    }
+}
+
+
+void setKerningField(KerningInfo & kerningInfo, const Token & key, const Token & value)
+{
+    if (key == "first")
+    {
+        kerningInfo.firstId = parseInt(value);
+    }
+    else if (key == "second")
+    {
+        kerningInfo.secondId = parseInt(value);
+    }
+    else if (key == "amount")
+    {
+        kerningInfo.kerning = static_cast<float>(parseNumber(value));
+    }
+}
+
+
+// Little endian reads from the binary format, bounds checked against the block.
+class BinaryBlock
+{
+public:
+    BinaryBlock(const char * _begin, const char * _end)
+    : begin(_begin)
+    , end(_end)
+    {
+    }
+
+    size_t size() const
+    {
+        return size_t(end - begin);
+    }
+
+    uint32_t u(size_t offset, size_t bytes) const
+    {
+        if (offset + bytes > size())
+        {
+            throw std::runtime_error("truncated block in binary FNT file");
+        }
+        uint32_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            value |= uint32_t(static_cast<uint8_t>(begin[offset + i])) << (8 * i);
+        }
+        return value;
+    }
+
+    int s16(size_t offset) const
+    {
+        return static_cast<int16_t>(u(offset, 2));
+    }
+
+    std::string string(size_t offset, size_t & next) const
+    {
+        const char * terminator = offset < size() ? static_cast<const char *>(std::memchr(begin + offset, 0, size() - offset)) : nullptr;
+        if (!terminator)
+        {
+            throw std::runtime_error("unterminated string in binary FNT file");
+        }
+        next = size_t(terminator - begin) + 1;
+        return std::string(begin + offset, terminator);
+    }
+
+private:
+    const char * begin;
+    const char * end;
+};
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+FntReader::FntReader(const std::string & filepath)
+: fntFormat(FntFormat::Text)
+, fontInfo()
+, fontCommon()
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("FNT file could not be opened");
+    }
+    file.seekg(0, std::ios::end);
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0, std::ios::beg);
+    file.read(&data[0], static_cast<std::streamsize>(data.size()));
+
+    if (data.compare(0, 3, "BMF") == 0)
+    {
+        fntFormat = FntFormat::Binary;
+        parseBinary(data);
+    }
+    else if (data.compare(0, 5, "info ") == 0)
+    {
+        fntFormat = FntFormat::Text;
+        parseText(data);
+    }
+    else
+    {
+        throw std::runtime_error("unsupported FNT format, only text and binary files can be read");
+    }
+}
+
+void FntReader::parseText(const std::string & data)
+{
+    const char * p = data.c_str();
+    const char * end = p + data.size();
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+
+    while (p < end)
+    {
+        // tag
+        while (p < end && isSpace(*p))
+        {
+            ++p;
+        }
+        Token tag{p, p};
+        while (tag.end < end && !isSpace(*tag.end) && *tag.end != '\n')
+        {
+            ++tag.end;
+        }
+        p = tag.end;
+
+        CharInfo charInfo{};
+        KerningInfo kerningInfo{};
+        size_t count = 0;
+
+        // key=value pairs up to the end of the line
+        while (p < end && *p != '\n')
+        {
+            if (isSpace(*p))
+            {
+                ++p;
+                continue;
+            }
+
+            Token key{p, p};
+            while (key.end < end && *key.end != '=' && *key.end != '\n')
+            {
+                ++key.end;
+            }
+            if (key.end == end || *key.end != '=')
+            {
+                throw std::runtime_error("invalid FNT line, expected key=value: " + key.str());
+            }
+
+            Token value{key.end + 1, key.end + 1};
+            if (value.begin < end && *value.begin == '"')
+            {
+                ++value.begin;
+                const char * quote = static_cast<const char *>(std::memchr(value.begin, '"', size_t(end - value.begin)));
+                if (!quote)
+                {
+                    throw std::runtime_error("unterminated string in FNT file");
+                }
+                value.end = quote;
+                p = quote + 1;
+            }
+            else
+            {
+                while (value.end < end && !isSpace(*value.end) && *value.end != '\n')
+                {
+                    ++value.end;
+                }
+                p = value.end;
+            }
+
+            if (tag == "char")
+            {
+                setCharField(charInfo, key, value);
+            }
+            else if (tag == "kerning")
+            {
+                setKerningField(kerningInfo, key, value);
+            }
+            else if (tag == "info")
+            {
+                setInfoField(fontInfo, fontCommon, key, value);
+            }
+            else if (tag == "common")
+            {
+                setCommonField(fontCommon, key, value);
+            }
+            else if (tag == "page" && key == "file")
+            {
+                pageFiles.push_back(value.str());
+            }
+            else if ((tag == "chars" || tag == "kernings") && key == "count")
+            {
+                count = static_cast<size_t>(parseInt(value));
+            }
+        }
+        ++p;
+
+        if (tag == "char")
+        {
+            charInfos.push_back(charInfo);
+        }
+        else if (tag == "kerning")
+        {
+            kerningInfos.push_back(kerningInfo);
+        }
+        else if (tag == "chars")
+        {
+            charInfos.reserve(count);
+        }
+        else if (tag == "kernings")
+        {
+            kerningInfos.reserve(count);
+        }
+    }
+}
+
+void FntReader::parseBinary(const std::string & data)
+{
+    if (data.size() < 4 || data[3] != 3)
+    {
+        throw std::runtime_error("unsupported binary FNT version, only version 3 can be read");
+    }
+
+    const char * p = data.data() + 4;
+    const char * end = data.data() + data.size();
+    while (p < end)
+    {
+        BinaryBlock header{p, end};
+        const uint32_t type = header.u(0, 1);
+        const uint32_t size = header.u(1, 4);
+        if (size > size_t(end - p) - 5)
+        {
+            throw std::runtime_error("truncated block in binary FNT file");
+        }
+        BinaryBlock block{p + 5, p + 5 + size};
+        p += 5 + size;
+
+        if (type == 1)
+        {
+            fontInfo.size = block.s16(0);
+            const uint32_t bits = block.u(2, 1);
+            fontInfo.useUnicode = (bits & 0x02) != 0;
+            fontInfo.isItalic = (bits & 0x04) != 0;
+            fontInfo.isBold = (bits & 0x08) != 0;
+            fontCommon.padding = {float(block.u(10, 1)), float(block.u(8, 1)), float(block.u(7, 1)),
+                                  float(block.u(9, 1))};
+            size_t next;
+            fontInfo.face = block.string(14, next);
+        }
+        else if (type == 2)
+        {
+            fontCommon.lineHeight = int(block.u(0, 2));
+            fontCommon.base = int(block.u(2, 2));
+            fontCommon.scaleW = int(block.u(4, 2));
+            fontCommon.scaleH = int(block.u(6, 2));
+            fontCommon.pages = int(block.u(8, 2));
+            fontCommon.isPacked = (block.u(10, 1) & 0x80) != 0;
+        }
+        else if (type == 3)
+        {
+            for (size_t offset = 0; offset < block.size();)
+            {
+                pageFiles.push_back(block.string(offset, offset));
+            }
+        }
+        else if (type == 4)
+        {
+            charInfos.reserve(block.size() / 20);
+            for (size_t offset = 0; offset + 20 <= block.size(); offset += 20)
+            {
+                CharInfo charInfo;
+                charInfo.id = int(block.u(offset, 4));
+                charInfo.x = int(block.u(offset + 4, 2));
+                charInfo.y = int(block.u(offset + 6, 2));
+                charInfo.width = int(block.u(offset + 8, 2));
+                charInfo.height = int(block.u(offset + 10, 2));
+                charInfo.xOffset = float(block.s16(offset + 12));
+                charInfo.yOffset = float(block.s16(offset + 14));
+                charInfo.xAdvance = float(block.s16(offset + 16));
+                charInfo.page = int(block.u(offset + 18, 1));
+                charInfo.chnl = static_cast<uint8_t>(block.u(offset + 19, 1));
+                charInfos.push_back(charInfo);
+            }
+        }
+        else if (type == 5)
+        {
+            kerningInfos.reserve(block.size() / 10);
+            for (size_t offset = 0; offset + 10 <= block.size(); offset += 10)
+            {
+                KerningInfo kerningInfo;
+                kerningInfo.firstId = int(block.u(offset, 4));
+                kerningInfo.secondId = int(block.u(offset + 4, 4));
+                kerningInfo.kerning = float(block.s16(offset + 8));
+                kerningInfos.push_back(kerningInfo);
+            }
+        }
+    }
+}
+
+FntFormat FntReader::format() const
+{
+    return fntFormat;
+}
+
+const Info & FntReader::info() const
+{
+    return fontInfo;
+}
+
+const Common & FntReader::common() const
+{
+    return fontCommon;
+}
+
+const std::vector<std::string> & FntReader::pages() const
+{
+    return pageFiles;
+}
+
+const std::vector<CharInfo> & FntReader::chars() const
+{
+    return charInfos;
+}
+
+const std::vector<KerningInfo> & FntReader::kernings() const
+{
+    return kerningInfos;
+}
+
+Packing FntReader::packing() const
+{
+    Packing packing;
+    packing.atlasSize = {PackingSizeType(fontCommon.scaleW), PackingSizeType(fontCommon.scaleH)};
+    packing.rects.reserve(charInfos.size());
+    for (const auto & charInfo : charInfos)
+    {
+        packing.rects.push_back({{PackingSizeType(charInfo.x), PackingSizeType(charInfo.y)},
+                                 {PackingSizeType(charInfo.width), PackingSizeType(charInfo.height)}});
+    }
+    return packing;
+}
+
+
+} // namespace llassetgen
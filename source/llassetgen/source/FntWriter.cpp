@@ -3,27 +3,245 @@
 
 
 #include <float.h>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <llassetgen/Image.h>
+#include <llassetgen/Kerning.h>
+#include <llassetgen/Profiler.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_OUTLINE_H
 
 
+namespace
+{
+
+
+// Collects formatted output and writes it to the file in large blocks. Numbers
+// are formatted like the default std::ostream formatting in the "C" locale,
+// floats with "%g", without going through iostreams for every field.
+class FntBuffer
+{
+public:
+    explicit FntBuffer(std::ofstream & _file)
+    : file(_file)
+    {
+        buffer.reserve(capacity);
+    }
+
+    FntBuffer & operator<<(char value)
+    {
+        buffer.push_back(value);
+        return *this;
+    }
+
+    FntBuffer & operator<<(const char * value)
+    {
+        buffer.append(value);
+        return *this;
+    }
+
+    FntBuffer & operator<<(const std::string & value)
+    {
+        buffer.append(value);
+        return *this;
+    }
+
+    FntBuffer & operator<<(int value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(long value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(long long value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(unsigned int value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(unsigned long value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(unsigned long long value)
+    {
+        return appendInteger(value);
+    }
+
+    FntBuffer & operator<<(float value)
+    {
+        return *this << double(value);
+    }
+
+    FntBuffer & operator<<(double value)
+    {
+        char digits[32];
+        int length = std::snprintf(digits, sizeof digits, "%g", value);
+        buffer.append(digits, static_cast<size_t>(std::max(length, 0)));
+        return flushIfFull();
+    }
+
+    void flush()
+    {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+private:
+    static constexpr size_t capacity = 1 << 20;
+
+    template <typename T>
+    FntBuffer & appendInteger(T value)
+    {
+        // digits in reverse, from the least significant one
+        char digits[24];
+        size_t length = 0;
+        const bool negative = value < 0;
+        unsigned long long magnitude = negative ? 0ull - static_cast<unsigned long long>(value)
+                                                : static_cast<unsigned long long>(value);
+        do
+        {
+            digits[length++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+
+        if (negative)
+        {
+            buffer.push_back('-');
+        }
+        while (length > 0)
+        {
+            buffer.push_back(digits[--length]);
+        }
+        return flushIfFull();
+    }
+
+    FntBuffer & flushIfFull()
+    {
+        if (buffer.size() >= capacity)
+        {
+            flush();
+        }
+        return *this;
+    }
+
+    std::ofstream & file;
+    std::string buffer;
+};
+
+
+std::string xmlEscaped(const std::string & value)
+{
+    std::string escaped;
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            case '\'': escaped += "&apos;"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+
+std::string jsonEscaped(const std::string & value)
+{
+    std::string escaped;
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char code[8];
+            std::snprintf(code, sizeof code, "\\u%04x", static_cast<unsigned int>(c));
+            escaped += code;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+// Append a little endian integer of type T.
+template <typename T>
+void putInt(std::vector<uint8_t> & data, int64_t value)
+{
+    // clamp to the range of the field instead of wrapping around, in 64 bits as long has only 32 on Windows
+    value = clamp<int64_t>(value, std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        data.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+    }
+}
+
+void putString(std::vector<uint8_t> & data, const std::string & value)
+{
+    data.insert(data.end(), value.begin(), value.end());
+    data.push_back(0);
+}
+
+// Start a block of the binary format, returns the offset its size is counted from.
+size_t beginBlock(std::vector<uint8_t> & data, uint8_t type)
+{
+    data.push_back(type);
+    data.insert(data.end(), 4, 0);
+    return data.size();
+}
+
+void endBlock(std::vector<uint8_t> & data, size_t blockStart)
+{
+    const uint32_t size = static_cast<uint32_t>(data.size() - blockStart);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        data[blockStart - 4 + i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+}
+
+
+} // namespace
+
+
 namespace llassetgen
 {
 
 
 FntWriter::FntWriter(FT_Face _face, const std::string & _faceName, unsigned int _fontSize, float _scalingFactor, bool _scaledGlyph)
 : face(_face)
-, faceName(_faceName)
+, pageFiles{_faceName}
 , fontInfo(Info())
 , fontCommon(Common())
 , charInfos(std::vector<CharInfo>())
@@ -51,11 +269,22 @@ void FntWriter::setFontInfo()
     fontInfo.useUnicode = (face->charmap->encoding == FT_ENCODING_UNICODE);
 }
 
-void FntWriter::setCharInfo(FT_UInt gindex, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset)
+void FntWriter::setCharInfo(FT_UInt gindex, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset, int page)
 {
     FT_Load_Glyph(face, gindex, FT_LOAD_DEFAULT);
 
-    FT_Pos yBearing = face->glyph->metrics.vertBearingY;
+    addCharInfo(gindex, face->glyph->linearHoriAdvance, face->glyph->metrics.vertBearingY, charArea, offset, page);
+}
+
+void FntWriter::setCharInfo(const GlyphRecord & record, const Rect<PackingSizeType> & charArea, const Vec2<float> & offset,
+                            int page)
+{
+    addCharInfo(record.gindex, record.linearHoriAdvance, record.vertBearingY, charArea, offset, page);
+}
+
+void FntWriter::addCharInfo(FT_UInt gindex, FT_Fixed linearHoriAdvance, FT_Pos yBearing,
+                            const Rect<PackingSizeType> & charArea, const Vec2<float> & offset, int page)
+{
     maxYBearing = std::max(yBearing, maxYBearing);
 
     CharInfo charInfo;
@@ -64,42 +293,74 @@ void FntWriter::setCharInfo(FT_UInt gindex, const Rect<PackingSizeType> & charAr
     charInfo.y = charArea.position.y;
     charInfo.width = charArea.size.x;
     charInfo.height = charArea.size.y;
-    charInfo.xAdvance = float(face->glyph->linearHoriAdvance) / 65536.f;
+    charInfo.xAdvance = float(linearHoriAdvance) / 65536.f;
     charInfo.xOffset = offset.x;
     charInfo.yOffset = offset.y;
-    charInfo.page = 1;
+    charInfo.page = page;
     charInfo.chnl = 15;
     charInfos.push_back(charInfo);
 }
 
-void FntWriter::setKerningInfo(std::set<FT_ULong>::iterator charcodesBegin,
-                               std::set<FT_ULong>::iterator charcodesEnd) {
-    for (std::set<FT_ULong>::iterator leftCharcode = charcodesBegin; leftCharcode != charcodesEnd; leftCharcode++)
+void FntWriter::setKerningInfo(const std::vector<FT_UInt> & gindices) {
+    // the charcode positions each glyph index is used at
+    std::map<FT_UInt, std::vector<size_t>> positions;
+    for (size_t i = 0; i < gindices.size(); ++i)
     {
-        for (std::set<FT_ULong>::iterator rightCharcode = charcodesBegin; rightCharcode != charcodesEnd; ++rightCharcode)
-        {
-            FT_UInt leftGindex = FT_Get_Char_Index(face, *leftCharcode);
-            FT_UInt rightGindex = FT_Get_Char_Index(face, *rightCharcode);
-            FT_Vector kerningVector;
-            FT_Get_Kerning(face, leftGindex, rightGindex, FT_KERNING_UNSCALED, &kerningVector);
+        positions[gindices[i]].push_back(i);
+    }
 
-            if (kerningVector.x != 0)
+    // emit the pairs stored in the font ordered by left, then right charcode
+    std::vector<KerningPair> pairs = kerningPairs(face, gindices);
+    std::vector<std::pair<size_t, FT_Pos>> rightAmounts;
+    for (FT_UInt leftGindex : gindices)
+    {
+        auto first = std::lower_bound(pairs.begin(), pairs.end(), leftGindex,
+                                      [](const KerningPair& pair, FT_UInt gindex) { return pair.left < gindex; });
+        rightAmounts.clear();
+        for (auto pair = first; pair != pairs.end() && pair->left == leftGindex; ++pair)
+        {
+            for (size_t position : positions[pair->right])
             {
-                KerningInfo kerningInfo;
-                kerningInfo.firstId = leftGindex;
-                kerningInfo.secondId = rightGindex;
-                // kerning is provided in 26.6 fixed-point format
-                kerningInfo.kerning = float(kerningVector.x) / 64.f;
-                kerningInfos.push_back(kerningInfo);
+                rightAmounts.emplace_back(position, pair->amount);
             }
         }
+        std::sort(rightAmounts.begin(), rightAmounts.end());
+
+        for (const auto& rightAmount : rightAmounts)
+        {
+            KerningInfo kerningInfo;
+            kerningInfo.firstId = leftGindex;
+            kerningInfo.secondId = gindices[rightAmount.first];
+            // kerning is provided in 26.6 fixed-point format
+            kerningInfo.kerning = float(rightAmount.second) / 64.f;
+            kerningInfos.push_back(kerningInfo);
+        }
     }
 }
 
 void FntWriter::readFont(std::set<FT_ULong>::iterator charcodesBegin, std::set<FT_ULong>::iterator charcodesEnd)
 {
+    std::vector<FT_UInt> gindices;
+    for (std::set<FT_ULong>::iterator charcode = charcodesBegin; charcode != charcodesEnd; ++charcode)
+    {
+        gindices.push_back(FT_Get_Char_Index(face, *charcode));
+    }
+
+    setFontInfo();
+    setKerningInfo(gindices);
+}
+
+void FntWriter::readFont(const std::vector<GlyphRecord> & records)
+{
+    std::vector<FT_UInt> gindices;
+    gindices.reserve(records.size());
+    for (const auto & record : records)
+    {
+        gindices.push_back(record.gindex);
+    }
+
     setFontInfo();
-    setKerningInfo(charcodesBegin, charcodesEnd);
+    setKerningInfo(gindices);
 }
 
 void FntWriter::setAtlasProperties(const Vec2<PackingSizeType> & size, const int maxHeight, const int padding)
@@ -108,7 +369,6 @@ void FntWriter::setAtlasProperties(const Vec2<PackingSizeType> & size, const int
     fontCommon.lineHeight = maxHeight;
     fontCommon.scaleW = size.x;
     fontCommon.scaleH = size.y;
-    fontCommon.pages = 1;
     fontCommon.isPacked = 0;
     fontCommon.padding = { static_cast<float>(padding), static_cast<float>(padding), static_cast<float>(padding), static_cast<float>(padding) };
 
@@ -123,16 +383,44 @@ void FntWriter::setAtlasProperties(const Vec2<PackingSizeType> & size, const int
     */
 }
 
-void FntWriter::saveFnt(const std::string & filepath)
+void FntWriter::setPageFiles(const std::vector<std::string> & files)
+{
+    pageFiles = files;
+}
+
+void FntWriter::saveFnt(const std::string & filepath, FntFormat format)
 {
+    ProfileScope scope{"fnt export"};
+    scope.setCount("chars", charInfos.size());
+
     fontCommon.base = maxYBearing;
+    fontCommon.pages = int(pageFiles.size());
 
+    switch (format)
+    {
+        case FntFormat::Binary:
+            saveBinaryFnt(filepath);
+            break;
+        case FntFormat::Xml:
+            saveXmlFnt(filepath);
+            break;
+        case FntFormat::Json:
+            saveJsonFnt(filepath);
+            break;
+        case FntFormat::Text:
+        default:
+            saveTextFnt(filepath);
+            break;
+    }
+}
+
+void FntWriter::saveTextFnt(const std::string & filepath)
+{
     // open file
-    std::ofstream fntFile;
-    fntFile.open(filepath);
+    std::ofstream file(filepath);
+    FntBuffer fntFile{file};
 
     // write in plain text format
-    // TODO: XML and binary
 
     // write info block
     fntFile << "info "
@@ -152,7 +440,7 @@ void FntWriter::saveFnt(const std::string & filepath)
         << "spacing=" << fontInfo.spacing.horiz << "," << fontInfo.spacing.vert << " "
         << "outline=" << fontInfo.outlineThickness
         */
-        << std::endl;
+        << '\n';
 
     // write common block
     fntFile << "common "
@@ -162,19 +450,19 @@ void FntWriter::saveFnt(const std::string & filepath)
         << "scaleH=" << (scaledGlyph ? (float(fontCommon.scaleH) * scalingFactor) : fontCommon.scaleH) << " "
         << "pages=" << fontCommon.pages << " "
         << "packed=" << int(fontCommon.isPacked)
-        << std::endl;
+        << '\n';
 
     // write page files
     for (int i = 0; i < fontCommon.pages; i++)
     {
         fntFile << "page "
             << "id=" << i << " "
-            << "file=\"" << faceName << "\""
-            << std::endl;
+            << "file=\"" << pageFiles[i] << "\""
+            << '\n';
     }
 
     // write char count
-    fntFile << "chars count=" << charInfos.size() << std::endl;
+    fntFile << "chars count=" << charInfos.size() << '\n';
 
     // write info for each char
     for (const auto charInfo : charInfos)
@@ -190,11 +478,11 @@ void FntWriter::saveFnt(const std::string & filepath)
             << "xadvance=" << float(charInfo.xAdvance) * scalingFactor << " "
             << "page=" << charInfo.page << " "
             << "chnl=" << int(charInfo.chnl)
-            << std::endl;
+            << '\n';
     }
 
     // write kerning count
-    fntFile << "kernings count=" << kerningInfos.size() << std::endl;
+    fntFile << "kernings count=" << kerningInfos.size() << '\n';
 
     // write each kerning info
     for (const auto & kerningInfo : kerningInfos)
@@ -202,12 +490,219 @@ void FntWriter::saveFnt(const std::string & filepath)
         fntFile << "kerning "
                 << "first=" << kerningInfo.firstId << " "
                 << "second=" << kerningInfo.secondId << " "
-                << "amount=" << kerningInfo.kerning * scalingFactor << std::endl;
+                << "amount=" << kerningInfo.kerning * scalingFactor << '\n';
     }
 
-    // close file
-    fntFile.close();
+    // write the remaining buffer
+    fntFile.flush();
 }
 
+void FntWriter::saveXmlFnt(const std::string & filepath)
+{
+    std::ofstream file(filepath);
+    FntBuffer fntFile{file};
+
+    // same fields as the text format, as attributes of one element per line
+    fntFile << "<?xml version=\"1.0\"?>\n<font>\n";
+    fntFile << "  <info "
+        << "face=\"" << xmlEscaped(fontInfo.face) << "\" "
+        << "size=\"" << fontInfo.size << "\" "
+        << "bold=\"" << int(fontInfo.isBold) << "\" "
+        << "italic=\"" << int(fontInfo.isItalic) << "\" "
+        << "charset=\"" << xmlEscaped(fontInfo.charset) << "\" "
+        << "unicode=\"" << int(fontInfo.useUnicode) << "\" "
+        << "padding=\"" << fontCommon.padding.up << "," << fontCommon.padding.right << "," << fontCommon.padding.down
+        << "," << fontCommon.padding.left << "\"/>\n";
+
+    fntFile << "  <common "
+        << "lineHeight=\"" << float(fontCommon.lineHeight) * scalingFactor << "\" "
+        << "base=\"" << float(fontCommon.base) * scalingFactor << "\" "
+        << "scaleW=\"" << (scaledGlyph ? (float(fontCommon.scaleW) * scalingFactor) : fontCommon.scaleW) << "\" "
+        << "scaleH=\"" << (scaledGlyph ? (float(fontCommon.scaleH) * scalingFactor) : fontCommon.scaleH) << "\" "
+        << "pages=\"" << fontCommon.pages << "\" "
+        << "packed=\"" << int(fontCommon.isPacked) << "\"/>\n";
+
+    fntFile << "  <pages>\n";
+    for (int i = 0; i < fontCommon.pages; i++)
+    {
+        fntFile << "    <page id=\"" << i << "\" file=\"" << xmlEscaped(pageFiles[i]) << "\"/>\n";
+    }
+    fntFile << "  </pages>\n";
+
+    fntFile << "  <chars count=\"" << charInfos.size() << "\">\n";
+    for (const auto & charInfo : charInfos)
+    {
+        fntFile << "    <char "
+            << "id=\"" << charInfo.id << "\" "
+            << "x=\"" << charInfo.x << "\" "
+            << "y=\"" << charInfo.y << "\" "
+            << "width=\"" << (scaledGlyph ? (float(charInfo.width) * scalingFactor) : charInfo.width) << "\" "
+            << "height=\"" << (scaledGlyph ? (float(charInfo.height) * scalingFactor) : charInfo.height) << "\" "
+            << "xoffset=\"" << charInfo.xOffset << "\" "
+            << "yoffset=\"" << charInfo.yOffset << "\" "
+            << "xadvance=\"" << float(charInfo.xAdvance) * scalingFactor << "\" "
+            << "page=\"" << charInfo.page << "\" "
+            << "chnl=\"" << int(charInfo.chnl) << "\"/>\n";
+    }
+    fntFile << "  </chars>\n";
+
+    fntFile << "  <kernings count=\"" << kerningInfos.size() << "\">\n";
+    for (const auto & kerningInfo : kerningInfos)
+    {
+        fntFile << "    <kerning "
+            << "first=\"" << kerningInfo.firstId << "\" "
+            << "second=\"" << kerningInfo.secondId << "\" "
+            << "amount=\"" << kerningInfo.kerning * scalingFactor << "\"/>\n";
+    }
+    fntFile << "  </kernings>\n</font>\n";
+
+    fntFile.flush();
+}
+
+void FntWriter::saveJsonFnt(const std::string & filepath)
+{
+    std::ofstream file(filepath);
+    FntBuffer fntFile{file};
+
+    // the layout of common BMFont JSON converters, pages as a list of file names
+    fntFile << "{\"pages\":[";
+    for (int i = 0; i < fontCommon.pages; i++)
+    {
+        fntFile << (i > 0 ? "," : "") << "\"" << jsonEscaped(pageFiles[i]) << "\"";
+    }
+    fntFile << "],\n";
+
+    fntFile << "\"info\":{"
+        << "\"face\":\"" << jsonEscaped(fontInfo.face) << "\","
+        << "\"size\":" << fontInfo.size << ","
+        << "\"bold\":" << int(fontInfo.isBold) << ","
+        << "\"italic\":" << int(fontInfo.isItalic) << ","
+        << "\"charset\":\"" << jsonEscaped(fontInfo.charset) << "\","
+        << "\"unicode\":" << int(fontInfo.useUnicode) << ","
+        << "\"padding\":[" << fontCommon.padding.up << "," << fontCommon.padding.right << ","
+        << fontCommon.padding.down << "," << fontCommon.padding.left << "]},\n";
+
+    fntFile << "\"common\":{"
+        << "\"lineHeight\":" << float(fontCommon.lineHeight) * scalingFactor << ","
+        << "\"base\":" << float(fontCommon.base) * scalingFactor << ","
+        << "\"scaleW\":" << (scaledGlyph ? (float(fontCommon.scaleW) * scalingFactor) : fontCommon.scaleW) << ","
+        << "\"scaleH\":" << (scaledGlyph ? (float(fontCommon.scaleH) * scalingFactor) : fontCommon.scaleH) << ","
+        << "\"pages\":" << fontCommon.pages << ","
+        << "\"packed\":" << int(fontCommon.isPacked) << "},\n";
+
+    fntFile << "\"chars\":[";
+    for (size_t i = 0; i < charInfos.size(); i++)
+    {
+        const CharInfo & charInfo = charInfos[i];
+        fntFile << (i > 0 ? ",\n" : "\n")
+            << "{\"id\":" << charInfo.id << ","
+            << "\"x\":" << charInfo.x << ","
+            << "\"y\":" << charInfo.y << ","
+            << "\"width\":" << (scaledGlyph ? (float(charInfo.width) * scalingFactor) : charInfo.width) << ","
+            << "\"height\":" << (scaledGlyph ? (float(charInfo.height) * scalingFactor) : charInfo.height) << ","
+            << "\"xoffset\":" << charInfo.xOffset << ","
+            << "\"yoffset\":" << charInfo.yOffset << ","
+            << "\"xadvance\":" << float(charInfo.xAdvance) * scalingFactor << ","
+            << "\"page\":" << charInfo.page << ","
+            << "\"chnl\":" << int(charInfo.chnl) << "}";
+    }
+    fntFile << "],\n";
+
+    fntFile << "\"kernings\":[";
+    for (size_t i = 0; i < kerningInfos.size(); i++)
+    {
+        const KerningInfo & kerningInfo = kerningInfos[i];
+        fntFile << (i > 0 ? ",\n" : "\n")
+            << "{\"first\":" << kerningInfo.firstId << ","
+            << "\"second\":" << kerningInfo.secondId << ","
+            << "\"amount\":" << kerningInfo.kerning * scalingFactor << "}";
+    }
+    fntFile << "]}\n";
+
+    fntFile.flush();
+}
+
+void FntWriter::saveBinaryFnt(const std::string & filepath)
+{
+    // BMFont binary format version 3: a header followed by the info, common, pages, chars and kerning
+    // blocks, each starting with its type and its size in bytes. All numbers are little endian.
+    std::vector<uint8_t> data = { 'B', 'M', 'F', 3 };
+
+    // info block
+    size_t block = beginBlock(data, 1);
+    putInt<int16_t>(data, fontInfo.size);
+    putInt<uint8_t>(data, (fontInfo.useUnicode ? 0x02 : 0) | (fontInfo.isItalic ? 0x04 : 0) | (fontInfo.isBold ? 0x08 : 0));
+    putInt<uint8_t>(data, 0);    // charSet, ignored for unicode fonts
+    putInt<uint16_t>(data, 100); // stretchH
+    putInt<uint8_t>(data, 1);    // aa
+    putInt<uint8_t>(data, std::lround(fontCommon.padding.up));
+    putInt<uint8_t>(data, std::lround(fontCommon.padding.right));
+    putInt<uint8_t>(data, std::lround(fontCommon.padding.down));
+    putInt<uint8_t>(data, std::lround(fontCommon.padding.left));
+    putInt<uint8_t>(data, 0);    // spacing horizontal
+    putInt<uint8_t>(data, 0);    // spacing vertical
+    putInt<uint8_t>(data, 0);    // outline
+    putString(data, fontInfo.face);
+    endBlock(data, block);
+
+    // common block
+    block = beginBlock(data, 2);
+    putInt<uint16_t>(data, std::lround(float(fontCommon.lineHeight) * scalingFactor));
+    putInt<uint16_t>(data, std::lround(float(fontCommon.base) * scalingFactor));
+    putInt<uint16_t>(data, scaledGlyph ? std::lround(float(fontCommon.scaleW) * scalingFactor) : fontCommon.scaleW);
+    putInt<uint16_t>(data, scaledGlyph ? std::lround(float(fontCommon.scaleH) * scalingFactor) : fontCommon.scaleH);
+    putInt<uint16_t>(data, fontCommon.pages);
+    putInt<uint8_t>(data, fontCommon.isPacked ? 0x80 : 0);
+    putInt<uint8_t>(data, 0);    // alpha channel holds the glyph data
+    putInt<uint8_t>(data, 0);    // red channel
+    putInt<uint8_t>(data, 0);    // green channel
+    putInt<uint8_t>(data, 0);    // blue channel
+    endBlock(data, block);
+
+    // pages block, all page names have the same length
+    block = beginBlock(data, 3);
+    for (int i = 0; i < fontCommon.pages; i++)
+    {
+        if (pageFiles[i].size() != pageFiles[0].size())
+        {
+            throw std::runtime_error("binary FNT files require page file names of the same length");
+        }
+        putString(data, pageFiles[i]);
+    }
+    endBlock(data, block);
+
+    // chars block
+    block = beginBlock(data, 4);
+    for (const auto & charInfo : charInfos)
+    {
+        putInt<uint32_t>(data, charInfo.id);
+        putInt<uint16_t>(data, charInfo.x);
+        putInt<uint16_t>(data, charInfo.y);
+        putInt<uint16_t>(data, scaledGlyph ? std::lround(float(charInfo.width) * scalingFactor) : charInfo.width);
+        putInt<uint16_t>(data, scaledGlyph ? std::lround(float(charInfo.height) * scalingFactor) : charInfo.height);
+        putInt<int16_t>(data, std::lround(charInfo.xOffset));
+        putInt<int16_t>(data, std::lround(charInfo.yOffset));
+        putInt<int16_t>(data, std::lround(charInfo.xAdvance * scalingFactor));
+        putInt<uint8_t>(data, charInfo.page);
+        putInt<uint8_t>(data, charInfo.chnl);
+    }
+    endBlock(data, block);
+
+    // kerning block, omitted if there are no kerning pairs
+    if (!kerningInfos.empty())
+    {
+        block = beginBlock(data, 5);
+        for (const auto & kerningInfo : kerningInfos)
+        {
+            putInt<uint32_t>(data, kerningInfo.firstId);
+            putInt<uint32_t>(data, kerningInfo.secondId);
+            putInt<int16_t>(data, std::lround(kerningInfo.kerning * scalingFactor));
+        }
+        endBlock(data, block);
+    }
+
+    std::ofstream fntFile(filepath, std::ios::binary);
+    fntFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
 
 } // namespace llassetgen
@@ -4,15 +4,250 @@
 
 #if defined(__unix__) || defined(__APPLE__)
 #include <fontconfig/fontconfig.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #elif _WIN32
 #define NOMINMAX
 #include <windows.h>
 #include <wingdi.h>
 #endif
 
-#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include <ft2build.h>  // NOLINT include order required by freetype
+#include FT_OUTLINE_H
 
 #include <llassetgen/llassetgen.h>
+#include <llassetgen/Profiler.h>
+
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace
+{
+
+
+/**
+ * Process-wide fontconfig state.
+ *
+ * Loading the configuration and scanning the system fonts is expensive, so
+ * it is done once and only when a name is not found in the resolution cache.
+ * The cache can be persisted to disk, keyed by the modification times of
+ * the configured font and fontconfig cache directories.
+ */
+class FontConfigContext
+{
+public:
+    ~FontConfigContext()
+    {
+        if (config)
+        {
+            FcConfigDestroy(config);
+        }
+    }
+
+    void setCacheFile(const std::string& file)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        cacheFile = file;
+        cacheFileLoaded = false;
+    }
+
+    bool resolve(const std::string& fontName, std::string& fontPath)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        loadConfig();
+        loadCacheFile();
+
+        auto cached = resolutions.find(fontName);
+        if (cached != resolutions.end() && fileExists(cached->second))
+        {
+            fontPath = cached->second;
+            return true;
+        }
+
+        if (!match(fontName, fontPath))
+        {
+            return false;
+        }
+
+        resolutions[fontName] = fontPath;
+        saveCacheFile();
+        return true;
+    }
+
+private:
+    static bool fileExists(const std::string& path)
+    {
+        struct stat fileStat;
+        return stat(path.c_str(), &fileStat) == 0;
+    }
+
+    static void addModificationTime(const FcChar8* path, long long& latest)
+    {
+        struct stat dirStat;
+        if (stat(reinterpret_cast<const char*>(path), &dirStat) == 0)
+        {
+            latest = std::max(latest, static_cast<long long>(dirStat.st_mtime));
+        }
+    }
+
+    void loadConfig()
+    {
+        if (config)
+        {
+            return;
+        }
+
+        // Only parse the configuration here, fonts are scanned on the first cache miss.
+        config = FcInitLoadConfig();
+        if (!config)
+        {
+            throw std::runtime_error("fontconfig could not be initialized");
+        }
+
+        long long latest = 0;
+        FcStrList* dirs = FcConfigGetFontDirs(config);
+        while (const FcChar8* dir = FcStrListNext(dirs))
+        {
+            addModificationTime(dir, latest);
+        }
+        FcStrListDone(dirs);
+
+        dirs = FcConfigGetCacheDirs(config);
+        while (const FcChar8* dir = FcStrListNext(dirs))
+        {
+            addModificationTime(dir, latest);
+        }
+        FcStrListDone(dirs);
+
+        cacheKey = std::to_string(FcGetVersion()) + ":" + std::to_string(latest);
+    }
+
+    void loadCacheFile()
+    {
+        if (cacheFileLoaded || cacheFile.empty())
+        {
+            return;
+        }
+        cacheFileLoaded = true;
+
+        std::ifstream in{cacheFile};
+        std::string key;
+        if (!std::getline(in, key) || key != cacheKey)
+        {
+            return;
+        }
+
+        std::string name, path;
+        while (std::getline(in, name, '\t') && std::getline(in, path))
+        {
+            resolutions.emplace(name, path);
+        }
+    }
+
+    void saveCacheFile() const
+    {
+        if (cacheFile.empty())
+        {
+            return;
+        }
+
+        // Write to a temporary file first, so concurrent readers never see a partial cache. Its name is unique
+        // across the processes that share the cache file, which the mutex does not cover.
+        const std::string tmpFile =
+            cacheFile + "." + std::to_string(getpid()) + "." + std::to_string(tempCounter++) + ".tmp";
+        {
+            std::ofstream out{tmpFile};
+            out << cacheKey << '\n';
+            for (const auto& resolution : resolutions)
+            {
+                out << resolution.first << '\t' << resolution.second << '\n';
+            }
+            if (!out.good())
+            {
+                out.close();
+                std::remove(tmpFile.c_str());
+                return;
+            }
+        }
+        if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0)
+        {
+            std::remove(tmpFile.c_str());
+        }
+    }
+
+    bool match(const std::string& fontName, std::string& fontPath)
+    {
+        if (!fontsBuilt)
+        {
+            fontsBuilt = FcConfigBuildFonts(config) == FcTrue;
+        }
+
+        FcPattern* pat = FcNameParse(reinterpret_cast<const FcChar8*>(fontName.c_str()));
+        FcConfigSubstitute(config, pat, FcMatchPattern);
+        FcDefaultSubstitute(pat);
+
+        FcResult result;
+        FcPattern* font = FcFontMatch(config, pat, &result);
+
+        bool found = false;
+        if (result == FcResultMatch) {
+            FcChar8* file;
+            found = FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch;
+            if (found) {
+                fontPath.assign(reinterpret_cast<char*>(file));
+            }
+            FcPatternDestroy(font);
+        }
+        FcPatternDestroy(pat);
+        return found;
+    }
+
+    std::mutex mutex;
+    FcConfig* config = nullptr;
+    bool fontsBuilt = false;
+    std::string cacheKey;
+    std::string cacheFile;
+    bool cacheFileLoaded = false;
+    std::map<std::string, std::string> resolutions;
+    mutable unsigned int tempCounter = 0;
+};
+
+
+FontConfigContext& fontConfigContext()
+{
+    static FontConfigContext context;
+    return context;
+}
+
+
+} // namespace
+#endif
+
+
+namespace
+{
+
+
+/*
+ * Pixel extent of a monochrome rendering along one axis, given the outline's control box
+ * in 26.6 fixed point. Mirrors the rounding FreeType applies when it allocates the
+ * bitmap for FT_RENDER_MODE_MONO: the box is rounded so that pixel centers inside the
+ * outline are included, and a collapsed box grows by one pixel.
+ */
+FT_Pos monoExtent(FT_Pos min, FT_Pos max)
+{
+    FT_Pos pixelMin = (min >> 6) + (((min & 63) + 31) >> 6);
+    FT_Pos pixelMax = (max >> 6) + (((max & 63) + 32) >> 6);
+    return pixelMin == pixelMax ? 1 : pixelMax - pixelMin;
+}
+
+
+} // namespace
 
 
 namespace llassetgen
@@ -20,15 +255,20 @@ namespace llassetgen
 
 
 FontFinder FontFinder::fromPath(const std::string& fontPath) {
+    ProfileScope scope{"font load"};
+    return FontFinder::fromSource(FontSource::fromFile(fontPath));
+}
+
+FontFinder FontFinder::fromSource(std::shared_ptr<const FontSource> fontSource, long faceIndex) {
     FontFinder fontFinder{};
-    FT_Error err = FT_New_Face(freetype, fontPath.c_str(), 0, &fontFinder.fontFace);
-    if (err) {
-        throw std::runtime_error("font could not be loaded");
-    }
+    fontFinder.fontFace = fontSource->openFace(faceIndex);
+    fontFinder.face.reset(fontFinder.fontFace, FontSource::closeFace);
+    fontFinder.source = std::move(fontSource);
     return fontFinder;
 }
 
 FontFinder FontFinder::fromName(const std::string& fontName) {
+    ProfileScope scope{"font lookup"};
 #if defined(__unix__) || defined(__APPLE__)
     std::string fontPath;
     if (!findFontPath(fontName, fontPath)) {
@@ -36,48 +276,31 @@ FontFinder FontFinder::fromName(const std::string& fontName) {
     }
     return FontFinder::fromPath(fontPath);
 #elif _WIN32
-    FontFinder fontFinder;
-
-    if (!fontFinder.getFontData(fontName)) {
+    std::vector<FT_Byte> fontData;
+    if (!getFontData(fontName, fontData)) {
         throw std::runtime_error("font not found");
     }
+    return FontFinder::fromSource(FontSource::fromMemory(std::move(fontData)));
+#endif
+}
 
-    FT_Error err =
-        FT_New_Memory_Face(freetype, &fontFinder.fontData[0], fontFinder.fontData.size(), 0, &fontFinder.fontFace);
-    if (err) {
-        throw std::runtime_error("font could not be loaded");
-    }
-    return fontFinder;
+void FontFinder::setFontCacheFile(const std::string& cacheFile) {
+#if defined(__unix__) || defined(__APPLE__)
+    fontConfigContext().setCacheFile(cacheFile);
+#else
+    (void)cacheFile;
 #endif
 }
 
 #if defined(__unix__) || defined(__APPLE__)
 bool FontFinder::findFontPath(const std::string& fontName, std::string& fontPath) {
-    FcConfig* config = FcInitLoadConfigAndFonts();
-    FcPattern* pat = FcNameParse(reinterpret_cast<const FcChar8*>(fontName.c_str()));
-    FcConfigSubstitute(config, pat, FcMatchPattern);
-    FcDefaultSubstitute(pat);
-
-    FcResult result;
-    FcPattern* font = FcFontMatch(config, pat, &result);
-
-    bool found = false;
-    if (result == FcResultMatch) {
-        FcChar8* file;
-        found = FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch;
-        if (found) {
-            fontPath.assign(reinterpret_cast<char*>(file));
-        }
-        FcPatternDestroy(font);
-    }
-    FcPatternDestroy(pat);
-    return found;
+    return fontConfigContext().resolve(fontName, fontPath);
 }
 
 #endif
 
 #if _WIN32
-bool FontFinder::getFontData(const std::string& fontName) {
+bool FontFinder::getFontData(const std::string& fontName, std::vector<FT_Byte>& fontData) {
     bool result = false;
 
     LOGFONTA lf;
@@ -111,12 +334,30 @@ void FontFinder::setFontSize(int size) {
     }
 }
 
+FT_UInt FontFinder::glyphIndex(unsigned long glyph) const
+{
+    return FT_Get_Char_Index(fontFace, static_cast<FT_ULong>(glyph));
+}
+
 Image FontFinder::renderGlyph(unsigned long glyph, size_t padding, size_t divisibleBy)
 {
-    FT_UInt charIndex = FT_Get_Char_Index(fontFace, static_cast<FT_ULong>(glyph));
-    if (charIndex == 0) {
-        std::cerr << "Warning: font does not contain glyph with code " << glyph << std::endl;
-    }
+    return renderIndex(glyphIndex(glyph), glyph, padding, divisibleBy);
+}
+
+Image FontFinder::renderGlyph(unsigned long glyph, size_t padding, size_t divisibleBy, const Vec2<size_t>& size)
+{
+    return fitImage(renderGlyph(glyph, padding, divisibleBy), size);
+}
+
+Image FontFinder::renderGlyph(const GlyphRecord& record, size_t padding, size_t divisibleBy)
+{
+    return fitImage(renderIndex(record.gindex, record.charcode, padding, divisibleBy), record.size);
+}
+
+Image FontFinder::renderIndex(FT_UInt charIndex, unsigned long glyph, size_t padding, size_t divisibleBy)
+{
+    ProfileScope scope{"render glyph"};
+    scope.setCount("charcode", glyph);
 
     FT_Error err = FT_Load_Glyph(fontFace, charIndex, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO);
     FT_Bitmap& bitmap = fontFace->glyph->bitmap;
@@ -126,6 +367,58 @@ Image FontFinder::renderGlyph(unsigned long glyph, size_t padding, size_t divisi
     return {bitmap, padding, divisibleBy};
 }
 
+Image FontFinder::fitImage(Image rendered, const Vec2<size_t>& size)
+{
+    if (rendered.getSize() == size)
+    {
+        return rendered;
+    }
+
+    Image fitted{size.x, size.y, 1};
+    fitted.clear();
+    const Vec2<size_t> overlap{std::min(size.x, rendered.getWidth()), std::min(size.y, rendered.getHeight())};
+    fitted.view({0, 0}, overlap).copyDataFrom(rendered.view({0, 0}, overlap));
+    return fitted;
+}
+
+Vec2<size_t> FontFinder::glyphSize(unsigned long glyph, size_t padding, size_t divisibleBy)
+{
+    return glyphRecord(glyph, padding, divisibleBy).size;
+}
+
+GlyphRecord FontFinder::glyphRecord(unsigned long glyph, size_t padding, size_t divisibleBy)
+{
+    GlyphRecord record{};
+    record.charcode = glyph;
+    record.gindex = glyphIndex(glyph);
+
+    FT_Error err = FT_Load_Glyph(fontFace, record.gindex, FT_LOAD_TARGET_MONO);
+    const FT_GlyphSlot slot = fontFace->glyph;
+    if (!err && slot->format == FT_GLYPH_FORMAT_OUTLINE)
+    {
+        FT_BBox cbox;
+        FT_Outline_Get_CBox(&slot->outline, &cbox);
+        record.bitmapSize = {static_cast<size_t>(monoExtent(cbox.xMin, cbox.xMax)),
+                             static_cast<size_t>(monoExtent(cbox.yMin, cbox.yMax))};
+        record.bitmapOrigin = {static_cast<FT_Int>((cbox.xMin >> 6) + (((cbox.xMin & 63) + 31) >> 6)),
+                               static_cast<FT_Int>((cbox.yMax >> 6) + (((cbox.yMax & 63) + 32) >> 6))};
+    }
+    else if (!err && slot->format == FT_GLYPH_FORMAT_BITMAP)
+    {
+        record.bitmapSize = {slot->bitmap.width, slot->bitmap.rows};
+        record.bitmapOrigin = {slot->bitmap_left, slot->bitmap_top};
+    }
+
+    if (record.bitmapSize.x == 0 || record.bitmapSize.y == 0) {
+        throw std::runtime_error("glyph with code " + std::to_string(glyph) + " could not be rendered");
+    }
+    record.size = {Image::divisiblePadding(record.bitmapSize.x, padding, divisibleBy),
+                   Image::divisiblePadding(record.bitmapSize.y, padding, divisibleBy)};
+    record.linearHoriAdvance = slot->linearHoriAdvance;
+    record.vertBearingY = slot->metrics.vertBearingY;
+    return record;
+}
+
 std::vector<Image> FontFinder::renderGlyphs(const std::set<unsigned long>& glyphs, int size, size_t padding, size_t divisibleBy)
 {
     setFontSize(size);
@@ -140,5 +433,45 @@ std::vector<Image> FontFinder::renderGlyphs(const std::set<unsigned long>& glyph
     return v;
 }
 
+std::set<unsigned long> FontFinder::allGlyphs() const
+{
+    std::set<unsigned long> glyphs;
+    FT_UInt gindex;
+    for (FT_ULong charcode = FT_Get_First_Char(fontFace, &gindex); gindex != 0;
+         charcode = FT_Get_Next_Char(fontFace, charcode, &gindex))
+    {
+        glyphs.insert(charcode);
+    }
+    return glyphs;
+}
+
+std::vector<Vec2<size_t>> FontFinder::glyphSizes(const std::set<unsigned long>& glyphs, int size, size_t padding,
+                                                 size_t divisibleBy)
+{
+    std::vector<GlyphRecord> records = glyphRecords(glyphs, size, padding, divisibleBy);
+    std::vector<Vec2<size_t>> v;
+    v.reserve(records.size());
+    for (const auto& record : records)
+    {
+        v.push_back(record.size);
+    }
+    return v;
+}
+
+std::vector<GlyphRecord> FontFinder::glyphRecords(const std::set<unsigned long>& glyphs, int size, size_t padding,
+                                                  size_t divisibleBy)
+{
+    ProfileScope scope{"glyph records"};
+    scope.setCount("glyphs", glyphs.size());
+    setFontSize(size);
+
+    std::vector<GlyphRecord> v;
+    v.reserve(glyphs.size());
+    for (const auto glyph : glyphs)
+    {
+        v.push_back(glyphRecord(glyph, padding, divisibleBy));
+    }
+    return v;
+}
 
 } // namespace llassetgen
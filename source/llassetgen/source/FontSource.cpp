@@ -0,0 +1,180 @@
+#include <llassetgen/FontSource.h>
+
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <llassetgen/llassetgen.h>
+
+
+namespace
+{
+
+
+// Sources by path, so that repeated lookups of the same file share one mapping.
+std::mutex registryMutex;
+std::map<std::string, std::weak_ptr<const llassetgen::FontSource>> registry;
+
+// FT_New_Memory_Face and FT_Done_Face modify the library's face list and are not thread safe.
+std::mutex libraryMutex;
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+std::shared_ptr<const FontSource> FontSource::fromFile(const std::string& fontPath)
+{
+    std::lock_guard<std::mutex> lock{registryMutex};
+    std::shared_ptr<const FontSource> existing = registry[fontPath].lock();
+    if (existing)
+    {
+        return existing;
+    }
+
+    std::shared_ptr<FontSource> source{new FontSource};
+    source->filePath = fontPath;
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(fontPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("font could not be loaded");
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fd);
+        throw std::runtime_error("font could not be loaded");
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("font could not be loaded");
+    }
+
+    source->mappedData = static_cast<const FT_Byte*>(mapping);
+    source->mappedSize = static_cast<size_t>(fileStat.st_size);
+#elif _WIN32
+    HANDLE file = CreateFileA(fontPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("font could not be loaded");
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("font could not be loaded");
+    }
+
+    source->fileHandle = file;
+    source->mappingHandle = mapping;
+    source->mappedData = static_cast<const FT_Byte*>(view);
+    source->mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#endif
+
+    registry[fontPath] = source;
+    return source;
+}
+
+std::shared_ptr<const FontSource> FontSource::fromMemory(std::vector<FT_Byte> fontData)
+{
+    std::shared_ptr<FontSource> source{new FontSource};
+    source->ownedData = std::move(fontData);
+    source->mappedData = source->ownedData.data();
+    source->mappedSize = source->ownedData.size();
+    return source;
+}
+
+FontSource::~FontSource()
+{
+    if (ownedData.empty() && mappedData)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(const_cast<FT_Byte*>(mappedData), mappedSize);
+#elif _WIN32
+        UnmapViewOfFile(mappedData);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+#endif
+    }
+}
+
+const FT_Byte* FontSource::data() const
+{
+    return mappedData;
+}
+
+size_t FontSource::size() const
+{
+    return mappedSize;
+}
+
+const std::string& FontSource::path() const
+{
+    return filePath;
+}
+
+uint64_t FontSource::contentHash() const
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < mappedSize; ++i)
+    {
+        hash = (hash ^ mappedData[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+FT_Face FontSource::openFace(long faceIndex) const
+{
+    FT_Face face;
+    FT_Error err;
+    {
+        std::lock_guard<std::mutex> lock{libraryMutex};
+        err = FT_New_Memory_Face(freetype, mappedData, static_cast<FT_Long>(mappedSize), faceIndex, &face);
+    }
+    if (err)
+    {
+        throw std::runtime_error("font could not be loaded");
+    }
+    return face;
+}
+
+void FontSource::closeFace(FT_Face face)
+{
+    std::lock_guard<std::mutex> lock{libraryMutex};
+    FT_Done_Face(face);
+}
+
+
+} // namespace llassetgen
@@ -1,5 +1,6 @@
 
 #include <llassetgen/Image.h>
+#include <llassetgen/Profiler.h>
 
 
 #include <cassert>
@@ -7,6 +8,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 /*
@@ -26,6 +28,24 @@
 // clang-format on
 
 
+namespace
+{
+
+
+/*
+ * Map a pixel value to 16 bit, so that `black` becomes 0 and `white` becomes the maximum.
+ */
+template <typename pixelType>
+uint16_t quantizePixel(const pixelType value, const pixelType black, const pixelType white)
+{
+    auto normalized = static_cast<float>(value - black) / static_cast<float>(white - black);
+    return clamp(normalized, 0.0F, 1.0F) * std::numeric_limits<uint16_t>::max();
+}
+
+
+} // namespace
+
+
 namespace llassetgen
 {
 
@@ -84,6 +104,7 @@ Image::Image(size_t width, size_t height, size_t _bitDepth)
 , data(new uint8_t[stride * height])
 , isOwnerOfData(true)
 {
+    Profiler::countImageBytes(stride * height);
 }
 
 
@@ -247,6 +268,7 @@ template LLASSETGEN_API void Image::centerDownsampling<uint8_t>(const Image& src
 template <typename pixelType>
 void Image::centerDownsampling(const Image& src) const
 {
+    ProfileScope scope{"downsampling"};
     assert(src.getWidth()%getWidth() == 0 && src.getHeight()%getHeight() == 0);
 
     size_t x_scale = src.getWidth()/getWidth(),
@@ -269,6 +291,7 @@ template LLASSETGEN_API void Image::averageDownsampling<uint8_t>(const Image& sr
 template <typename pixelType>
 void Image::averageDownsampling(const Image& src) const
 {
+    ProfileScope scope{"downsampling"};
     assert(src.getWidth()%getWidth() == 0 && src.getHeight()%getHeight() == 0);
 
     size_t x_scale = src.getWidth()/getWidth(),
@@ -300,6 +323,7 @@ template LLASSETGEN_API void Image::minDownsampling<uint8_t>(const Image& src) c
 template <typename pixelType>
 void Image::minDownsampling(const Image& src) const
 {
+    ProfileScope scope{"downsampling"};
     assert(src.getWidth()%getWidth() == 0 && src.getHeight()%getHeight() == 0);
     size_t x_scale = src.getWidth()/getWidth(),
            y_scale = src.getHeight()/getHeight();
@@ -375,14 +399,20 @@ size_t Image::getFtBitdepth(const FT_Bitmap& ft_bitmap)
 void Image::readData(png_structp png, png_bytep data, png_size_t length)
 {
     png_voidp a = png_get_io_ptr(png);
-    ((std::istream*)a)->read((char*)data, length);
+    if (!((std::istream*)a)->read((char*)data, length))
+    {
+        png_error(png, "unexpected end of file");
+    }
 }
 
 
 void Image::writeData(png_structp png, png_bytep data, png_size_t length)
 {
     png_voidp a = png_get_io_ptr(png);
-    ((std::ostream*)a)->write((char*)data, length);
+    if (!((std::ostream*)a)->write((char*)data, length))
+    {
+        png_error(png, "write error");
+    }
 }
 
 
@@ -410,34 +440,19 @@ Image::Image(const std::string& filepath, uint8_t _bitDepth)
 
     if (!in_file.good())
     {
-        std::cerr << "could not read from file";
-        abort();
+        throw std::runtime_error("could not read file " + filepath);
     }
     if (png_sig_cmp(pngsig, 0, 8))
     {
-        std::cerr << "no PNG file signature";
-        abort();
+        throw std::runtime_error("no PNG file signature in " + filepath);
     }
 
     png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png)
-    {
-        std::cerr << "failed to create png read struct";
-        abort();
-    }
-
-    png_infop info = png_create_info_struct(png);
-    if (!info)
-    {
-        png_destroy_read_struct(&png, (png_infopp)0, (png_infopp)0);
-        std::cerr << "failed to create png info struct";
-        abort();
-    }
-
-    if (setjmp(png_jmpbuf(png)))
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info || setjmp(png_jmpbuf(png)))
     {
-        std::cerr << "pnglib caused a longjump due to an error";
-        abort();
+        png_destroy_read_struct(&png, &info, (png_infopp)0);
+        throw std::runtime_error("could not read file " + filepath);
     }
 
     png_set_read_fn(png, (png_voidp)&in_file, readData);
@@ -488,12 +503,18 @@ Image::Image(const std::string& filepath, uint8_t _bitDepth)
     uint8_t png_bitDepth = png_get_bit_depth(png, info);
     size_t png_stride = (getWidth() * png_bitDepth + 7) / 8;
 
-    std::unique_ptr<png_bytep> row_ptrs(new png_bytep[getHeight()]);
-    std::unique_ptr<uint8_t> multi_channel_data(new uint8_t[getHeight() * png_stride * channels]);
+    std::unique_ptr<png_bytep[]> row_ptrs(new png_bytep[getHeight()]);
+    std::unique_ptr<uint8_t[]> multi_channel_data(new uint8_t[getHeight() * png_stride * channels]);
     for (size_t i = 0; i < getHeight(); i++) {
         row_ptrs.get()[i] = (png_bytep)multi_channel_data.get() + i * png_stride * channels;
     }
 
+    // The buffers are not changed below, so they are still valid after a longjmp and are freed by the throw.
+    if (setjmp(png_jmpbuf(png)))
+    {
+        png_destroy_read_struct(&png, &info, (png_infopp)0);
+        throw std::runtime_error("could not read file " + filepath);
+    }
     png_read_image(png, row_ptrs.get());
 
     png_destroy_read_struct(&png, &info, (png_infopp)0);
@@ -503,12 +524,15 @@ Image::Image(const std::string& filepath, uint8_t _bitDepth)
     stride = (getWidth() * bitDepth + 7) / 8;
     data = new uint8_t[stride * getHeight()];
     isOwnerOfData = true;
+    Profiler::countImageBytes(stride * getHeight());
 
     for (size_t y = 0; y < getHeight(); y++)
     {
         for (size_t x = 0; x < getWidth(); x++)
         {
-            const auto pixel = multi_channel_data.get()[y * png_stride * channels + x * png_bitDepth / 8 * channels];
+            const uint8_t* bytes = multi_channel_data.get() + y * png_stride * channels + x * png_bitDepth / 8 * channels;
+            // 16 bit samples are stored in network byte order
+            const uint32_t pixel = (png_bitDepth == 16) ? (uint32_t(bytes[0]) << 8) | bytes[1] : bytes[0];
             const auto reducedPixel = reduceBitDepth(pixel, png_bitDepth, bitDepth);
             setPixel<uint16_t>({x, y}, reducedPixel);
         }
@@ -523,33 +547,24 @@ template LLASSETGEN_API void Image::exportPng<float>(const std::string& filepath
 template <typename pixelType>
 void Image::exportPng(const std::string& filepath, pixelType black, pixelType white)
 {
+    ProfileScope scope{"png export"};
+    scope.setCount("pixels", getWidth() * getHeight());
+
     std::ofstream out_file(filepath, std::ofstream::out | std::ofstream::binary);
     if (!out_file.good())
     {
-        std::cerr << "could not open file " << filepath;
-        abort();
-    }
-
-    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!png)
-    {
-        std::cerr << "failed to create png write struct";
-        abort();
+        throw std::runtime_error("could not open file " + filepath);
     }
 
-    png_infop info = png_create_info_struct(png);
-    if (!info)
-    {
-        png_destroy_write_struct(&png, (png_infopp)0);
-        std::cerr << "failed to create png info struct";
-        abort();
-    }
+    // Allocated before setjmp, so that a longjmp leaves it valid and the throw frees it.
+    std::unique_ptr<uint16_t[]> row((bitDepth >= 24) ? new uint16_t[getWidth()] : nullptr);
 
-    if (setjmp(png_jmpbuf(png)))
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info || setjmp(png_jmpbuf(png)))
     {
-        std::cerr << "pnglib caused a longjump due to an error" << std::endl;
-        std::cerr << "could not write file " << filepath;
-        abort();
+        png_destroy_write_struct(&png, &info);
+        throw std::runtime_error("could not write file " + filepath);
     }
 
     png_set_write_fn(png, (png_voidp)&out_file, writeData, flushData);
@@ -573,15 +588,12 @@ void Image::exportPng(const std::string& filepath, pixelType black, pixelType wh
 
     if (bitDepth >= 24)
     {
-        std::unique_ptr<uint16_t[]> row(new uint16_t[getWidth()]);
         // possible 32 float or 32 or 24 bit int data
         // scale down to 16 bit int grayscale
 
         for (size_t y = 0; y < getHeight(); y++) {
             for (size_t x = 0; x < getWidth(); x++) {
-                auto value =
-                    static_cast<float>(getPixel<pixelType>({x, y}) - black) / static_cast<float>(white - black);
-                row[x] = clamp(value, 0.0F, 1.0F) * std::numeric_limits<uint16_t>::max();
+                row[x] = quantizePixel(getPixel<pixelType>({x, y}), black, white);
             }
             png_write_row(png, reinterpret_cast<png_bytep>(row.get()));
         }
@@ -599,6 +611,10 @@ void Image::exportPng(const std::string& filepath, pixelType black, pixelType wh
 
     png_destroy_write_struct(&png, &info);
     out_file.close();
+    if (out_file.fail())
+    {
+        throw std::runtime_error("could not write file " + filepath);
+    }
 }
 
 
@@ -608,12 +624,30 @@ Vec2<size_t> Image::getSize() const
 }
 
 
+size_t Image::getByteSize() const
+{
+    return (getWidth() * bitDepth + 7) / 8 * getHeight();
+}
+
+
 void Image::copyDataFrom(const Image& src)
 {
     assert(getHeight() == src.getHeight() &&
            getWidth() == src.getWidth() &&
            getBitDepth() == src.getBitDepth());
 
+    if (bitDepth % 8 == 0)
+    {
+        const size_t rowLength = getWidth() * bitDepth / 8;
+        for (size_t y = 0; y < getHeight(); y++)
+        {
+            memmove(&data[(min.y + y) * stride + min.x * bitDepth / 8],
+                    &src.data[(src.min.y + y) * src.stride + src.min.x * bitDepth / 8],
+                    rowLength);
+        }
+        return;
+    }
+
     for (size_t y = 0; y < getHeight(); y++)
     {
         for (size_t x = 0; x < getWidth(); x++)
@@ -625,6 +659,24 @@ void Image::copyDataFrom(const Image& src)
 }
 
 
+template LLASSETGEN_API void Image::quantizeFrom<float>(const Image& src, float black, float white) const;
+template LLASSETGEN_API void Image::quantizeFrom<uint32_t>(const Image& src, uint32_t black, uint32_t white) const;
+template <typename pixelType>
+void Image::quantizeFrom(const Image& src, const pixelType black, const pixelType white) const
+{
+    assert(getHeight() == src.getHeight() && getWidth() == src.getWidth() && bitDepth == 16);
+
+    for (size_t y = 0; y < getHeight(); y++)
+    {
+        for (size_t x = 0; x < getWidth(); x++)
+        {
+            const Vec2<size_t> pos{x, y};
+            setPixel<uint16_t>(pos, quantizePixel(src.getPixel<pixelType>(pos), black, white));
+        }
+    }
+}
+
+
 size_t Image::divisiblePadding(const size_t size, const size_t padding, const size_t divisor)
 {
     const size_t paddedSize = size + 2 * padding;
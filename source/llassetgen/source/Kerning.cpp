@@ -0,0 +1,465 @@
+#include <llassetgen/Kerning.h>
+
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+
+
+namespace
+{
+
+
+using PairKey = std::pair<FT_UInt, FT_UInt>;
+using PairAmounts = std::map<PairKey, FT_Pos>;
+
+
+// Raw SFNT table with big-endian accessors. Reads past the end yield 0, so
+// broken offsets and counts end up as empty lists instead of overruns.
+class SfntTable
+{
+public:
+    SfntTable(FT_Face face, FT_ULong tag)
+    {
+        FT_ULong length = 0;
+        if (FT_Load_Sfnt_Table(face, tag, 0, nullptr, &length) == 0 && length > 0)
+        {
+            bytes.resize(length);
+            if (FT_Load_Sfnt_Table(face, tag, 0, bytes.data(), &length) != 0)
+            {
+                bytes.clear();
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        return bytes.empty();
+    }
+
+    size_t size() const
+    {
+        return bytes.size();
+    }
+
+    uint16_t u16(size_t offset) const
+    {
+        if (offset + 2 > bytes.size())
+        {
+            return 0;
+        }
+        return static_cast<uint16_t>((bytes[offset] << 8) | bytes[offset + 1]);
+    }
+
+    int16_t s16(size_t offset) const
+    {
+        return static_cast<int16_t>(u16(offset));
+    }
+
+    uint32_t u32(size_t offset) const
+    {
+        return (uint32_t(u16(offset)) << 16) | u16(offset + 2);
+    }
+
+private:
+    std::vector<FT_Byte> bytes;
+};
+
+
+bool isWanted(const std::vector<bool>& wanted, FT_UInt gindex)
+{
+    return gindex < wanted.size() && wanted[gindex];
+}
+
+
+// Format 0 subtables of the `kern` table, combined the way FreeType's
+// tt_face_get_kerning does: horizontal subtables only, later subtables add
+// to the amount unless they have the override bit set.
+void readKernTable(const SfntTable& kern, const std::vector<bool>& wanted, PairAmounts& amounts)
+{
+    if (kern.u16(0) != 0)
+    {
+        // Apple's version 1 table is not supported by FreeType either
+        return;
+    }
+
+    size_t offset = 4;
+    for (unsigned int table = kern.u16(2); table > 0 && offset + 6 <= kern.size(); --table)
+    {
+        size_t length = kern.u16(offset + 2);
+        unsigned int coverage = kern.u16(offset + 4);
+        if (length <= 6 + 8)
+        {
+            break;
+        }
+        size_t next = std::min(offset + length, kern.size());
+
+        // Horizontal format 0 subtables without minimum values. tt_face_load_kern of current
+        // FreeType tests `coverage & 3` like this and keeps cross-stream and override subtables,
+        // while older versions also skipped cross-stream ones with `(coverage & ~8) == 1`.
+        if ((coverage >> 8) == 0 && (coverage & 3U) == 1)
+        {
+            size_t pairOffset = offset + 14;
+            size_t pairCount = std::min<size_t>(kern.u16(offset + 6), (next - std::min(next, pairOffset)) / 6);
+            for (size_t i = 0; i < pairCount; ++i, pairOffset += 6)
+            {
+                FT_UInt left = kern.u16(pairOffset);
+                FT_UInt right = kern.u16(pairOffset + 2);
+                if (!isWanted(wanted, left) || !isWanted(wanted, right))
+                {
+                    continue;
+                }
+
+                FT_Pos value = kern.s16(pairOffset + 4);
+                if (coverage & 8)
+                {
+                    amounts[PairKey(left, right)] = value;
+                }
+                else
+                {
+                    amounts[PairKey(left, right)] += value;
+                }
+            }
+        }
+
+        offset = next;
+    }
+}
+
+
+// Index of a glyph in an OpenType coverage table, or -1 if it is not covered.
+long coverageIndex(const SfntTable& gpos, size_t coverage, FT_UInt gindex)
+{
+    unsigned int count = gpos.u16(coverage + 2);
+    if (gpos.u16(coverage) == 1)
+    {
+        // sorted glyph array
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            FT_UInt glyph = gpos.u16(coverage + 4 + 2 * mid);
+            if (glyph == gindex)
+            {
+                return long(mid);
+            }
+            glyph < gindex ? lo = mid + 1 : hi = mid;
+        }
+    }
+    else if (gpos.u16(coverage) == 2)
+    {
+        // sorted glyph ranges with the coverage index of their first glyph
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            size_t range = coverage + 4 + 6 * mid;
+            if (gindex < gpos.u16(range))
+            {
+                hi = mid;
+            }
+            else if (gindex > gpos.u16(range + 2))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                return long(gpos.u16(range + 4) + (gindex - gpos.u16(range)));
+            }
+        }
+    }
+    return -1;
+}
+
+
+unsigned int glyphClass(const SfntTable& gpos, size_t classDef, FT_UInt gindex)
+{
+    if (gpos.u16(classDef) == 1)
+    {
+        FT_UInt start = gpos.u16(classDef + 2);
+        if (gindex >= start && gindex - start < gpos.u16(classDef + 4))
+        {
+            return gpos.u16(classDef + 6 + 2 * (gindex - start));
+        }
+    }
+    else if (gpos.u16(classDef) == 2)
+    {
+        size_t lo = 0, hi = gpos.u16(classDef + 2);
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            size_t range = classDef + 4 + 6 * mid;
+            if (gindex < gpos.u16(range))
+            {
+                hi = mid;
+            }
+            else if (gindex > gpos.u16(range + 2))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                return gpos.u16(range + 4);
+            }
+        }
+    }
+    return 0;
+}
+
+
+// The glyphs sorted into the classes of a class definition, classes out of
+// range are dropped.
+std::vector<std::vector<FT_UInt>> groupByClass(const SfntTable& gpos, size_t classDef, unsigned int classCount,
+                                               const std::vector<FT_UInt>& glyphs)
+{
+    std::vector<std::vector<FT_UInt>> groups(classCount);
+    for (FT_UInt gindex : glyphs)
+    {
+        unsigned int glyphClassValue = glyphClass(gpos, classDef, gindex);
+        if (glyphClassValue < classCount)
+        {
+            groups[glyphClassValue].push_back(gindex);
+        }
+    }
+    return groups;
+}
+
+
+// Size of a GPOS value record and the offset of its XAdvance field, or -1 if
+// the record has none.
+size_t valueRecordSize(unsigned int valueFormat)
+{
+    size_t fields = 0;
+    for (unsigned int bits = valueFormat & 0xFF; bits; bits >>= 1)
+    {
+        fields += bits & 1;
+    }
+    return 2 * fields;
+}
+
+long xAdvanceOffset(unsigned int valueFormat)
+{
+    if (!(valueFormat & 0x4))
+    {
+        return -1;
+    }
+    return 2 * long((valueFormat & 0x1) + ((valueFormat & 0x2) >> 1));
+}
+
+
+// Lookup indices referenced by any `kern` feature.
+std::set<unsigned int> kernLookups(const SfntTable& gpos)
+{
+    std::set<unsigned int> lookups;
+    size_t featureList = gpos.u16(6);
+    if (featureList == 0)
+    {
+        return lookups;
+    }
+
+    const uint32_t kernTag = FT_MAKE_TAG('k', 'e', 'r', 'n');
+    unsigned int featureCount = gpos.u16(featureList);
+    for (unsigned int i = 0; i < featureCount; ++i)
+    {
+        size_t record = featureList + 2 + 6 * i;
+        if (gpos.u32(record) != kernTag)
+        {
+            continue;
+        }
+        size_t feature = featureList + gpos.u16(record + 4);
+        unsigned int lookupCount = gpos.u16(feature + 2);
+        for (unsigned int j = 0; j < lookupCount; ++j)
+        {
+            lookups.insert(gpos.u16(feature + 4 + 2 * j));
+        }
+    }
+    return lookups;
+}
+
+
+// Pair adjustment subtables (lookup type 2, or 9 wrapping 2) of a lookup.
+std::vector<size_t> pairSubtables(const SfntTable& gpos, size_t lookup)
+{
+    std::vector<size_t> subtables;
+    unsigned int lookupType = gpos.u16(lookup);
+    unsigned int subtableCount = gpos.u16(lookup + 4);
+    for (unsigned int i = 0; i < subtableCount; ++i)
+    {
+        size_t subtable = lookup + gpos.u16(lookup + 6 + 2 * i);
+        if (lookupType == 2)
+        {
+            subtables.push_back(subtable);
+        }
+        else if (lookupType == 9 && gpos.u16(subtable) == 1 && gpos.u16(subtable + 2) == 2)
+        {
+            subtables.push_back(subtable + gpos.u32(subtable + 4));
+        }
+    }
+    return subtables;
+}
+
+
+// Horizontal pair adjustments of the `kern` feature. Within a lookup the
+// first subtable that matches a pair wins, the lookups themselves add up.
+void readGposTable(const SfntTable& gpos, const std::vector<bool>& wanted, const std::vector<FT_UInt>& glyphs,
+                   PairAmounts& amounts)
+{
+    if (gpos.u16(0) != 1)
+    {
+        return;
+    }
+
+    size_t lookupList = gpos.u16(8);
+    for (unsigned int lookupIndex : kernLookups(gpos))
+    {
+        if (lookupList == 0 || lookupIndex >= gpos.u16(lookupList))
+        {
+            continue;
+        }
+        size_t lookup = lookupList + gpos.u16(lookupList + 2 + 2 * lookupIndex);
+        std::vector<size_t> subtables = pairSubtables(gpos, lookup);
+        std::map<size_t, std::vector<std::vector<FT_UInt>>> classGroups;
+
+        for (FT_UInt left : glyphs)
+        {
+            // right glyphs already decided by an earlier subtable of this lookup
+            std::set<FT_UInt> decided;
+            for (size_t subtable : subtables)
+            {
+                long firstIndex = coverageIndex(gpos, subtable + gpos.u16(subtable + 2), left);
+                if (firstIndex < 0)
+                {
+                    continue;
+                }
+
+                unsigned int format1 = gpos.u16(subtable + 4);
+                unsigned int format2 = gpos.u16(subtable + 6);
+                size_t recordSize = valueRecordSize(format1) + valueRecordSize(format2);
+                long advance = xAdvanceOffset(format1);
+
+                if (gpos.u16(subtable) == 1)
+                {
+                    // explicit pairs, sorted by the right glyph
+                    if (firstIndex >= gpos.u16(subtable + 8))
+                    {
+                        continue;
+                    }
+                    size_t pairSet = subtable + gpos.u16(subtable + 10 + 2 * size_t(firstIndex));
+                    unsigned int pairCount = gpos.u16(pairSet);
+                    for (unsigned int i = 0; i < pairCount; ++i)
+                    {
+                        size_t record = pairSet + 2 + i * (2 + recordSize);
+                        FT_UInt right = gpos.u16(record);
+                        if (!isWanted(wanted, right) || !decided.insert(right).second || advance < 0)
+                        {
+                            continue;
+                        }
+                        amounts[PairKey(left, right)] += gpos.s16(record + 2 + size_t(advance));
+                    }
+                }
+                else if (gpos.u16(subtable) == 2)
+                {
+                    // class pairs, a covered left glyph matches every right glyph not decided yet
+                    size_t classDef1 = subtable + gpos.u16(subtable + 8);
+                    size_t classDef2 = subtable + gpos.u16(subtable + 10);
+                    unsigned int class1Count = gpos.u16(subtable + 12);
+                    unsigned int class2Count = gpos.u16(subtable + 14);
+                    unsigned int class1 = glyphClass(gpos, classDef1, left);
+                    if (class1 >= class1Count)
+                    {
+                        continue;
+                    }
+                    size_t class1Record = subtable + 16 + class1 * class2Count * recordSize;
+                    auto groups = classGroups.find(subtable);
+                    if (groups == classGroups.end())
+                    {
+                        groups = classGroups.insert({subtable, groupByClass(gpos, classDef2, class2Count, glyphs)}).first;
+                    }
+                    for (unsigned int class2 = 0; class2 < class2Count && advance >= 0; ++class2)
+                    {
+                        FT_Pos value = gpos.s16(class1Record + class2 * recordSize + size_t(advance));
+                        if (value == 0)
+                        {
+                            continue;
+                        }
+                        for (FT_UInt right : groups->second[class2])
+                        {
+                            if (!decided.count(right))
+                            {
+                                amounts[PairKey(left, right)] += value;
+                            }
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+std::vector<KerningPair> kerningPairs(FT_Face face, const std::vector<FT_UInt>& glyphs)
+{
+    std::vector<FT_UInt> unique(glyphs);
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    PairAmounts amounts;
+    if (FT_IS_SFNT(face))
+    {
+        std::vector<bool> wanted(unique.empty() ? 0 : unique.back() + 1, false);
+        for (FT_UInt gindex : unique)
+        {
+            wanted[gindex] = true;
+        }
+
+        SfntTable kern{face, TTAG_kern};
+        if (!kern.empty())
+        {
+            readKernTable(kern, wanted, amounts);
+        }
+        else
+        {
+            readGposTable(SfntTable{face, TTAG_GPOS}, wanted, unique, amounts);
+        }
+    }
+    else if (FT_HAS_KERNING(face))
+    {
+        for (FT_UInt left : unique)
+        {
+            for (FT_UInt right : unique)
+            {
+                FT_Vector kerningVector;
+                if (FT_Get_Kerning(face, left, right, FT_KERNING_UNSCALED, &kerningVector) == 0)
+                {
+                    amounts[PairKey(left, right)] = kerningVector.x;
+                }
+            }
+        }
+    }
+
+    std::vector<KerningPair> pairs;
+    for (const auto& amount : amounts)
+    {
+        if (amount.second != 0)
+        {
+            pairs.push_back({amount.first.first, amount.first.second, amount.second});
+        }
+    }
+    return pairs;
+}
+
+
+} // namespace llassetgen
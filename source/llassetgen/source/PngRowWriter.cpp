@@ -0,0 +1,110 @@
+#include <llassetgen/PngRowWriter.h>
+
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include <png.h> // NOLINT
+
+
+namespace llassetgen
+{
+
+
+PngRowWriter::PngRowWriter(const std::string& filepath, size_t _width, size_t _height, uint8_t _bitDepth)
+: file(std::fopen(filepath.c_str(), "wb"))
+, png(nullptr)
+, info(nullptr)
+, width(_width)
+, height(_height)
+, rowsWritten(0)
+, bitDepth(_bitDepth)
+, rowBuffer((_width * _bitDepth + 7) / 8)
+{
+    if (!file)
+    {
+        throw std::runtime_error("could not open file " + filepath);
+    }
+
+    png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    info = png ? png_create_info_struct(png) : nullptr;
+    if (!info || setjmp(png_jmpbuf(png)))
+    {
+        png_destroy_write_struct(&png, &info);
+        std::fclose(file);
+        throw std::runtime_error("could not write file " + filepath);
+    }
+
+    png_init_io(png, file);
+    png_set_IHDR(png, info, width, height, bitDepth, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_write_info(png, info);
+
+    if (bitDepth > 8)
+    {
+        png_set_swap(png);
+    }
+}
+
+
+PngRowWriter::~PngRowWriter()
+{
+    if (png)
+    {
+        png_destroy_write_struct(&png, &info);
+    }
+    if (file)
+    {
+        std::fclose(file);
+    }
+}
+
+
+void PngRowWriter::writeRow(const Image& row)
+{
+    assert(row.getWidth() == width && row.getHeight() == 1 && row.getBitDepth() == bitDepth);
+    assert(rowsWritten < height);
+
+    // Rows may be views into larger images, so repack them into the PNG row layout.
+    std::fill(rowBuffer.begin(), rowBuffer.end(), 0);
+    for (size_t x = 0; x < width; ++x)
+    {
+        if (bitDepth > 8)
+        {
+            reinterpret_cast<uint16_t*>(rowBuffer.data())[x] = row.getPixel<uint16_t>({x, 0});
+        }
+        else
+        {
+            const size_t bitOffset = x * bitDepth;
+            rowBuffer[bitOffset / 8] |= row.getPixel<uint8_t>({x, 0}) << (8 - bitDepth - bitOffset % 8);
+        }
+    }
+
+    if (setjmp(png_jmpbuf(png)))
+    {
+        throw std::runtime_error("pnglib caused a longjump due to an error");
+    }
+    png_write_row(png, rowBuffer.data());
+    ++rowsWritten;
+}
+
+
+void PngRowWriter::finish()
+{
+    assert(rowsWritten == height);
+
+    if (setjmp(png_jmpbuf(png)))
+    {
+        throw std::runtime_error("pnglib caused a longjump due to an error");
+    }
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    png = nullptr;
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+
+} // namespace llassetgen
@@ -0,0 +1,194 @@
+#include <llassetgen/Profiler.h>
+
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+
+namespace
+{
+
+
+struct Event
+{
+    const char* name;
+    uint32_t thread;
+    int64_t start;      // nanoseconds since recording was enabled
+    int64_t duration;
+    uint64_t imageBytes;
+    const char* countName;
+    uint64_t count;
+};
+
+
+std::mutex eventMutex;
+std::vector<Event> events;
+std::chrono::steady_clock::time_point origin;
+std::atomic<uint32_t> nextThread{1};
+
+// Threads are numbered in the order they first record something, starting
+// again whenever recording is enabled.
+std::atomic<uint32_t> generation{0};
+thread_local uint32_t threadGeneration = 0;
+thread_local uint32_t threadId = 0;
+thread_local uint64_t threadImageBytes = 0;
+
+
+uint32_t currentThread()
+{
+    const uint32_t current = generation.load(std::memory_order_relaxed);
+    if (threadGeneration != current)
+    {
+        threadGeneration = current;
+        threadId = nextThread++;
+    }
+    return threadId;
+}
+
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+
+// Microseconds with nanosecond precision, as the trace format expects
+void writeMicroseconds(std::ofstream& out, int64_t nanoseconds)
+{
+    out << nanoseconds / 1000 << '.' << static_cast<char>('0' + nanoseconds / 100 % 10)
+        << static_cast<char>('0' + nanoseconds / 10 % 10) << static_cast<char>('0' + nanoseconds % 10);
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+std::atomic<bool> Profiler::enabled{false};
+
+
+void Profiler::enable()
+{
+    std::lock_guard<std::mutex> lock{eventMutex};
+    events.clear();
+    origin = std::chrono::steady_clock::now();
+    ++generation;
+    nextThread = 1;
+    currentThread();
+    enabled = true;
+}
+
+
+void Profiler::disable()
+{
+    enabled = false;
+}
+
+
+void Profiler::addImageBytes(size_t bytes)
+{
+    threadImageBytes += bytes;
+}
+
+
+void Profiler::writeTrace(const std::string& filepath)
+{
+    std::ofstream out{filepath};
+    if (!out)
+    {
+        throw std::runtime_error("trace file could not be opened");
+    }
+
+    std::lock_guard<std::mutex> lock{eventMutex};
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* separator = "\n";
+    for (uint32_t thread = 1; thread < nextThread; ++thread)
+    {
+        out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+            << ",\"args\":{\"name\":\"";
+        if (thread == 1)
+        {
+            out << "main";
+        }
+        else
+        {
+            out << "worker " << thread - 1;
+        }
+        out << "\"}}";
+        separator = ",\n";
+    }
+
+    for (const Event& event : events)
+    {
+        out << separator << "{\"name\":\"" << event.name << "\",\"cat\":\"llassetgen\",\"ph\":\"X\",\"pid\":1,"
+            << "\"tid\":" << event.thread << ",\"ts\":";
+        writeMicroseconds(out, event.start);
+        out << ",\"dur\":";
+        writeMicroseconds(out, event.duration);
+        out << ",\"args\":{\"imageBytes\":" << event.imageBytes;
+        if (event.countName)
+        {
+            out << ",\"" << event.countName << "\":" << event.count;
+        }
+        out << "}}";
+        separator = ",\n";
+    }
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        throw std::runtime_error("trace file could not be written");
+    }
+}
+
+
+std::vector<ProfileStage> Profiler::stages()
+{
+    std::lock_guard<std::mutex> lock{eventMutex};
+    std::vector<ProfileStage> stages;
+    for (const Event& event : events)
+    {
+        auto stage = std::find_if(stages.begin(), stages.end(),
+                                  [&](const ProfileStage& s) { return s.name == event.name; });
+        if (stage == stages.end())
+        {
+            stages.push_back({event.name, 0, 0, 0});
+            stage = stages.end() - 1;
+        }
+        stage->calls++;
+        stage->seconds += event.duration * 1e-9;
+        stage->imageBytes += event.imageBytes;
+    }
+    return stages;
+}
+
+
+void ProfileScope::begin(const char* _name)
+{
+    name = _name;
+    startImageBytes = threadImageBytes;
+    start = now();
+}
+
+
+void ProfileScope::end()
+{
+    const int64_t endTime = now();
+    const uint64_t imageBytes = threadImageBytes - startImageBytes;
+    std::lock_guard<std::mutex> lock{eventMutex};
+    if (!Profiler::isEnabled())
+    {
+        return;
+    }
+    events.push_back({name, currentThread(), start, endTime - start, imageBytes, count.name, count.value});
+}
+
+
+} // namespace llassetgen
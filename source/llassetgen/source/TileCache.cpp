@@ -0,0 +1,349 @@
+#include <llassetgen/TileCache.h>
+
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#elif _WIN32
+#include <direct.h>
+#include <process.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <zlib.h>
+
+
+namespace
+{
+
+
+constexpr char tileMagic[4] = {'L', 'L', 'T', 'C'};
+constexpr uint32_t tileVersion = 1;
+
+// Distinguishes the temporary files of concurrent stores within one process.
+std::atomic<unsigned int> tempCounter{0};
+
+
+void makeDirectory(const std::string& path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    mkdir(path.c_str(), 0777);
+#elif _WIN32
+    _mkdir(path.c_str());
+#endif
+}
+
+void makeDirectories(const std::string& path)
+{
+    for (size_t separator = path.find_first_of("/\\", 1); separator != std::string::npos;
+         separator = path.find_first_of("/\\", separator + 1))
+    {
+        makeDirectory(path.substr(0, separator));
+    }
+    makeDirectory(path);
+}
+
+int processId()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<int>(getpid());
+#elif _WIN32
+    return _getpid();
+#endif
+}
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+bool readU32(std::istream& in, uint32_t& value)
+{
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), 4))
+    {
+        return false;
+    }
+    value = uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    return true;
+}
+
+// 64 bit FNV-1a, like FontSource::contentHash
+uint64_t keyHash(const std::string& key)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : key)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+TileMemory::TileMemory(size_t _capacityBytes)
+: capacityBytes(_capacityBytes)
+{
+}
+
+bool TileMemory::load(const std::string& key, Image& tile)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = index.find(key);
+    if (it == index.end() || it->second->width != tile.getWidth() || it->second->height != tile.getHeight())
+    {
+        return false;
+    }
+    tiles.splice(tiles.begin(), tiles, it->second);
+
+    const uint16_t* pixel = it->second->pixels.data();
+    for (size_t y = 0; y < tile.getHeight(); ++y)
+    {
+        for (size_t x = 0; x < tile.getWidth(); ++x)
+        {
+            tile.setPixel<uint16_t>({x, y}, *pixel++);
+        }
+    }
+    return true;
+}
+
+void TileMemory::store(const std::string& key, const Image& tile)
+{
+    Tile stored{key, tile.getWidth(), tile.getHeight(), {}};
+    stored.pixels.reserve(stored.width * stored.height);
+    for (size_t y = 0; y < stored.height; ++y)
+    {
+        for (size_t x = 0; x < stored.width; ++x)
+        {
+            stored.pixels.push_back(tile.getPixel<uint16_t>({x, y}));
+        }
+    }
+    const size_t bytes = stored.pixels.size() * sizeof(uint16_t);
+    if (bytes > capacityBytes)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        usedBytes -= it->second->pixels.size() * sizeof(uint16_t);
+        tiles.erase(it->second);
+        index.erase(it);
+    }
+    tiles.push_front(std::move(stored));
+    index[key] = tiles.begin();
+    usedBytes += bytes;
+    evict();
+}
+
+size_t TileMemory::sizeBytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return usedBytes;
+}
+
+void TileMemory::evict()
+{
+    while (usedBytes > capacityBytes)
+    {
+        usedBytes -= tiles.back().pixels.size() * sizeof(uint16_t);
+        index.erase(tiles.back().key);
+        tiles.pop_back();
+    }
+}
+
+
+TileCache::TileCache(const std::string& _directory, const AtlasSettings& _settings, TileMemory* _memory)
+: directory(_directory)
+, settings(_settings)
+, memory(_memory)
+{
+    if (!directory.empty())
+    {
+        makeDirectories(directory);
+    }
+}
+
+bool TileCache::load(uint32_t glyphIndex, Image& tile) const
+{
+    const std::string tileKey = key(glyphIndex);
+    if (memory && memory->load(tileKey, tile))
+    {
+        return true;
+    }
+    if (directory.empty() || !loadFile(tileKey, tile))
+    {
+        return false;
+    }
+    if (memory)
+    {
+        memory->store(tileKey, tile);
+    }
+    return true;
+}
+
+void TileCache::store(uint32_t glyphIndex, const Image& tile) const
+{
+    const std::string tileKey = key(glyphIndex);
+    if (memory)
+    {
+        memory->store(tileKey, tile);
+    }
+    if (!directory.empty())
+    {
+        storeFile(tileKey, tile);
+    }
+}
+
+bool TileCache::loadFile(const std::string& tileKey, Image& tile) const
+{
+    std::ifstream file(path(tileKey), std::ios::binary);
+    char magic[4];
+    if (!file.read(magic, 4) || !std::equal(magic, magic + 4, tileMagic))
+    {
+        return false;
+    }
+
+    // the whole key is stored, so that hash collisions are never mistaken for hits
+    uint32_t version, keyLength, width, height, compressedSize;
+    if (!readU32(file, version) || version != tileVersion || !readU32(file, keyLength) || keyLength != tileKey.size())
+    {
+        return false;
+    }
+    std::string storedKey(keyLength, '\0');
+    if (!file.read(&storedKey[0], keyLength) || storedKey != tileKey || !readU32(file, width) ||
+        !readU32(file, height) || width != tile.getWidth() || height != tile.getHeight() ||
+        !readU32(file, compressedSize))
+    {
+        return false;
+    }
+
+    // a corrupt size must not allocate more than the tile or the file can hold
+    const size_t pixelBytes = size_t(width) * height * 2;
+    const std::streamoff sizeOffset = file.tellg();
+    if (!file.seekg(0, std::ios::end))
+    {
+        return false;
+    }
+    const std::streamoff remaining = file.tellg() - sizeOffset;
+    if (compressedSize > compressBound(static_cast<uLong>(pixelBytes)) || std::streamoff(compressedSize) > remaining ||
+        !file.seekg(sizeOffset))
+    {
+        return false;
+    }
+
+    std::vector<Bytef> compressed(compressedSize);
+    if (!file.read(reinterpret_cast<char*>(compressed.data()), compressedSize))
+    {
+        return false;
+    }
+    std::vector<Bytef> pixels(pixelBytes);
+    uLongf uncompressedBytes = static_cast<uLongf>(pixels.size());
+    if (uncompress(pixels.data(), &uncompressedBytes, compressed.data(), compressedSize) != Z_OK ||
+        uncompressedBytes != pixels.size())
+    {
+        return false;
+    }
+
+    const Bytef* pixel = pixels.data();
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x, pixel += 2)
+        {
+            tile.setPixel<uint16_t>({x, y}, static_cast<uint16_t>(pixel[0] | pixel[1] << 8));
+        }
+    }
+    return true;
+}
+
+void TileCache::storeFile(const std::string& tileKey, const Image& tile) const
+{
+    std::vector<Bytef> pixels;
+    pixels.reserve(tile.getWidth() * tile.getHeight() * 2);
+    for (size_t y = 0; y < tile.getHeight(); ++y)
+    {
+        for (size_t x = 0; x < tile.getWidth(); ++x)
+        {
+            const uint16_t value = tile.getPixel<uint16_t>({x, y});
+            pixels.push_back(static_cast<Bytef>(value & 0xff));
+            pixels.push_back(static_cast<Bytef>(value >> 8));
+        }
+    }
+
+    std::vector<Bytef> compressed(compressBound(static_cast<uLong>(pixels.size())));
+    uLongf compressedSize = static_cast<uLongf>(compressed.size());
+    if (compress2(compressed.data(), &compressedSize, pixels.data(), static_cast<uLong>(pixels.size()),
+                  Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+        return;
+    }
+
+    std::string data(tileMagic, 4);
+    putU32(data, tileVersion);
+    putU32(data, static_cast<uint32_t>(tileKey.size()));
+    data += tileKey;
+    putU32(data, static_cast<uint32_t>(tile.getWidth()));
+    putU32(data, static_cast<uint32_t>(tile.getHeight()));
+    putU32(data, static_cast<uint32_t>(compressedSize));
+    data.append(reinterpret_cast<const char*>(compressed.data()), compressedSize);
+
+    // Renaming is atomic, concurrent readers either see no tile or a complete one. If another
+    // process stored the same tile first, the rename may fail on some platforms, which is fine.
+    const std::string finalPath = path(tileKey);
+    const std::string tempPath =
+        finalPath + "." + std::to_string(processId()) + "." + std::to_string(tempCounter++) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.write(data.data(), static_cast<std::streamsize>(data.size())))
+        {
+            file.close();
+            std::remove(tempPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(tempPath.c_str(), finalPath.c_str()) != 0)
+    {
+        std::remove(tempPath.c_str());
+    }
+}
+
+std::string TileCache::tilePath(uint32_t glyphIndex) const
+{
+    return path(key(glyphIndex));
+}
+
+std::string TileCache::key(uint32_t glyphIndex) const
+{
+    std::ostringstream key;
+    key << std::hex << settings.fontHash << std::dec << ' ' << settings.fontSize << ' ' << settings.padding << ' '
+        << settings.downsampling << ' ' << settings.downsamplingAlgorithm << ' ' << settings.distanceTransform << ' '
+        << settings.dynamicRangeMin << ' ' << settings.dynamicRangeMax << ' ' << glyphIndex;
+    return key.str();
+}
+
+std::string TileCache::path(const std::string& key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof name, "%016llx", static_cast<unsigned long long>(keyHash(key)));
+    return directory + "/" + name + ".tile";
+}
+
+
+} // namespace llassetgen
@@ -0,0 +1,146 @@
+#include <llassetgen/packing/SizeSearch.h>
+
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <llassetgen/Profiler.h>
+#include <llassetgen/packing/internal/Common.h>
+
+
+using llassetgen::PackingSizeType;
+
+
+namespace
+{
+
+
+PackingSizeType alignUp(PackingSizeType length, PackingSizeType alignment)
+{
+    return (length + alignment - 1) / alignment * alignment;
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+
+
+Packing packSmallestAtlas(const std::vector<Vec2<PackingSizeType>>& rectSizes, FixedSizePackingAlgorithm algorithm,
+                          bool allowRotations, PackingSizeType alignment, unsigned int threadCount)
+{
+    ProfileScope scope{"smallest atlas search"};
+    scope.setCount("rects", rectSizes.size());
+    alignment = std::max<PackingSizeType>(alignment, 1);
+    auto pack = [&](const Vec2<PackingSizeType>& atlasSize) {
+        return algorithm(rectSizes.cbegin(), rectSizes.cend(), atlasSize, allowRotations);
+    };
+    auto fits = [&](const Packing& packing) { return packing.rects.size() == rectSizes.size(); };
+
+    // No side can be shorter than a rect
+    Vec2<PackingSizeType> minSize{alignment, alignment};
+    PackingSizeType area = 0;
+    for (const auto& size : rectSizes)
+    {
+        const PackingSizeType shortSide = std::min(size.x, size.y);
+        minSize.x = std::max(minSize.x, alignUp(allowRotations ? shortSide : size.x, alignment));
+        minSize.y = std::max(minSize.y, alignUp(allowRotations ? shortSide : size.y, alignment));
+        area += size.x * size.y;
+    }
+
+    // The power of two size the flexible size algorithms would grow to
+    Vec2<PackingSizeType> powerOfTwo = internal::predictAtlasSize(internal::initPacking(rectSizes.begin(),
+                                                                                       rectSizes.end()));
+    powerOfTwo = {alignUp(powerOfTwo.x, alignment), alignUp(powerOfTwo.y, alignment)};
+    Packing powerOfTwoPacking = pack(powerOfTwo);
+    while (!fits(powerOfTwoPacking))
+    {
+        if (powerOfTwo.x > powerOfTwo.y)
+        {
+            powerOfTwo.y *= 2;
+        }
+        else
+        {
+            powerOfTwo.x *= 2;
+        }
+        powerOfTwoPacking = pack(powerOfTwo);
+    }
+    const PackingSizeType maxArea = powerOfTwo.x * powerOfTwo.y;
+
+    // Widths from half to twice the side of a square holding the rect area, about 12 percent apart
+    const auto squareSide = static_cast<PackingSizeType>(std::ceil(std::sqrt(static_cast<double>(area))));
+    const PackingSizeType firstWidth = std::max(minSize.x, alignUp(squareSide / 2, alignment));
+    const PackingSizeType lastWidth = std::max(firstWidth, alignUp(squareSide * 2, alignment));
+    std::vector<PackingSizeType> widths;
+    for (PackingSizeType width = firstWidth; width <= lastWidth;
+         width = std::max(width + alignment, alignUp(width + width / 8, alignment)))
+    {
+        widths.push_back(width);
+    }
+
+    // For each width, double the height until the rects fit, then binary search the smallest height that
+    // fits. This assumes that packings that fit keep fitting into higher atlases, which is not guaranteed
+    // for every algorithm, but close enough.
+    std::vector<Packing> results(widths.size());
+    internal::parallelFor(widths.size(), threadCount, [&](size_t i) {
+        const PackingSizeType width = widths[i];
+        const PackingSizeType maxHeight = maxArea / width / alignment * alignment;
+        PackingSizeType low = std::max(minSize.y, alignUp((area + width - 1) / width, alignment));
+        PackingSizeType high = low;
+        if (high > maxHeight)
+        {
+            return;
+        }
+
+        for (;;)
+        {
+            Packing packing = pack({width, high});
+            if (fits(packing))
+            {
+                results[i] = std::move(packing);
+                break;
+            }
+            if (high == maxHeight)
+            {
+                return;
+            }
+            low = high + alignment;
+            high = std::min(alignUp(high * 2, alignment), maxHeight);
+        }
+
+        while (low < high)
+        {
+            const PackingSizeType middle = low + (high - low) / alignment / 2 * alignment;
+            Packing packing = pack({width, middle});
+            if (fits(packing))
+            {
+                high = middle;
+                results[i] = std::move(packing);
+            }
+            else
+            {
+                low = middle + alignment;
+            }
+        }
+    });
+
+    auto score = [](const Vec2<PackingSizeType>& size) {
+        const PackingSizeType difference = size.x > size.y ? size.x - size.y : size.y - size.x;
+        return std::make_tuple(size.x * size.y, difference, size.x);
+    };
+    Packing* best = &powerOfTwoPacking;
+    for (Packing& result : results)
+    {
+        if (result.atlasSize.x > 0 && score(result.atlasSize) < score(best->atlasSize))
+        {
+            best = &result;
+        }
+    }
+    return std::move(*best);
+}
+
+
+} // namespace llassetgen
@@ -0,0 +1,178 @@
+#include <llassetgen/packing/internal/BestPacking.h>
+
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include <llassetgen/Profiler.h>
+#include <llassetgen/packing/internal/Common.h>
+#include <llassetgen/packing/internal/MaxRectsPacker.h>
+#include <llassetgen/packing/internal/ShelfPacker.h>
+#include <llassetgen/packing/internal/SkylinePacker.h>
+
+
+using llassetgen::PackingSizeType;
+using llassetgen::Rect;
+using llassetgen::internal::MaxRectsHeuristic;
+
+
+namespace
+{
+
+
+using SortKey = uint64_t (*)(const llassetgen::Vec2<PackingSizeType>&);
+
+
+// Sort by area descending (DESCA)
+uint64_t areaKey(const llassetgen::Vec2<PackingSizeType>& size)
+{
+    using llassetgen::internal::compactCoordinate;
+    return static_cast<uint64_t>(compactCoordinate(size.x)) * compactCoordinate(size.y);
+}
+
+
+// Sort by perimeter descending (DESCPERIM)
+uint64_t perimeterKey(const llassetgen::Vec2<PackingSizeType>& size)
+{
+    using llassetgen::internal::compactCoordinate;
+    return static_cast<uint64_t>(compactCoordinate(size.x)) + compactCoordinate(size.y);
+}
+
+
+struct Combination
+{
+    MaxRectsHeuristic heuristic;
+    SortKey sortKey;
+};
+
+
+std::vector<Combination> combinations()
+{
+    // The order breaks ties, so the combination of maxRectsPackAtlas comes first
+    const MaxRectsHeuristic heuristics[] = {MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestLongSideFit,
+                                            MaxRectsHeuristic::BestAreaFit, MaxRectsHeuristic::BottomLeft,
+                                            MaxRectsHeuristic::ContactPoint};
+    const SortKey sortKeys[] = {llassetgen::internal::MaxRectsPacker::inputSortingKey,
+                                llassetgen::internal::ShelfPacker::inputSortingKey,
+                                llassetgen::internal::SkylinePacker::inputSortingKey, areaKey, perimeterKey};
+
+    std::vector<Combination> result;
+    for (const MaxRectsHeuristic heuristic : heuristics)
+    {
+        for (const SortKey sortKey : sortKeys)
+        {
+            result.push_back({heuristic, sortKey});
+        }
+    }
+    return result;
+}
+
+
+PackingSizeType boundingArea(const std::vector<Rect<PackingSizeType>>& rects)
+{
+    llassetgen::Vec2<PackingSizeType> max{0, 0};
+    for (const auto& rect : rects)
+    {
+        max.x = std::max(max.x, rect.position.x + rect.size.x);
+        max.y = std::max(max.y, rect.position.y + rect.size.y);
+    }
+    return max.x * max.y;
+}
+
+
+} // namespace
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+Packing packBest(const Packing& packing, bool allowRotations, bool allowGrowth, unsigned int threadCount)
+{
+    ProfileScope scope{"best packing"};
+    const std::vector<Combination> candidates = combinations();
+    std::vector<Packing> results(candidates.size(), packing);
+    parallelFor(candidates.size(), threadCount, [&](size_t i) {
+        MaxRectsPacker packer{packing.atlasSize, allowRotations, allowGrowth, candidates[i].heuristic};
+        if (packAll(results[i], packer, candidates[i].sortKey))
+        {
+            results[i].atlasSize = packer.atlasSize();
+        }
+        else
+        {
+            results[i].rects.clear();
+        }
+    });
+
+    const Packing* best = nullptr;
+    std::tuple<PackingSizeType, PackingSizeType> bestScore;
+    for (const Packing& result : results)
+    {
+        if (result.rects.size() != packing.rects.size())
+        {
+            continue;
+        }
+
+        const auto score = std::make_tuple(result.atlasSize.x * result.atlasSize.y, boundingArea(result.rects));
+        if (!best || score < bestScore)
+        {
+            best = &result;
+            bestScore = score;
+        }
+    }
+
+    if (!best)
+    {
+        Packing failed;
+        failed.atlasSize = packing.atlasSize;
+        return failed;
+    }
+    return *best;
+}
+
+
+PagedPacking packBestPages(const Packing& packing, bool allowRotations, const Vec2<PackingSizeType>& pageSize,
+                           unsigned int threadCount)
+{
+    ProfileScope scope{"best packing"};
+    const std::vector<Combination> candidates = combinations();
+    std::vector<PagedPacking> results(candidates.size());
+    parallelFor(candidates.size(), threadCount, [&](size_t i) {
+        results[i] = packPages<MaxRectsPacker>(packing, allowRotations, pageSize, candidates[i].sortKey,
+                                               candidates[i].heuristic);
+    });
+
+    // A rect that does not fit on a page makes every combination fail
+    if (results.front().pageIndices.empty() && !packing.rects.empty())
+    {
+        return results.front();
+    }
+
+    const PagedPacking* best = nullptr;
+    std::tuple<size_t, PackingSizeType> bestScore;
+    std::vector<size_t> rectIndices;
+    for (const PagedPacking& result : results)
+    {
+        PackingSizeType area = 0;
+        for (size_t page = 0; page < result.pageCount; ++page)
+        {
+            area += boundingArea(result.page(page, rectIndices).rects);
+        }
+
+        const auto score = std::make_tuple(result.pageCount, area);
+        if (!best || score < bestScore)
+        {
+            best = &result;
+            bestScore = score;
+        }
+    }
+    return *best;
+}
+
+
+} // namespace internal
+} // namespace llassetgen
@@ -0,0 +1,139 @@
+#include <llassetgen/packing/internal/CompactRects.h>
+
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+CompactRects::Coordinate compactCoordinate(PackingSizeType value)
+{
+    if (value > std::numeric_limits<CompactRects::Coordinate>::max())
+    {
+        throw std::runtime_error("rect coordinate does not fit into 32 bits");
+    }
+    return static_cast<CompactRects::Coordinate>(value);
+}
+
+
+void CompactRects::set(size_t i, const Rect<PackingSizeType>& rect)
+{
+    x[i] = compactCoordinate(rect.position.x);
+    y[i] = compactCoordinate(rect.position.y);
+    width[i] = compactCoordinate(rect.size.x);
+    height[i] = compactCoordinate(rect.size.y);
+}
+
+
+void CompactRects::push_back(const Rect<PackingSizeType>& rect)
+{
+    resize(size() + 1);
+    set(size() - 1, rect);
+}
+
+
+void CompactRects::swap(size_t i1, size_t i2)
+{
+    std::swap(x[i1], x[i2]);
+    std::swap(y[i1], y[i2]);
+    std::swap(width[i1], width[i2]);
+    std::swap(height[i1], height[i2]);
+}
+
+
+void CompactRects::resize(size_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    width.resize(count);
+    height.resize(count);
+}
+
+
+void CompactRects::reserve(size_t count)
+{
+    x.reserve(count);
+    y.reserve(count);
+    width.reserve(count);
+    height.reserve(count);
+}
+
+
+void CompactRects::clear()
+{
+    resize(0);
+}
+
+
+std::vector<uint32_t> sortDescending(const std::vector<uint64_t>& keys)
+{
+    if (keys.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("too many rects to sort");
+    }
+
+    // Sorting the inverted keys ascending keeps equal keys in order
+    constexpr unsigned int digitBits = 8;
+    constexpr unsigned int passCount = 64 / digitBits;
+    constexpr size_t digitCount = size_t{1} << digitBits;
+    std::vector<std::array<uint32_t, digitCount>> counts(passCount);
+    for (auto& passCounts : counts)
+    {
+        passCounts.fill(0);
+    }
+    for (const uint64_t key : keys)
+    {
+        for (unsigned int pass = 0; pass < passCount; ++pass)
+        {
+            ++counts[pass][(~key >> (pass * digitBits)) & (digitCount - 1)];
+        }
+    }
+
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> sortedKeys(keys.size());
+    std::transform(keys.begin(), keys.end(), sortedKeys.begin(), [](uint64_t key) { return ~key; });
+
+    std::vector<uint32_t> nextOrder(keys.size());
+    std::vector<uint64_t> nextKeys(keys.size());
+    for (unsigned int pass = 0; pass < passCount; ++pass)
+    {
+        auto& passCounts = counts[pass];
+        const unsigned int shift = pass * digitBits;
+        if (keys.empty() || passCounts[(sortedKeys.front() >> shift) & (digitCount - 1)] == keys.size())
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t& count : passCounts)
+        {
+            const uint32_t digitOffset = offset;
+            offset += count;
+            count = digitOffset;
+        }
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            const uint32_t target = passCounts[(sortedKeys[i] >> shift) & (digitCount - 1)]++;
+            nextKeys[target] = sortedKeys[i];
+            nextOrder[target] = order[i];
+        }
+        sortedKeys.swap(nextKeys);
+        order.swap(nextOrder);
+    }
+
+    return order;
+}
+
+
+} // namespace internal
+} // namespace llassetgen
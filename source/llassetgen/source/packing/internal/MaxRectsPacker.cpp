@@ -4,6 +4,7 @@
 
 #include <iterator>
 #include <limits>
+#include <utility>
 
 
 using llassetgen::PackingSizeType;
@@ -23,38 +24,38 @@ bool isInRange(const T value, const T min, const T max)
 
 
 /**
- * Replace a rect in a vector by one or more replacements.
+ * Replace a rect in a list by one or more replacements.
  *
- * Reuses the replaced rect before pushing to the end of the vector.
+ * Reuses the position of the replaced rect before pushing to the end of the list.
  */
 class RectReplacer
 {
 private:
-    std::vector<Rect<PackingSizeType>>& vector;
-    Rect<PackingSizeType>& existing;
+    llassetgen::internal::CompactRects& list;
+    size_t existing;
     bool usedExisting = false;
 
 public:
-    RectReplacer(std::vector<Rect<PackingSizeType>>& _vector, Rect<PackingSizeType>& _existing)
-    : vector(_vector)
+    RectReplacer(llassetgen::internal::CompactRects& _list, size_t _existing)
+    : list(_list)
     , existing(_existing)
     {
     };
 
-    void addReplacement(Rect<PackingSizeType>&& element);
+    void addReplacement(const Rect<PackingSizeType>& element);
 };
 
 
-void RectReplacer::addReplacement(Rect<PackingSizeType>&& element)
+void RectReplacer::addReplacement(const Rect<PackingSizeType>& element)
 {
     if (!usedExisting)
     {
-        existing = std::move(element);
+        list.set(existing, element);
         usedExisting = true;
     }
     else
     {
-        vector.push_back(std::move(element));
+        list.push_back(element);
     }
 }
 
@@ -123,23 +124,6 @@ PackingSizeType bssfScore(const Rect<PackingSizeType>& free, const Rect<PackingS
 }
 
 
-class BssfComparator
-{
-public:
-    explicit BssfComparator(const Rect<PackingSizeType>& _toBePlaced) : toBePlaced(_toBePlaced)
-    {
-    }
-
-    bool operator()(const Rect<PackingSizeType>& free1, const Rect<PackingSizeType>& free2)
-    {
-        return bssfScore(free1, toBePlaced) < bssfScore(free2, toBePlaced);
-    }
-
-private:
-    const Rect<PackingSizeType>& toBePlaced;
-};
-
-
 } // namaespace
 
 
@@ -149,49 +133,167 @@ namespace internal
 {
 
 
-bool MaxRectsPacker::inputSortingComparator(const Rect<PackingSizeType>& rect1, const Rect<PackingSizeType>& rect2)
+MaxRectsPacker::MaxRectsPacker(const Vec2<PackingSizeType>& initialAtlasSize, bool _allowRotations,
+                               bool _allowGrowth, MaxRectsHeuristic _heuristic)
+: BasePacker{initialAtlasSize, _allowRotations, _allowGrowth}
+, heuristic{_heuristic}
+{
+    freeList.push_back({{0, 0}, initialAtlasSize});
+    rebuildIndex();
+    placedGrid.reset(initialAtlasSize);
+}
+
+
+uint64_t MaxRectsPacker::inputSortingKey(const Vec2<PackingSizeType>& size)
 {
     // Sort by shortest side fit descending (DESCSS)
-    return std::minmax(rect1.size.x, rect1.size.y) > std::minmax(rect2.size.x, rect2.size.y);
+    return sortKey(std::min(size.x, size.y), std::max(size.x, size.y));
 }
 
 
 bool MaxRectsPacker::pack(Rect<PackingSizeType>& rect)
 {
-    auto freeRectIter = findFreeRect(rect);
+    size_t freeRect = findFreeRect(rect);
     if (allowGrowth)
     {
-        while (freeRectIter == freeList.end() || !canContain(*freeRectIter, rect))
+        while (freeRect == freeList.size() || !canContain(freeList[freeRect], rect))
         {
             grow();
-            freeRectIter = findFreeRect(rect);
+            freeRect = findFreeRect(rect);
         }
     }
     else
     {
-        if (freeRectIter == freeList.end() || !canContain(*freeRectIter, rect))
+        if (freeRect == freeList.size() || !canContain(freeList[freeRect], rect))
         {
             return false;
         }
     }
 
-    rect.position = freeRectIter->position;
+    rect.position = freeList[freeRect].position;
     cropRects(rect);
     pruneFreeList();
+    addPlacedRect(rect);
 
     return true;
 }
 
 
+void MaxRectsPacker::occupy(const Rect<PackingSizeType>& rect)
+{
+    occupy(std::vector<Rect<PackingSizeType>>{rect});
+}
+
+
+void MaxRectsPacker::occupy(const std::vector<Rect<PackingSizeType>>& rects)
+{
+    // Like placing each rect with pack, only the free rects near it are cropped
+    // and reindexed. Free rects it covers completely are removed by cropRects.
+    // Going from the top left like pack does keeps the free list short, in any
+    // other order the free space below and right of the rects is split up.
+    std::vector<Rect<PackingSizeType>> sorted = rects;
+    std::sort(sorted.begin(), sorted.end(), [](const Rect<PackingSizeType>& a, const Rect<PackingSizeType>& b) {
+        return a.position.y < b.position.y || (a.position.y == b.position.y && a.position.x < b.position.x);
+    });
+    for (const auto& rect : sorted)
+    {
+        if (rect.size.x == 0 || rect.size.y == 0)
+        {
+            continue;
+        }
+        cropRects(rect);
+        pruneFreeList();
+        addPlacedRect(rect);
+    }
+}
+
+
+void MaxRectsPacker::release(const Rect<PackingSizeType>& rect)
+{
+    if (rect.size.x == 0 || rect.size.y == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> placedIds;
+    placedGrid.query(rect, placedIds);
+    for (const uint32_t id : placedIds)
+    {
+        if (placedRects[id] == rect)
+        {
+            placedGrid.erase(id, rect);
+            unusedPlacedIds.push_back(id);
+            break;
+        }
+    }
+
+    // No free rect overlaps the released one. Besides it, the span across it
+    // and each free rect it shares part of an edge with is free. Extending
+    // these up to the placed rects in both orders gives maximal free rects,
+    // which contain the free rects that could grow into the released space.
+    std::vector<Rect<PackingSizeType>> released{rect};
+    std::vector<uint32_t> neighbourIds;
+    grid.query(rect, neighbourIds);
+
+    const auto rectMax = rect.position + rect.size;
+    for (const uint32_t id : neighbourIds)
+    {
+        const auto& freeRect = freeList[freeListPositions[id]];
+        const auto freeMax = freeRect.position + freeRect.size;
+        const auto spanMin = Vec2<PackingSizeType>{std::min(rect.position.x, freeRect.position.x),
+                                                   std::min(rect.position.y, freeRect.position.y)};
+        const auto spanMax = Vec2<PackingSizeType>{std::max(rectMax.x, freeMax.x), std::max(rectMax.y, freeMax.y)};
+        const auto sharedMin = Vec2<PackingSizeType>{std::max(rect.position.x, freeRect.position.x),
+                                                     std::max(rect.position.y, freeRect.position.y)};
+        const auto sharedMax = Vec2<PackingSizeType>{std::min(rectMax.x, freeMax.x), std::min(rectMax.y, freeMax.y)};
+
+        if ((freeRect.position.x == rectMax.x || freeMax.x == rect.position.x) && sharedMin.y < sharedMax.y)
+        {
+            released.push_back({{spanMin.x, sharedMin.y}, {spanMax.x - spanMin.x, sharedMax.y - sharedMin.y}});
+        }
+        else if ((freeRect.position.y == rectMax.y || freeMax.y == rect.position.y) && sharedMin.x < sharedMax.x)
+        {
+            released.push_back({{sharedMin.x, spanMin.y}, {sharedMax.x - sharedMin.x, spanMax.y - spanMin.y}});
+        }
+    }
+
+    std::vector<Rect<PackingSizeType>> extended;
+    for (const auto& freeRect : released)
+    {
+        if (std::any_of(extended.begin(), extended.end(),
+                        [&freeRect](const Rect<PackingSizeType>& e) { return e.contains(freeRect); }))
+        {
+            continue;
+        }
+
+        for (const bool widthFirst : {true, false})
+        {
+            const auto extendedRect = extendFreeRect(freeRect, widthFirst);
+            if (std::find(extended.begin(), extended.end(), extendedRect) == extended.end())
+            {
+                extended.push_back(extendedRect);
+            }
+        }
+    }
+
+    for (const auto& freeRect : extended)
+    {
+        freeList.push_back(freeRect);
+        indexFreeRect(addId(freeList.size() - 1));
+    }
+    pruneFreeList();
+}
+
+
 void MaxRectsPacker::grow()
 {
     if (atlasSize_.x > atlasSize_.y)
     {
-        for (auto& freeRect : freeList)
+        for (size_t i = 0; i < freeList.size(); ++i)
         {
-            if (freeRect.position.y + freeRect.size.y == atlasSize_.y)
+            if (freeList.y[i] + freeList.height[i] == atlasSize_.y)
             {
-                freeRect.size.y += atlasSize_.y;
+                freeList.height[i] = compactCoordinate(freeList.height[i] + atlasSize_.y);
             }
         }
 
@@ -200,41 +302,196 @@ void MaxRectsPacker::grow()
     }
     else
     {
-        for (auto& freeRect : freeList)
+        for (size_t i = 0; i < freeList.size(); ++i)
         {
-            if (freeRect.position.x + freeRect.size.x == atlasSize_.x)
+            if (freeList.x[i] + freeList.width[i] == atlasSize_.x)
             {
-                freeRect.size.x += atlasSize_.x;
+                freeList.width[i] = compactCoordinate(freeList.width[i] + atlasSize_.x);
             }
         }
 
         freeList.push_back({{atlasSize_.x, 0}, atlasSize_});
         atlasSize_.x *= 2;
     }
+
+    rebuildIndex();
+    std::sort(unusedPlacedIds.begin(), unusedPlacedIds.end());
+    std::vector<Rect<PackingSizeType>> stillPlaced;
+    for (uint32_t id = 0; id < placedRects.size(); ++id)
+    {
+        if (!std::binary_search(unusedPlacedIds.begin(), unusedPlacedIds.end(), id))
+        {
+            stillPlaced.push_back(placedRects[id]);
+        }
+    }
+    placedRects.clear();
+    unusedPlacedIds.clear();
+    placedGrid.reset(atlasSize_);
+    for (const auto& rect : stillPlaced)
+    {
+        addPlacedRect(rect);
+    }
 }
 
 
-std::vector<Rect<PackingSizeType>>::const_iterator MaxRectsPacker::findFreeRect(
-    Rect<PackingSizeType>& rect) const
+size_t MaxRectsPacker::findFreeRect(Rect<PackingSizeType>& rect) const
 {
     if (freeList.empty())
     {
-        return freeList.end();
+        return freeList.size();
+    }
+
+    if (heuristic != MaxRectsHeuristic::BestShortSideFit)
+    {
+        return scanFreeRects(rect);
     }
 
-    auto freeRectIter = std::min_element(freeList.begin(), freeList.end(), BssfComparator{rect});
-    if (allowRotations)
+    const size_t freeRect = bestFreeRect(rect.size);
+    if (allowRotations && bssfScore(freeList[freeRect], rect) != 0)
     {
         Rect<PackingSizeType> rectRotated{rect.position, {rect.size.y, rect.size.x}};
-        auto freeRectRotatedIter =
-            std::min_element(freeList.begin(), freeList.end(), BssfComparator{rectRotated});
-        if (bssfScore(*freeRectRotatedIter, rectRotated) < bssfScore(*freeRectIter, rect)) {
+        const size_t freeRectRotated = bestFreeRect(rectRotated.size);
+        if (bssfScore(freeList[freeRectRotated], rectRotated) < bssfScore(freeList[freeRect], rect)) {
             rect.size = rectRotated.size;
-            return freeRectRotatedIter;
+            return freeRectRotated;
+        }
+    }
+
+    return freeRect;
+}
+
+
+size_t MaxRectsPacker::bestFreeRect(const Vec2<PackingSizeType>& size) const
+{
+    // The position of the first free rect with the lowest bssfScore. Free rects
+    // with a side of the same length score 0. For all others, the size
+    // difference wraps around, so the largest difference on either side has
+    // the lowest score.
+    const size_t exactFit = std::min(sizes.firstWithWidth(size.x, size.y), sizes.firstWithHeight(size.y, size.x));
+    if (exactFit != SizeIndex::npos)
+    {
+        return exactFit;
+    }
+
+    const PackingSizeType maxWidth = sizes.maxWidth(size.y);
+    if (maxWidth == 0 || maxWidth < size.x)
+    {
+        // Nothing fits, all rects have the same score
+        return 0;
+    }
+
+    const PackingSizeType maxDifference = std::max(maxWidth - size.x, sizes.maxHeight(size.x) - size.y);
+    if (maxDifference == 1)
+    {
+        // Scores as badly as the rects that do not fit
+        return 0;
+    }
+
+    return std::min(sizes.firstWithWidth(size.x + maxDifference, size.y),
+                    sizes.firstWithHeight(size.y + maxDifference, size.x));
+}
+
+
+size_t MaxRectsPacker::scanFreeRects(Rect<PackingSizeType>& rect) const
+{
+    // Ties are broken by the order of freeList, and in favour of not rotating
+    static constexpr PackingSizeType worst = std::numeric_limits<PackingSizeType>::max();
+    size_t best = freeList.size();
+    std::pair<PackingSizeType, PackingSizeType> bestScore{worst, worst};
+    bool bestRotated = false;
+
+    const Vec2<PackingSizeType> rotatedSize{rect.size.y, rect.size.x};
+    const bool tryRotated = allowRotations && rotatedSize != rect.size;
+    for (const bool rotated : {false, true})
+    {
+        if (rotated && !tryRotated)
+        {
+            break;
+        }
+
+        const Vec2<PackingSizeType>& size = rotated ? rotatedSize : rect.size;
+        for (size_t i = 0; i < freeList.size(); ++i)
+        {
+            // Only the sizes are read for free rects that are too small
+            if (freeList.width[i] < size.x || freeList.height[i] < size.y)
+            {
+                continue;
+            }
+
+            const auto freeRectScore = score(freeList[i], size);
+            if (freeRectScore < bestScore)
+            {
+                best = i;
+                bestScore = freeRectScore;
+                bestRotated = rotated;
+            }
+        }
+    }
+
+    if (bestRotated)
+    {
+        rect.size = rotatedSize;
+    }
+    return best;
+}
+
+
+std::pair<PackingSizeType, PackingSizeType> MaxRectsPacker::score(const Rect<PackingSizeType>& free,
+                                                                  const Vec2<PackingSizeType>& size) const
+{
+    // Lower is better, the second value breaks ties
+    const auto leftover = free.size - size;
+    const PackingSizeType shortSide = std::min(leftover.x, leftover.y);
+    const PackingSizeType longSide = std::max(leftover.x, leftover.y);
+    switch (heuristic)
+    {
+    case MaxRectsHeuristic::BestLongSideFit:
+        return {longSide, shortSide};
+    case MaxRectsHeuristic::BestAreaFit:
+        return {free.size.x * free.size.y - size.x * size.y, shortSide};
+    case MaxRectsHeuristic::BottomLeft:
+        return {free.position.y + size.y, free.position.x};
+    case MaxRectsHeuristic::ContactPoint:
+        return {std::numeric_limits<PackingSizeType>::max() - contactLength({free.position, size}), 0};
+    case MaxRectsHeuristic::BestShortSideFit:
+    default:
+        return {shortSide, longSide};
+    }
+}
+
+
+PackingSizeType MaxRectsPacker::contactLength(const Rect<PackingSizeType>& rect) const
+{
+    const auto rectMax = rect.position + rect.size;
+    PackingSizeType length = 0;
+    length += rect.position.x == 0 ? rect.size.y : 0;
+    length += rectMax.x == atlasSize_.x ? rect.size.y : 0;
+    length += rect.position.y == 0 ? rect.size.x : 0;
+    length += rectMax.y == atlasSize_.y ? rect.size.x : 0;
+
+    auto overlap = [](PackingSizeType min1, PackingSizeType max1, PackingSizeType min2, PackingSizeType max2) {
+        const PackingSizeType min = std::max(min1, min2);
+        const PackingSizeType max = std::min(max1, max2);
+        return max > min ? max - min : 0;
+    };
+
+    std::vector<uint32_t> placedIds;
+    placedGrid.query(rect, placedIds);
+    for (const uint32_t id : placedIds)
+    {
+        const auto& placed = placedRects[id];
+        const auto placedMax = placed.position + placed.size;
+        if (placedMax.x == rect.position.x || placed.position.x == rectMax.x)
+        {
+            length += overlap(placed.position.y, placedMax.y, rect.position.y, rectMax.y);
+        }
+        if (placedMax.y == rect.position.y || placed.position.y == rectMax.y)
+        {
+            length += overlap(placed.position.x, placedMax.x, rect.position.x, rectMax.x);
         }
     }
 
-    return freeRectIter;
+    return length;
 }
 
 
@@ -242,60 +499,417 @@ void MaxRectsPacker::pruneFreeList()
 {
     // Remove redundant rectangles by swapping them to the end of the vector
     // and resizing the vector when done.
+    //
+    // This gives the same result as comparing each rect (iter1) to all rects
+    // after it (iter2) and swapping when one contains the other. Only rects
+    // with containments have to be visited as iter1, and only their
+    // containments as iter2, all other comparisons would do nothing.
     if (freeList.empty())
     {
         return;
     }
 
-    auto endIter = std::prev(freeList.end());
-    for (auto iter1 = freeList.begin(); iter1 < endIter; ++iter1)
+    std::set<size_t> iter1Positions;
+    for (const uint32_t id : idsWithContainments)
     {
-        for (auto iter2 = std::next(iter1); iter2 <= endIter;)
+        iter1Positions.insert(freeListPositions[id]);
+    }
+
+    size_t endPosition = freeList.size() - 1;
+    auto swapToEnd = [&](size_t position) {
+        swapFreeRects(position, endPosition);
+        const bool positionPending = iter1Positions.erase(position) != 0;
+        if (iter1Positions.erase(endPosition) != 0)
         {
-            if (iter1->contains(*iter2))
+            iter1Positions.insert(position);
+        }
+        if (positionPending)
+        {
+            iter1Positions.insert(endPosition);
+        }
+        --endPosition;
+    };
+
+    std::vector<size_t> iter2Positions;
+    for (auto next = iter1Positions.begin(); next != iter1Positions.end() && *next < endPosition;)
+    {
+        const size_t iter1 = *next;
+        const Rect<PackingSizeType> rect1 = freeList[iter1];
+
+        iter2Positions.clear();
+        for (const uint32_t other : containments[freeListIds[iter1]])
+        {
+            const size_t position = freeListPositions[other];
+            if (position > iter1 && position <= endPosition)
             {
-                std::iter_swap(iter2, endIter--);
+                iter2Positions.push_back(position);
             }
-            else if (iter2->contains(*iter1))
+        }
+        std::sort(iter2Positions.begin(), iter2Positions.end());
+
+        for (size_t i = 0; i < iter2Positions.size() && iter2Positions[i] <= endPosition;)
+        {
+            const size_t iter2 = iter2Positions[i];
+            if (rect1.contains(freeList[iter2]))
+            {
+                // The rect swapped in from the end is compared next. If it is
+                // a containment, it is the last of iter2Positions.
+                const bool swappedInContainment = iter2Positions.back() == endPosition && iter2 != endPosition;
+                swapToEnd(iter2);
+                if (swappedInContainment)
+                {
+                    iter2Positions.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            else if (freeList[iter2].contains(rect1))
             {
-                std::iter_swap(iter1, endIter--);
+                // The rect swapped in from the end is skipped, like in a plain
+                // loop, where iter1 moves on to the next position.
+                swapToEnd(iter1);
                 break;
             }
             else
             {
-                ++iter2;
+                ++i;
+            }
+        }
+
+        next = iter1Positions.upper_bound(iter1);
+    }
+
+    for (size_t position = endPosition + 1; position < freeList.size(); ++position)
+    {
+        const uint32_t id = freeListIds[position];
+        unindexFreeRect(id, freeList[position]);
+        unusedIds.push_back(id);
+    }
+    freeList.resize(endPosition + 1);
+    freeListIds.resize(endPosition + 1);
+}
+
+
+void MaxRectsPacker::addPlacedRect(const Rect<PackingSizeType>& rect)
+{
+    uint32_t id;
+    if (unusedPlacedIds.empty())
+    {
+        id = static_cast<uint32_t>(placedRects.size());
+        placedRects.push_back(rect);
+    }
+    else
+    {
+        id = unusedPlacedIds.back();
+        unusedPlacedIds.pop_back();
+        placedRects[id] = rect;
+    }
+    placedGrid.insert(id, rect);
+}
+
+
+Rect<PackingSizeType> MaxRectsPacker::extendFreeRect(Rect<PackingSizeType> rect, bool widthFirst) const
+{
+    std::vector<uint32_t> placedIds;
+    for (const bool extendWidth : {widthFirst, !widthFirst})
+    {
+        // The closest placed rects in the rows (or columns) of the free rect
+        // limit it. They are searched for in a growing range, as they are
+        // usually close.
+        using Axis = PackingSizeType Vec2<PackingSizeType>::*;
+        const Axis axis = extendWidth ? &Vec2<PackingSizeType>::x : &Vec2<PackingSizeType>::y;
+        const Axis otherAxis = extendWidth ? &Vec2<PackingSizeType>::y : &Vec2<PackingSizeType>::x;
+        const auto rectMax = rect.position + rect.size;
+        PackingSizeType min = 0;
+        PackingSizeType max = atlasSize_.*axis;
+        for (PackingSizeType reach = 32;; reach *= 2)
+        {
+            const PackingSizeType searchMin = rect.position.*axis > reach ? rect.position.*axis - reach : 0;
+            const PackingSizeType searchMax = std::min(rectMax.*axis + reach, atlasSize_.*axis);
+            Rect<PackingSizeType> searched = rect;
+            searched.position.*axis = searchMin;
+            searched.size.*axis = searchMax - searchMin;
+
+            placedIds.clear();
+            placedGrid.query(searched, placedIds);
+            bool minFound = searchMin == 0;
+            bool maxFound = searchMax == atlasSize_.*axis;
+            for (const uint32_t id : placedIds)
+            {
+                const auto& placed = placedRects[id];
+                const auto placedMax = placed.position + placed.size;
+                if (placed.position.*otherAxis >= rectMax.*otherAxis || placedMax.*otherAxis <= rect.position.*otherAxis)
+                {
+                    continue;
+                }
+
+                if (placedMax.*axis <= rect.position.*axis)
+                {
+                    min = std::max(min, placedMax.*axis);
+                    minFound = true;
+                }
+                else if (placed.position.*axis >= rectMax.*axis)
+                {
+                    max = std::min(max, placed.position.*axis);
+                    maxFound = true;
+                }
+            }
+
+            if (minFound && maxFound)
+            {
+                break;
             }
         }
+
+        rect.position.*axis = min;
+        rect.size.*axis = max - min;
     }
 
-    freeList.resize(endIter - freeList.begin() + 1);
+    return rect;
 }
 
 
 void MaxRectsPacker::cropRects(const Rect<PackingSizeType>& placedRect)
 {
+    // Only free rects that share some area with the placed rect can change. They
+    // are visited in the order of freeList, as if looping over all rects.
+    std::vector<uint32_t> candidates;
+    grid.query(placedRect, candidates);
+    std::sort(candidates.begin(), candidates.end(),
+              [this](uint32_t id1, uint32_t id2) { return freeListPositions[id1] < freeListPositions[id2]; });
+
+    // New rects are indexed once all crops are done. For each cropped rect, the
+    // rects it contained are kept, as they are the only old rects that can be
+    // contained in the new ones. Ids of removed rects are not reused before.
+    std::vector<std::pair<uint32_t, size_t>> newIds;
+    std::vector<std::vector<uint32_t>> containedInCropped;
+    std::vector<uint32_t> removedIds;
     size_t rectsToCrop = freeList.size();
 
-    for (size_t i = 0; i < rectsToCrop;)
+    for (size_t c = 0; c < candidates.size();)
     {
-        if (placedRect == freeList[i])
+        const uint32_t id = candidates[c];
+        const size_t i = freeListPositions[id];
+        if (i >= rectsToCrop)
+        {
+            break;
+        }
+
+        if (placedRect.contains(freeList[i]))
         {
-            std::swap(freeList[i], freeList[freeList.size() - 1]);
+            // Covered rects are removed. The last rect that still has to be cropped
+            // takes its place and is cropped next, the last rect takes the place
+            // of that one.
+            const uint32_t lastToCropId = freeListIds[rectsToCrop - 1];
+            swapFreeRects(i, rectsToCrop - 1);
+            swapFreeRects(rectsToCrop - 1, freeList.size() - 1);
+            unindexFreeRect(id, freeList.back());
+            removedIds.push_back(id);
             freeList.resize(freeList.size() - 1);
+            freeListIds.resize(freeListIds.size() - 1);
             --rectsToCrop;
-            // Is the swapped rectangle already created due to a crop?
-            if (freeList.size() != rectsToCrop)
+
+            // Rects that do not overlap the placed rect are not affected by cropping
+            auto lastToCrop = std::find(candidates.begin() + c + 1, candidates.end(), lastToCropId);
+            if (lastToCrop != candidates.end())
             {
-                ++i;
+                candidates[c] = lastToCropId;
+                candidates.erase(lastToCrop);
+            }
+            else
+            {
+                ++c;
             }
 
             continue;
         }
 
         const auto freeRectCopy = freeList[i];
-        RectReplacer replacer{freeList, freeList[i]};
+        const size_t oldSize = freeList.size();
+        RectReplacer replacer{freeList, i};
         cropRect(freeRectCopy, placedRect, replacer);
-        ++i;
+        if (freeList[i] != freeRectCopy)
+        {
+            std::vector<uint32_t> contained;
+            for (const uint32_t other : containments[id])
+            {
+                if (freeRectCopy.contains(freeList[freeListPositions[other]]))
+                {
+                    contained.push_back(other);
+                }
+            }
+            containedInCropped.push_back(std::move(contained));
+
+            unindexFreeRect(id, freeRectCopy);
+            newIds.emplace_back(id, containedInCropped.size() - 1);
+            for (size_t position = oldSize; position < freeList.size(); ++position)
+            {
+                newIds.emplace_back(addId(position), containedInCropped.size() - 1);
+            }
+        }
+        ++c;
+    }
+
+    // Containments between new and old rects. Old rects that contain a new one
+    // cover its top left corner.
+    std::vector<uint32_t> relatedIds;
+    for (const auto& newId : newIds)
+    {
+        const auto& rect = freeList[freeListPositions[newId.first]];
+        relatedIds.clear();
+        grid.query({rect.position, {0, 0}}, relatedIds);
+        for (const uint32_t other : containedInCropped[newId.second])
+        {
+            if (indexedIds[other])
+            {
+                relatedIds.push_back(other);
+            }
+        }
+        std::sort(relatedIds.begin(), relatedIds.end());
+        relatedIds.erase(std::unique(relatedIds.begin(), relatedIds.end()), relatedIds.end());
+
+        for (const uint32_t other : relatedIds)
+        {
+            const auto& otherRect = freeList[freeListPositions[other]];
+            if (rect.contains(otherRect) || otherRect.contains(rect))
+            {
+                addContainment(newId.first, other);
+            }
+        }
+    }
+
+    // Containments among the new rects
+    for (auto newId1 = newIds.begin(); newId1 != newIds.end(); ++newId1)
+    {
+        const auto& rect1 = freeList[freeListPositions[newId1->first]];
+        for (auto newId2 = std::next(newId1); newId2 != newIds.end(); ++newId2)
+        {
+            const auto& rect2 = freeList[freeListPositions[newId2->first]];
+            if (rect1.contains(rect2) || rect2.contains(rect1))
+            {
+                addContainment(newId1->first, newId2->first);
+            }
+        }
+    }
+
+    for (const auto& newId : newIds)
+    {
+        insertIntoIndex(newId.first);
+    }
+    unusedIds.insert(unusedIds.end(), removedIds.begin(), removedIds.end());
+}
+
+
+void MaxRectsPacker::rebuildIndex()
+{
+    grid.reset(atlasSize_);
+    sizes.reset(atlasSize_);
+    freeListIds.clear();
+    freeListPositions.clear();
+    containments.clear();
+    idsWithContainments.clear();
+    indexedIds.clear();
+    unusedIds.clear();
+
+    for (size_t position = 0; position < freeList.size(); ++position)
+    {
+        indexFreeRect(addId(position));
+    }
+}
+
+
+uint32_t MaxRectsPacker::addId(size_t position)
+{
+    uint32_t id;
+    if (unusedIds.empty())
+    {
+        id = static_cast<uint32_t>(freeListPositions.size());
+        freeListPositions.push_back(position);
+        containments.emplace_back();
+        indexedIds.push_back(false);
+    }
+    else
+    {
+        id = unusedIds.back();
+        unusedIds.pop_back();
+        freeListPositions[id] = position;
+    }
+
+    freeListIds.resize(std::max(freeListIds.size(), position + 1));
+    freeListIds[position] = id;
+    return id;
+}
+
+
+void MaxRectsPacker::swapFreeRects(size_t position1, size_t position2)
+{
+    sizes.swap(position1, freeList[position1].size, position2, freeList[position2].size);
+    freeList.swap(position1, position2);
+    std::swap(freeListIds[position1], freeListIds[position2]);
+    freeListPositions[freeListIds[position1]] = position1;
+    freeListPositions[freeListIds[position2]] = position2;
+}
+
+
+void MaxRectsPacker::indexFreeRect(uint32_t id)
+{
+    const auto& rect = freeList[freeListPositions[id]];
+    std::vector<uint32_t> nearbyIds;
+    grid.query(rect, nearbyIds);
+    for (const uint32_t other : nearbyIds)
+    {
+        const auto& otherRect = freeList[freeListPositions[other]];
+        if (rect.contains(otherRect) || otherRect.contains(rect))
+        {
+            addContainment(id, other);
+        }
+    }
+
+    insertIntoIndex(id);
+}
+
+
+void MaxRectsPacker::insertIntoIndex(uint32_t id)
+{
+    const size_t position = freeListPositions[id];
+    grid.insert(id, freeList[position]);
+    sizes.insert(position, freeList[position].size);
+    indexedIds[id] = true;
+}
+
+
+void MaxRectsPacker::unindexFreeRect(uint32_t id, const Rect<PackingSizeType>& rect)
+{
+    grid.erase(id, rect);
+    sizes.erase(freeListPositions[id], rect.size);
+    for (const uint32_t other : containments[id])
+    {
+        removeContainment(other, id);
+    }
+    containments[id].clear();
+    idsWithContainments.erase(id);
+    indexedIds[id] = false;
+}
+
+
+void MaxRectsPacker::addContainment(uint32_t id1, uint32_t id2)
+{
+    containments[id1].push_back(id2);
+    containments[id2].push_back(id1);
+    idsWithContainments.insert(id1);
+    idsWithContainments.insert(id2);
+}
+
+
+void MaxRectsPacker::removeContainment(uint32_t id, uint32_t other)
+{
+    auto& ids = containments[id];
+    ids.erase(std::find(ids.begin(), ids.end(), other));
+    if (ids.empty())
+    {
+        idsWithContainments.erase(id);
     }
 }
 
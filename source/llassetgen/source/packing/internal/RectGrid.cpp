@@ -0,0 +1,118 @@
+#include <llassetgen/packing/internal/RectGrid.h>
+
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+void RectGrid::reset(const Vec2<PackingSizeType>& areaSize)
+{
+    // Smaller cells mostly stay empty and only make queries slower
+    static constexpr unsigned int minCellShift = 5;
+
+    const PackingSizeType longestSide = std::max(areaSize.x, areaSize.y);
+    levels.clear();
+    for (unsigned int cellShift = minCellShift;; ++cellShift)
+    {
+        const PackingSizeType cellSize = PackingSizeType{1} << cellShift;
+        Level level;
+        level.cellShift = cellShift;
+        level.cellCount = {std::max<PackingSizeType>(1, (areaSize.x + cellSize - 1) >> cellShift),
+                           std::max<PackingSizeType>(1, (areaSize.y + cellSize - 1) >> cellShift)};
+        level.cells.resize(level.cellCount.x * level.cellCount.y);
+        level.entryCount = 0;
+        levels.push_back(std::move(level));
+
+        if (cellSize >= longestSide)
+        {
+            break;
+        }
+    }
+}
+
+
+void RectGrid::insert(uint32_t id, const Rect<PackingSizeType>& rect)
+{
+    Level* level;
+    cell(rect, level).push_back({id, rect});
+    ++level->entryCount;
+}
+
+
+void RectGrid::erase(uint32_t id, const Rect<PackingSizeType>& rect)
+{
+    Level* level;
+    auto& entries = cell(rect, level);
+    auto entry = std::find_if(entries.begin(), entries.end(), [id](const Entry& e) { return e.id == id; });
+    if (entry != entries.end())
+    {
+        *entry = entries.back();
+        entries.pop_back();
+        --level->entryCount;
+    }
+}
+
+
+void RectGrid::query(const Rect<PackingSizeType>& rect, std::vector<uint32_t>& ids) const
+{
+    const auto rectMax = rect.position + rect.size;
+    for (const Level& level : levels)
+    {
+        if (level.entryCount == 0)
+        {
+            continue;
+        }
+
+        // Rects are at most one cell large, so they can also reach into the
+        // query from the cells to the left of and above it.
+        auto firstCell = [&level](PackingSizeType position, PackingSizeType cellCount) {
+            const PackingSizeType cell = std::min(position >> level.cellShift, cellCount - 1);
+            return cell > 0 ? cell - 1 : cell;
+        };
+        const Vec2<PackingSizeType> minCell{firstCell(rect.position.x, level.cellCount.x),
+                                            firstCell(rect.position.y, level.cellCount.y)};
+        const Vec2<PackingSizeType> maxCell{std::min(rectMax.x >> level.cellShift, level.cellCount.x - 1),
+                                            std::min(rectMax.y >> level.cellShift, level.cellCount.y - 1)};
+
+        for (PackingSizeType y = minCell.y; y <= maxCell.y; ++y)
+        {
+            for (PackingSizeType x = minCell.x; x <= maxCell.x; ++x)
+            {
+                for (const Entry& entry : level.cells[y * level.cellCount.x + x])
+                {
+                    const auto entryMax = entry.rect.position + entry.rect.size;
+                    if (entry.rect.position.x <= rectMax.x && entryMax.x >= rect.position.x &&
+                        entry.rect.position.y <= rectMax.y && entryMax.y >= rect.position.y)
+                    {
+                        ids.push_back(entry.id);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+std::vector<RectGrid::Entry>& RectGrid::cell(const Rect<PackingSizeType>& rect, Level*& level)
+{
+    // The lowest level with large enough cells, or the highest one, which has a
+    // single cell covering the whole area.
+    const PackingSizeType longestSide = std::max(rect.size.x, rect.size.y);
+    level = &*std::find_if(levels.begin(), std::prev(levels.end()), [longestSide](const Level& l) {
+        return (PackingSizeType{1} << l.cellShift) >= longestSide;
+    });
+
+    const PackingSizeType x = std::min(rect.position.x >> level->cellShift, level->cellCount.x - 1);
+    const PackingSizeType y = std::min(rect.position.y >> level->cellShift, level->cellCount.y - 1);
+    return level->cells[y * level->cellCount.x + x];
+}
+
+
+} // namespace internal
+} // namespace llassetgen
@@ -1,5 +1,6 @@
 #include <llassetgen/packing/internal/ShelfPacker.h>
 
+#include <iterator>
 #include <tuple>
 #include <utility>
 
@@ -17,12 +18,6 @@ PackingSizeType ceilDiv(const PackingSizeType dividend, const PackingSizeType di
     return (dividend + divisor - PackingSizeType(1)) / divisor;
 }
 
-template <class T>
-std::pair<T, T> flip(const std::pair<T, T> & pair)
-{
-    return {pair.second, pair.first};
-}
-
 
 } // namespace
 
@@ -33,11 +28,10 @@ namespace internal
 {
 
 
-bool ShelfPacker::inputSortingComparator(const Rect<PackingSizeType>& rect1,
-                                         const Rect<PackingSizeType>& rect2)
+uint64_t ShelfPacker::inputSortingKey(const Vec2<PackingSizeType>& size)
 {
     // Sort by longest side descending (DESCLS)
-    return flip(std::minmax(rect1.size.x, rect1.size.y)) > flip(std::minmax(rect2.size.x, rect2.size.y));
+    return sortKey(std::max(size.x, size.y), std::min(size.x, size.y));
 }
 
 bool ShelfPacker::pack(Rect<PackingSizeType>& rect)
@@ -45,6 +39,32 @@ bool ShelfPacker::pack(Rect<PackingSizeType>& rect)
     return allowRotations ? packWithRotations(rect) : packNoRotations(rect);
 }
 
+void ShelfPacker::release(const Rect<PackingSizeType>& rect)
+{
+    if (rect.size.x == 0 || rect.size.y == 0 || rect.position.y != usedHeight)
+    {
+        return;
+    }
+
+    releasedWidths[rect.position.x] = rect.size.x;
+    while (!releasedWidths.empty())
+    {
+        const auto last = std::prev(releasedWidths.end());
+        if (last->first + last->second != currentShelfSize.x)
+        {
+            break;
+        }
+        currentShelfSize.x = last->first;
+        releasedWidths.erase(last);
+    }
+
+    // An empty shelf can take rects of any height again
+    if (currentShelfSize.x == 0)
+    {
+        currentShelfSize.y = 0;
+    }
+}
+
 bool ShelfPacker::packNoRotations(Rect<PackingSizeType>& rect)
 {
     if (currentShelfSize.x + rect.size.x > atlasSize_.x)
@@ -91,6 +111,7 @@ void ShelfPacker::openNewShelf()
 {
     usedHeight += currentShelfSize.y;
     currentShelfSize = {0, 0};
+    releasedWidths.clear();
 }
 
 bool ShelfPacker::placeMaybeGrow(Rect<PackingSizeType>& rect)
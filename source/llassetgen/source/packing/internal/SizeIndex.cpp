@@ -0,0 +1,183 @@
+#include <llassetgen/packing/internal/SizeIndex.h>
+
+
+#include <algorithm>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+constexpr size_t SizeIndex::npos;
+
+
+void SizeIndex::reset(const Vec2<PackingSizeType>& maxSize)
+{
+    widths.reset(maxSize.x);
+    heights.reset(maxSize.y);
+}
+
+
+void SizeIndex::insert(size_t position, const Vec2<PackingSizeType>& size)
+{
+    widths.insert(position, size.x, size.y);
+    heights.insert(position, size.y, size.x);
+}
+
+
+void SizeIndex::erase(size_t position, const Vec2<PackingSizeType>& size)
+{
+    widths.erase(position, size.x, size.y);
+    heights.erase(position, size.y, size.x);
+}
+
+
+void SizeIndex::swap(size_t position1, const Vec2<PackingSizeType>& size1, size_t position2,
+                     const Vec2<PackingSizeType>& size2)
+{
+    widths.swap(position1, size1.x, size1.y, position2, size2.x, size2.y);
+    heights.swap(position1, size1.y, size1.x, position2, size2.y, size2.x);
+}
+
+
+PackingSizeType SizeIndex::maxWidth(PackingSizeType minHeight) const
+{
+    return heights.maxOtherLength(minHeight);
+}
+
+
+PackingSizeType SizeIndex::maxHeight(PackingSizeType minWidth) const
+{
+    return widths.maxOtherLength(minWidth);
+}
+
+
+size_t SizeIndex::firstWithWidth(PackingSizeType width, PackingSizeType minHeight) const
+{
+    return widths.first(width, minHeight);
+}
+
+
+size_t SizeIndex::firstWithHeight(PackingSizeType height, PackingSizeType minWidth) const
+{
+    return heights.first(height, minWidth);
+}
+
+
+void SizeIndex::Axis::reset(PackingSizeType maxLength)
+{
+    rects.clear();
+    leafCount = 1;
+    while (leafCount <= maxLength)
+    {
+        leafCount *= 2;
+    }
+    maxTree.assign(2 * leafCount, 0);
+}
+
+
+void SizeIndex::Axis::insert(size_t position, PackingSizeType length, PackingSizeType otherLength)
+{
+    rects[length].emplace(position, otherLength);
+    if (otherLength > maxTree[length + leafCount])
+    {
+        setMax(length, otherLength);
+    }
+}
+
+
+bool SizeIndex::Axis::erase(size_t position, PackingSizeType length, PackingSizeType otherLength)
+{
+    auto sameLength = rects.find(length);
+    if (sameLength == rects.end() || sameLength->second.erase({position, otherLength}) == 0)
+    {
+        return false;
+    }
+
+    if (otherLength == maxTree[length + leafCount])
+    {
+        PackingSizeType newMax = 0;
+        for (const auto& rect : sameLength->second)
+        {
+            newMax = std::max(newMax, rect.second);
+        }
+        setMax(length, newMax);
+    }
+    if (sameLength->second.empty())
+    {
+        rects.erase(sameLength);
+    }
+    return true;
+}
+
+
+void SizeIndex::Axis::swap(size_t position1, PackingSizeType length1, PackingSizeType otherLength1, size_t position2,
+                           PackingSizeType length2, PackingSizeType otherLength2)
+{
+    // The sizes stay the same, so only the positions have to be updated
+    auto sameLength1 = rects.find(length1);
+    auto sameLength2 = rects.find(length2);
+    const bool indexed1 = sameLength1 != rects.end() && sameLength1->second.erase({position1, otherLength1}) != 0;
+    const bool indexed2 = sameLength2 != rects.end() && sameLength2->second.erase({position2, otherLength2}) != 0;
+    if (indexed1)
+    {
+        sameLength1->second.emplace(position2, otherLength1);
+    }
+    if (indexed2)
+    {
+        sameLength2->second.emplace(position1, otherLength2);
+    }
+}
+
+
+PackingSizeType SizeIndex::Axis::maxOtherLength(PackingSizeType minLength) const
+{
+    // Maximum over the leaves [minLength, leafCount)
+    PackingSizeType result = 0;
+    for (size_t lower = minLength + leafCount, upper = 2 * leafCount; lower < upper; lower /= 2, upper /= 2)
+    {
+        if (lower % 2 == 1)
+        {
+            result = std::max(result, maxTree[lower++]);
+        }
+        if (upper % 2 == 1)
+        {
+            result = std::max(result, maxTree[--upper]);
+        }
+    }
+    return result;
+}
+
+
+size_t SizeIndex::Axis::first(PackingSizeType length, PackingSizeType minOtherLength) const
+{
+    const auto sameLength = rects.find(length);
+    if (sameLength != rects.end())
+    {
+        for (const auto& rect : sameLength->second)
+        {
+            if (rect.second >= minOtherLength)
+            {
+                return rect.first;
+            }
+        }
+    }
+    return npos;
+}
+
+
+void SizeIndex::Axis::setMax(PackingSizeType length, PackingSizeType otherLength)
+{
+    size_t node = length + leafCount;
+    maxTree[node] = otherLength;
+    for (node /= 2; node > 0; node /= 2)
+    {
+        maxTree[node] = std::max(maxTree[2 * node], maxTree[2 * node + 1]);
+    }
+}
+
+
+} // namespace internal
+} // namespace llassetgen
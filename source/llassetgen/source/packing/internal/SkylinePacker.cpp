@@ -0,0 +1,164 @@
+#include <llassetgen/packing/internal/SkylinePacker.h>
+
+
+#include <algorithm>
+
+
+namespace llassetgen
+{
+namespace internal
+{
+
+
+uint64_t SkylinePacker::inputSortingKey(const Vec2<PackingSizeType>& size)
+{
+    // Sort by height descending (DESCH), then by width descending. Rects of similar
+    // height end up next to each other and leave an even skyline.
+    return sortKey(size.y, size.x);
+}
+
+
+bool SkylinePacker::pack(Rect<PackingSizeType>& rect)
+{
+    // Empty rects take no space and fit anywhere.
+    if (rect.size.x == 0 || rect.size.y == 0)
+    {
+        rect.position = {0, 0};
+        return true;
+    }
+
+    Fit best;
+    while (!findPosition(rect.size, best))
+    {
+        if (!allowGrowth)
+        {
+            return false;
+        }
+        grow();
+    }
+
+    rect.position = {skyline[best.segment].x, best.y};
+    rect.size = best.size;
+    place(best);
+    return true;
+}
+
+
+bool SkylinePacker::fit(size_t segment, const Vec2<PackingSizeType>& size, Fit& result) const
+{
+    const PackingSizeType x = skyline[segment].x;
+    if (x + size.x > atlasSize_.x)
+    {
+        return false;
+    }
+
+    // The rect rests on the highest segment below it. The area between the
+    // lower segments and the rect's bottom edge is wasted.
+    PackingSizeType y = 0;
+    PackingSizeType coveredArea = 0;
+    PackingSizeType remaining = size.x;
+    for (size_t i = segment; remaining > 0; ++i)
+    {
+        const PackingSizeType covered = std::min(remaining, skyline[i].width);
+        y = std::max(y, skyline[i].y);
+        if (y + size.y > atlasSize_.y)
+        {
+            return false;
+        }
+        coveredArea += skyline[i].y * covered;
+        remaining -= covered;
+    }
+
+    result = {segment, size, y, y * size.x - coveredArea};
+    return true;
+}
+
+
+bool SkylinePacker::findPosition(const Vec2<PackingSizeType>& size, Fit& best) const
+{
+    // Bottom-left heuristic: prefer the position with the lowest top edge. Ties
+    // are broken by the min waste rule, the smallest gaps left below the rect,
+    // and then by the leftmost position.
+    bool found = false;
+    auto consider = [&](size_t segment, const Vec2<PackingSizeType>& candidateSize) {
+        Fit candidate;
+        if (fit(segment, candidateSize, candidate) &&
+            (!found || std::make_pair(candidate.y + candidate.size.y, candidate.waste) <
+                           std::make_pair(best.y + best.size.y, best.waste)))
+        {
+            best = candidate;
+            found = true;
+        }
+    };
+
+    for (size_t segment = 0; segment < skyline.size(); ++segment)
+    {
+        consider(segment, size);
+        if (allowRotations && size.x != size.y)
+        {
+            consider(segment, {size.y, size.x});
+        }
+    }
+
+    return found;
+}
+
+
+void SkylinePacker::place(const Fit& fit)
+{
+    const PackingSizeType left = skyline[fit.segment].x;
+    const PackingSizeType right = left + fit.size.x;
+
+    // Replace the covered part of the skyline by the rect's top edge.
+    auto first = skyline.begin() + fit.segment;
+    auto last = first;
+    while (last != skyline.end() && last->x + last->width <= right)
+    {
+        ++last;
+    }
+    if (last != skyline.end() && last->x < right)
+    {
+        last->width -= right - last->x;
+        last->x = right;
+    }
+    first = skyline.erase(first, last);
+    first = skyline.insert(first, {left, fit.y + fit.size.y, fit.size.x});
+
+    // Merge with neighbours of the same height, so that the skyline stays short.
+    auto next = std::next(first);
+    if (next != skyline.end() && next->y == first->y)
+    {
+        first->width += next->width;
+        skyline.erase(next);
+    }
+    if (first != skyline.begin() && std::prev(first)->y == first->y)
+    {
+        std::prev(first)->width += first->width;
+        skyline.erase(first);
+    }
+}
+
+
+void SkylinePacker::grow()
+{
+    if (atlasSize_.x > atlasSize_.y)
+    {
+        atlasSize_.y *= 2;
+    }
+    else
+    {
+        if (skyline.back().y == 0)
+        {
+            skyline.back().width += atlasSize_.x;
+        }
+        else
+        {
+            skyline.push_back({atlasSize_.x, 0, atlasSize_.x});
+        }
+        atlasSize_.x *= 2;
+    }
+}
+
+
+} // namespace internal
+} // namespace llassetgen
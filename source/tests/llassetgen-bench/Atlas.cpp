@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <llassetgen/Atlas.h>
+#include <llassetgen/DistanceTransform.h>
+#include <llassetgen/FntWriter.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/packing/Algorithms.h>
+
+#include "BenchFonts.h"
+
+
+using namespace llassetgen;
+
+
+/**
+ * Glyphs of a bundled font, rendered and packed once and shared by all
+ * benchmarks of the font: all glyphs at size 32 for the font atlas, and the
+ * printable ASCII glyphs at size 128 with padding 16, downsampled by 4, for
+ * the distance field atlas.
+ */
+struct BenchFont {
+    static constexpr int fontSize = 32;
+    static constexpr int dfFontSize = 128;
+    static constexpr size_t dfPadding = 16;
+    static constexpr size_t dfDownsampling = 4;
+
+    explicit BenchFont(const std::string& fontFile) : fontFinder{benchFontFinder(fontFile)} {
+        std::set<unsigned long> allGlyphs = fontFinder.allGlyphs();
+        records = fontFinder.glyphRecords(allGlyphs, fontSize);
+        for (const GlyphRecord& record : records) {
+            glyphs.push_back(fontFinder.renderGlyph(record, 0, 1));
+            sizes.push_back(record.size);
+        }
+        packing = maxRectsPackAtlas(sizes.begin(), sizes.end(), false);
+
+        std::set<unsigned long> ascii;
+        for (unsigned long c = 32; c < 127; c++) {
+            ascii.insert(c);
+        }
+        for (const GlyphRecord& record : fontFinder.glyphRecords(ascii, dfFontSize, dfPadding, dfDownsampling)) {
+            dfGlyphs.push_back(fontFinder.renderGlyph(record, dfPadding, dfDownsampling));
+            dfSizes.push_back(record.size / dfDownsampling);
+        }
+        dfPacking = maxRectsPackAtlas(dfSizes.begin(), dfSizes.end(), false);
+    }
+
+    FontFinder fontFinder;
+    std::vector<GlyphRecord> records;
+    std::vector<Image> glyphs;
+    std::vector<Vec2<size_t>> sizes;
+    Packing packing;
+
+    std::vector<Image> dfGlyphs;
+    std::vector<Vec2<size_t>> dfSizes;
+    Packing dfPacking;
+};
+
+constexpr int BenchFont::fontSize;
+constexpr int BenchFont::dfFontSize;
+constexpr size_t BenchFont::dfPadding;
+constexpr size_t BenchFont::dfDownsampling;
+
+static BenchFont& benchFont(const std::string& fontFile) {
+    static std::map<std::string, std::unique_ptr<BenchFont>> fonts;
+    std::unique_ptr<BenchFont>& font = fonts[fontFile];
+    if (!font) {
+        font.reset(new BenchFont{fontFile});
+    }
+    return *font;
+}
+
+static void distanceTransform(Image& input, Image& output) {
+    ParabolaEnvelope(input, output).transform();
+}
+
+static void downsampling(Image& input, Image& output) {
+    input.centerDownsampling<DistanceTransform::OutputType>(output);
+}
+
+static void FontAtlasComposition(benchmark::State& state, const std::string& fontFile) {
+    BenchFont& font = benchFont(fontFile);
+    for (auto _ : state) {
+        Image atlas = fontAtlas(font.glyphs.begin(), font.glyphs.end(), font.packing);
+        benchmark::DoNotOptimize(atlas);
+    }
+    state.counters["glyphs"] = double(font.glyphs.size());
+}
+
+static void DistanceFieldAtlasComposition(benchmark::State& state, const std::string& fontFile) {
+    BenchFont& font = benchFont(fontFile);
+    for (auto _ : state) {
+        Image atlas =
+            distanceFieldAtlas(font.dfGlyphs.begin(), font.dfGlyphs.end(), font.dfPacking, distanceTransform, downsampling);
+        benchmark::DoNotOptimize(atlas);
+    }
+    state.counters["glyphs"] = double(font.dfGlyphs.size());
+}
+
+static void ExportFontAtlasPng(benchmark::State& state, const std::string& fontFile) {
+    BenchFont& font = benchFont(fontFile);
+    Image atlas = fontAtlas(font.glyphs.begin(), font.glyphs.end(), font.packing);
+    const std::string path = "bench_atlas.png";
+    for (auto _ : state) {
+        atlas.exportPng<uint8_t>(path);
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(atlas.getWidth() * atlas.getHeight()));
+}
+
+static void ExportDistanceFieldAtlasPng(benchmark::State& state, const std::string& fontFile) {
+    BenchFont& font = benchFont(fontFile);
+    Image atlas =
+        distanceFieldAtlas(font.dfGlyphs.begin(), font.dfGlyphs.end(), font.dfPacking, distanceTransform, downsampling);
+    const std::string path = "bench_dt_atlas.png";
+    for (auto _ : state) {
+        atlas.exportPng<DistanceTransform::OutputType>(path, -10, 10);
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(atlas.getWidth() * atlas.getHeight()));
+}
+
+static void SaveFnt(benchmark::State& state, const std::string& fontFile, FntFormat format) {
+    BenchFont& font = benchFont(fontFile);
+    FntWriter writer{font.fontFinder.fontFace, "bench", BenchFont::fontSize, 1, false};
+    writer.readFont(font.records);
+    writer.setAtlasProperties(font.packing.atlasSize, BenchFont::fontSize, 0);
+    for (size_t i = 0; i < font.records.size(); i++) {
+        writer.setCharInfo(font.records[i], font.packing.rects[i], {0, 0});
+    }
+
+    const std::string path = "bench.fnt";
+    for (auto _ : state) {
+        writer.saveFnt(path, format);
+    }
+    std::remove(path.c_str());
+    state.counters["glyphs"] = double(font.records.size());
+}
+
+static int registerAtlasBenchmarks() {
+    const std::map<std::string, FntFormat> formats{
+        {"text", FntFormat::Text}, {"binary", FntFormat::Binary}, {"xml", FntFormat::Xml}, {"json", FntFormat::Json}};
+    for (const char* fontFile : benchFonts) {
+        const std::string font = benchFontName(fontFile);
+        benchmark::RegisterBenchmark(("FontAtlasComposition/" + font).c_str(), FontAtlasComposition,
+                                     std::string{fontFile})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("DistanceFieldAtlasComposition/" + font).c_str(),
+                                     DistanceFieldAtlasComposition, std::string{fontFile})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("ExportPng/font/" + font).c_str(), ExportFontAtlasPng, std::string{fontFile})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("ExportPng/distfield/" + font).c_str(), ExportDistanceFieldAtlasPng,
+                                     std::string{fontFile})
+            ->Unit(benchmark::kMillisecond);
+        for (const auto& format : formats) {
+            benchmark::RegisterBenchmark(("SaveFnt/" + format.first + "/" + font).c_str(), SaveFnt,
+                                         std::string{fontFile}, format.second)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+    return 0;
+}
+
+static const int atlasBenchmarks = registerAtlasBenchmarks();
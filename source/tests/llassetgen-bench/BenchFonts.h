@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/llassetgen.h>
+
+
+/**
+ * Fonts bundled with the tests, as realistic inputs.
+ */
+static const char* const benchFonts[] = {"OpenSans-Regular.ttf", "SourceSansPro-Regular.ttf"};
+
+inline llassetgen::FontFinder benchFontFinder(const std::string& fileName) {
+    static const bool initialized = (llassetgen::init(), true);
+    (void)initialized;
+    return llassetgen::FontFinder::fromPath(std::string{LLASSETGEN_BENCH_FONT_DIR} + fileName);
+}
+
+/**
+ * Family part of a font file name, for benchmark names.
+ */
+inline std::string benchFontName(const std::string& fileName) {
+    return fileName.substr(0, fileName.find('-'));
+}
@@ -0,0 +1,182 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <llassetgen/BundleReader.h>
+#include <llassetgen/BundleWriter.h>
+#include <llassetgen/FntReader.h>
+#include <llassetgen/FntWriter.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/packing/Algorithms.h>
+
+#include "BenchFonts.h"
+
+
+using namespace llassetgen;
+
+
+/**
+ * The same glyphs of a bundled font written as text FNT, binary FNT and
+ * bundle, once for all benchmarks of the font. With a glyph count larger
+ * than the font, the glyphs are repeated at private use codepoints without
+ * kerning, to compare the formats for very large fonts.
+ */
+struct BenchAsset {
+    static constexpr int fontSize = 32;
+    static constexpr uint32_t privateUseArea = 0xF0000;
+
+    BenchAsset(const std::string& fontFile, size_t glyphCount) {
+        FontFinder fontFinder = benchFontFinder(fontFile);
+        std::vector<GlyphRecord> records = fontFinder.glyphRecords(fontFinder.allGlyphs(), fontSize);
+        for (size_t i = records.size(); i < glyphCount; i++) {
+            GlyphRecord record = records[i % records.size()];
+            record.charcode = privateUseArea + i;
+            record.gindex = 0;
+            records.push_back(record);
+        }
+
+        std::vector<Vec2<size_t>> sizes;
+        for (const GlyphRecord& record : records) {
+            sizes.push_back(record.size);
+            codepoints.push_back(static_cast<uint32_t>(record.charcode));
+        }
+        Packing packing = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+        FntWriter fntWriter{fontFinder.fontFace, "bench", fontSize, 1, false};
+        fntWriter.readFont(records);
+        fntWriter.setAtlasProperties(packing.atlasSize, fontSize, 0);
+        for (size_t i = 0; i < records.size(); i++) {
+            fntWriter.setCharInfo(records[i], packing.rects[i], {0, 0});
+        }
+        const std::string fileName = "bench_" + benchFontName(fontFile) + "_" + std::to_string(records.size());
+        textPath = fileName + ".fnt";
+        binaryPath = fileName + "_binary.fnt";
+        fntWriter.saveFnt(textPath, FntFormat::Text);
+        fntWriter.saveFnt(binaryPath, FntFormat::Binary);
+
+        BundleWriter bundleWriter{fontFinder.fontFace, fontSize};
+        bundleWriter.setGlyphs(records, packing);
+        bundlePath = fileName + ".llfb";
+        bundleWriter.saveBundle(bundlePath);
+    }
+
+    ~BenchAsset() {
+        std::remove(textPath.c_str());
+        std::remove(binaryPath.c_str());
+        std::remove(bundlePath.c_str());
+    }
+
+    std::vector<uint32_t> codepoints;
+    std::string textPath;
+    std::string binaryPath;
+    std::string bundlePath;
+};
+
+constexpr int BenchAsset::fontSize;
+constexpr uint32_t BenchAsset::privateUseArea;
+
+static BenchAsset& benchAsset(const std::string& fontFile, size_t glyphCount) {
+    static std::map<std::pair<std::string, size_t>, std::unique_ptr<BenchAsset>> assets;
+    std::unique_ptr<BenchAsset>& asset = assets[{fontFile, glyphCount}];
+    if (!asset) {
+        asset.reset(new BenchAsset{fontFile, glyphCount});
+    }
+    return *asset;
+}
+
+/**
+ * File contents in 8 byte aligned memory, as a mapping would provide them,
+ * read with a single call like FntReader reads its files.
+ */
+static std::vector<uint64_t> readAligned(const std::string& path, size_t& size) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    size = static_cast<size_t>(file.tellg());
+    std::vector<uint64_t> aligned((size + 7) / 8);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(aligned.data()), std::streamsize(size));
+    return aligned;
+}
+
+// Time until the glyphs of a font can be looked up: parsing an FNT file, or reading and validating a bundle.
+static void LoadFnt(benchmark::State& state, const std::string& fontFile, size_t glyphCount, FntFormat format) {
+    BenchAsset& asset = benchAsset(fontFile, glyphCount);
+    const std::string& path = format == FntFormat::Binary ? asset.binaryPath : asset.textPath;
+    for (auto _ : state) {
+        FntReader reader{path};
+        benchmark::DoNotOptimize(reader.chars().data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(asset.codepoints.size()));
+}
+
+static void LoadBundle(benchmark::State& state, const std::string& fontFile, size_t glyphCount) {
+    BenchAsset& asset = benchAsset(fontFile, glyphCount);
+    for (auto _ : state) {
+        size_t size;
+        std::vector<uint64_t> data = readAligned(asset.bundlePath, size);
+        BundleReader reader{data.data(), size};
+        benchmark::DoNotOptimize(reader.isValid());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(asset.codepoints.size()));
+}
+
+static void BundleFindGlyph(benchmark::State& state, const std::string& fontFile, size_t glyphCount) {
+    BenchAsset& asset = benchAsset(fontFile, glyphCount);
+    size_t size;
+    std::vector<uint64_t> data = readAligned(asset.bundlePath, size);
+    BundleReader reader{data.data(), size};
+    for (auto _ : state) {
+        for (uint32_t codepoint : asset.codepoints) {
+            benchmark::DoNotOptimize(reader.findGlyph(codepoint));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(asset.codepoints.size()));
+}
+
+static void BundleKerning(benchmark::State& state, const std::string& fontFile) {
+    BenchAsset& asset = benchAsset(fontFile, 0);
+    size_t size;
+    std::vector<uint64_t> data = readAligned(asset.bundlePath, size);
+    BundleReader reader{data.data(), size};
+    const bundle::Kerning* pairs = reader.kernings();
+    const size_t pairCount = reader.info().kerningCount;
+    for (auto _ : state) {
+        for (size_t i = 0; i < pairCount; i++) {
+            benchmark::DoNotOptimize(reader.kerning(pairs[i].first, pairs[i].second));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(pairCount));
+}
+
+static int registerBundleBenchmarks() {
+    for (const char* fontFile : benchFonts) {
+        // the glyphs of the font, and 50k glyphs for the largest fonts
+        for (size_t glyphCount : {size_t(0), size_t(50000)}) {
+            const std::string name = benchFontName(fontFile) + (glyphCount ? "/50k" : "");
+            benchmark::RegisterBenchmark(("LoadGlyphs/fnt-text/" + name).c_str(), LoadFnt, std::string{fontFile},
+                                         glyphCount, FntFormat::Text)
+                ->Unit(benchmark::kMicrosecond);
+            benchmark::RegisterBenchmark(("LoadGlyphs/fnt-binary/" + name).c_str(), LoadFnt, std::string{fontFile},
+                                         glyphCount, FntFormat::Binary)
+                ->Unit(benchmark::kMicrosecond);
+            benchmark::RegisterBenchmark(("LoadGlyphs/bundle/" + name).c_str(), LoadBundle, std::string{fontFile},
+                                         glyphCount)
+                ->Unit(benchmark::kMicrosecond);
+            benchmark::RegisterBenchmark(("BundleFindGlyph/" + name).c_str(), BundleFindGlyph, std::string{fontFile},
+                                         glyphCount)
+                ->Unit(benchmark::kMicrosecond);
+        }
+        benchmark::RegisterBenchmark(("BundleKerning/" + benchFontName(fontFile)).c_str(), BundleKerning,
+                                     std::string{fontFile})
+            ->Unit(benchmark::kMicrosecond);
+    }
+    return 0;
+}
+
+static const int bundleBenchmarks = registerBundleBenchmarks();
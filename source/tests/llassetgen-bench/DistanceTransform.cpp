@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <algorithms.h>
+
+#include "BenchFonts.h"
+
+
+/**
+ * A glyph rendered from a bundled font, about `size` pixels high including padding.
+ */
+static Image renderBenchGlyph(const std::string& fontFile, size_t size) {
+    FontFinder fontFinder = benchFontFinder(fontFile);
+    fontFinder.setFontSize(static_cast<int>(size * 3 / 4));
+    return fontFinder.renderGlyph('g', size / 8, 1);
+}
+
+static void DistanceTransformBench(benchmark::State& state, ImageTransform transform, const std::string& fontFile) {
+    Image glyph = renderBenchGlyph(fontFile, static_cast<size_t>(state.range(0)));
+    Image output{glyph.getWidth(), glyph.getHeight(), DistanceTransform::bitDepth};
+    for (auto _ : state) {
+        transform(glyph, output);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(glyph.getWidth() * glyph.getHeight()));
+    state.SetComplexityN(int64_t(glyph.getWidth() * glyph.getHeight()));
+}
+
+/**
+ * Downsampling the distance field of a glyph by 4, like an atlas with `--downsampling 4`.
+ */
+static void DownsamplingBench(benchmark::State& state, ImageTransform downsampling, const std::string& fontFile) {
+    Image glyph = renderBenchGlyph(fontFile, static_cast<size_t>(state.range(0)));
+    Image distField{glyph.getWidth(), glyph.getHeight(), DistanceTransform::bitDepth};
+    ParabolaEnvelope(glyph, distField).transform();
+    Image output{glyph.getWidth() / 4, glyph.getHeight() / 4, DistanceTransform::bitDepth};
+    for (auto _ : state) {
+        downsampling(output, distField);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(glyph.getWidth() * glyph.getHeight()));
+}
+
+// One benchmark per entry of the algorithm maps of llassetgen-cmd and per font
+static int registerImageBenchmarks() {
+    for (const char* fontFile : benchFonts) {
+        const std::string font = benchFontName(fontFile);
+        for (const auto& algo : dtAlgos) {
+            benchmark::RegisterBenchmark(("DistanceTransform/" + algo.first + "/" + font).c_str(),
+                                         DistanceTransformBench, algo.second, std::string{fontFile})
+                ->RangeMultiplier(4)
+                ->Range(64, 1024)
+                ->Unit(benchmark::kMillisecond)
+                ->Complexity(benchmark::oN);
+        }
+        for (const auto& algo : downsamplingAlgos) {
+            benchmark::RegisterBenchmark(("Downsampling/" + algo.first + "/" + font).c_str(), DownsamplingBench,
+                                         algo.second, std::string{fontFile})
+                ->Arg(256)
+                ->Arg(1024)
+                ->Unit(benchmark::kMicrosecond);
+        }
+    }
+    return 0;
+}
+
+static const int imageBenchmarks = registerImageBenchmarks();
@@ -0,0 +1,151 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <llassetgen/packing/Algorithms.h>
+#include <llassetgen/packing/AtlasAllocator.h>
+#include <llassetgen/packing/SizeSearch.h>
+
+#include "GlyphSizes.h"
+
+
+using Vec = llassetgen::Vec2<llassetgen::PackingSizeType>;
+
+
+/**
+ * Share of the atlas covered by rects.
+ */
+static double occupancy(const llassetgen::Packing& packing) {
+    llassetgen::PackingSizeType usedArea = 0;
+    for (const auto& rect : packing.rects) {
+        usedArea += rect.size.x * rect.size.y;
+    }
+    return double(usedArea) / double(packing.atlasSize.x * packing.atlasSize.y);
+}
+
+static void MaxRectsPacking(benchmark::State& state, bool allowRotations) {
+    const std::vector<Vec> sizes = glyphSizes(static_cast<size_t>(state.range(0)), 42);
+    llassetgen::Packing packing;
+    for (auto _ : state) {
+        packing = llassetgen::maxRectsPackAtlas(sizes.begin(), sizes.end(), allowRotations);
+        benchmark::DoNotOptimize(packing);
+    }
+    state.SetComplexityN(state.range(0));
+    state.counters["occupancy"] = occupancy(packing);
+}
+
+// Scaling up to 100k rects
+BENCHMARK_CAPTURE(MaxRectsPacking, fixed, false)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(MaxRectsPacking, rotations, true)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+
+static void ShelfPacking(benchmark::State& state, bool allowRotations) {
+    const std::vector<Vec> sizes = glyphSizes(static_cast<size_t>(state.range(0)), 42);
+    llassetgen::Packing packing;
+    for (auto _ : state) {
+        packing = llassetgen::shelfPackAtlas(sizes.begin(), sizes.end(), allowRotations);
+        benchmark::DoNotOptimize(packing);
+    }
+    state.SetComplexityN(state.range(0));
+    state.counters["occupancy"] = occupancy(packing);
+}
+
+BENCHMARK_CAPTURE(ShelfPacking, fixed, false)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(ShelfPacking, rotations, true)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond)
+    ->Complexity();
+
+/**
+ * All max rects variants of bestPackAtlas, in a fixed size atlas so that the
+ * bounding box decides. Reports how much of it the best packing covers.
+ */
+static void BestPacking(benchmark::State& state) {
+    const std::vector<Vec> sizes = glyphSizes(static_cast<size_t>(state.range(0)), 42);
+    const Vec atlasSize = llassetgen::maxRectsPackAtlas(sizes.begin(), sizes.end(), false).atlasSize;
+    llassetgen::Packing packing;
+    for (auto _ : state) {
+        packing = llassetgen::bestPackAtlas(sizes.begin(), sizes.end(), atlasSize, false);
+        benchmark::DoNotOptimize(packing);
+    }
+
+    Vec used{0, 0};
+    llassetgen::PackingSizeType usedArea = 0;
+    for (const auto& rect : packing.rects) {
+        used.x = std::max(used.x, rect.position.x + rect.size.x);
+        used.y = std::max(used.y, rect.position.y + rect.size.y);
+        usedArea += rect.size.x * rect.size.y;
+    }
+    state.counters["occupancy"] = double(usedArea) / double(used.x * used.y);
+}
+
+BENCHMARK(BestPacking)->RangeMultiplier(10)->Range(100, 1000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Smallest atlas size search, compare the occupancy with MaxRectsPacking.
+ */
+static void SmallestAtlasPacking(benchmark::State& state, llassetgen::FixedSizePackingAlgorithm algorithm) {
+    const std::vector<Vec> sizes = glyphSizes(static_cast<size_t>(state.range(0)), 42);
+    llassetgen::Packing packing;
+    for (auto _ : state) {
+        packing = llassetgen::packSmallestAtlas(sizes, algorithm, false);
+        benchmark::DoNotOptimize(packing);
+    }
+    state.counters["occupancy"] = occupancy(packing);
+}
+
+BENCHMARK_CAPTURE(SmallestAtlasPacking, maxrects, llassetgen::maxRectsPackAtlas)
+    ->RangeMultiplier(10)
+    ->Range(100, 1000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(SmallestAtlasPacking, skyline, llassetgen::skylinePackAtlas)
+    ->RangeMultiplier(10)
+    ->Range(100, 10000)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * A runtime glyph atlas that is kept about 80 percent full: every iteration
+ * removes a random glyph and inserts a new one, evicting more random glyphs
+ * until it fits.
+ */
+template <class Allocator>
+static void AtlasAllocatorChurn(benchmark::State& state) {
+    const std::vector<Vec> sizes = glyphSizes(100000, 42);
+    Allocator allocator{{1024, 1024}};
+    std::vector<llassetgen::Rect<llassetgen::PackingSizeType>> rects;
+    size_t next = 0;
+    llassetgen::Rect<llassetgen::PackingSizeType> rect;
+    while (allocator.occupancy() < 0.8 && allocator.insert(sizes[next++ % sizes.size()], rect)) {
+        rects.push_back(rect);
+    }
+
+    TestRandom random{7};
+    for (auto _ : state) {
+        const Vec size = sizes[next++ % sizes.size()];
+        do {
+            const size_t removed = random.below(rects.size());
+            allocator.remove(rects[removed]);
+            rects[removed] = rects.back();
+            rects.pop_back();
+        } while (!allocator.insert(size, rect) && !rects.empty());
+        rects.push_back(rect);
+    }
+    state.counters["occupancy"] = allocator.occupancy();
+}
+
+BENCHMARK_TEMPLATE(AtlasAllocatorChurn, llassetgen::MaxRectsAtlasAllocator);
+BENCHMARK_TEMPLATE(AtlasAllocatorChurn, llassetgen::ShelfAtlasAllocator);
@@ -0,0 +1,29 @@
+# A batch job that fails, here writing to a missing directory, is reported and the other jobs are still built.
+#
+# Usage: cmake -DCMD=<llassetgen-cmd> -DFONT=<font file> -DDIR=<scratch directory> -P batch-failing-job.cmake
+
+file(REMOVE_RECURSE ${DIR})
+file(MAKE_DIRECTORY ${DIR})
+file(WRITE ${DIR}/batch.ini
+    "fontpath = ${FONT}\n"
+    "ascii = true\n"
+    "[bad]\n"
+    "outfile = ${DIR}/missing/bad.png\n"
+    "[good]\n"
+    "outfile = ${DIR}/good.png\n")
+
+execute_process(COMMAND ${CMD} batch --jobs 1 ${DIR}/batch.ini
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE error)
+
+if(NOT result EQUAL 2)
+    message(FATAL_ERROR "batch exited with ${result} instead of 2\n${output}${error}")
+endif()
+if(NOT error MATCHES "\\[1/2\\] Error in bad: could not open file")
+    message(FATAL_ERROR "the failing job was not reported\n${output}${error}")
+endif()
+if(NOT output MATCHES "\\[2/2\\] good: " OR NOT output MATCHES "Built 1 of 2 atlases" OR NOT EXISTS ${DIR}/good.png)
+    message(FATAL_ERROR "the job after the failing one was not built\n${output}${error}")
+endif()
+file(REMOVE_RECURSE ${DIR})
@@ -0,0 +1,63 @@
+#!/bin/sh
+# Requests to llassetgen-server must behave like llassetgen-cmd: warnings go to the stderr of the client, also for
+# glyphs the server has cached, and a request that fails, here writing to a missing directory, is answered with exit
+# code 2 and leaves the server running for the next request.
+#
+# Usage: server-requests.sh CMD SERVER CLIENT FONT
+
+cmd=$1
+server=$2
+client=$3
+font=$4
+
+dir=$(mktemp -d)
+socket=$dir/llassetgen.sock
+"$server" --socket "$socket" > "$dir/server.log" 2>&1 &
+pid=$!
+trap 'kill $pid 2> /dev/null; rm -rf "$dir"' EXIT
+
+tries=0
+while [ ! -S "$socket" ]; do
+    tries=$((tries + 1))
+    if [ $tries -gt 100 ] || ! kill -0 $pid 2> /dev/null; then
+        echo "llassetgen-server did not start"
+        cat "$dir/server.log"
+        exit 1
+    fi
+    sleep 0.1
+done
+
+# U+4E00 is not in the font
+"$cmd" atlas "$dir/cmd.png" --fontpath "$font" --charcode 65 19968 2> "$dir/cmd.log"
+for request in 1 2; do
+    "$client" --socket "$socket" atlas "$dir/client.png" --fontpath "$font" --charcode 65 19968 2> "$dir/client.log"
+    if ! cmp -s "$dir/cmd.log" "$dir/client.log"; then
+        echo "stderr of request $request differs from llassetgen-cmd:"
+        cat "$dir/client.log"
+        exit 1
+    fi
+done
+if ! grep -q "font does not contain glyph with code 19968" "$dir/client.log"; then
+    echo "the missing glyph was not reported"
+    exit 1
+fi
+
+"$client" --socket "$socket" atlas --fontpath "$font" --ascii "$dir/missing/atlas.png" 2> "$dir/error.log"
+code=$?
+if [ $code -ne 2 ]; then
+    echo "failing request exited with $code instead of 2"
+    exit 1
+fi
+if ! grep -q "could not open file" "$dir/error.log"; then
+    echo "failing request did not report the error:"
+    cat "$dir/error.log"
+    exit 1
+fi
+
+if ! "$client" --socket "$socket" status; then
+    echo "llassetgen-server did not survive the failing request"
+    cat "$dir/server.log"
+    exit 1
+fi
+"$client" --socket "$socket" stop
+wait $pid
@@ -0,0 +1,128 @@
+#include "PerfResults.h"
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <jsonreader.h>
+
+
+namespace {
+
+std::string formatChange(double baseline, double current) {
+    if (baseline <= 0) {
+        return "";
+    }
+    std::ostringstream change;
+    change << std::showpos << std::fixed << std::setprecision(1) << (current / baseline - 1) * 100 << '%';
+    return change.str();
+}
+
+}  // namespace
+
+
+PerfResults loadPerfResults(const std::string& filepath) {
+    std::ifstream in{filepath};
+    if (!in) {
+        return {};
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    PerfResults results;
+    JsonReader reader{text, "malformed results file"};
+    reader.readObject([&](const std::string& key) {
+        if (key != "scenarios") {
+            throw std::runtime_error("unknown key \"" + key + "\" in results file");
+        }
+        reader.readObject([&](const std::string& scenario) {
+            PerfResult& result = results[scenario];
+            reader.readObject([&](const std::string& field) {
+                if (field == "peakRssMiB") {
+                    result.peakRssMiB = reader.readNumber();
+                } else if (field == "stageMs") {
+                    reader.readObject([&](const std::string& stage) { result.stageMs[stage] = reader.readNumber(); });
+                } else {
+                    throw std::runtime_error("unknown key \"" + field + "\" in results file");
+                }
+            });
+        });
+    });
+    reader.expectEnd();
+    return results;
+}
+
+void savePerfResults(const PerfResults& results, const std::string& filepath) {
+    std::ofstream out{filepath};
+    if (!out) {
+        throw std::runtime_error("results file could not be opened");
+    }
+
+    out << std::fixed << std::setprecision(3) << "{\n  \"scenarios\": {";
+    const char* scenarioSeparator = "\n";
+    for (const auto& scenario : results) {
+        out << scenarioSeparator << "    \"" << scenario.first << "\": {\n"
+            << "      \"peakRssMiB\": " << scenario.second.peakRssMiB << ",\n"
+            << "      \"stageMs\": {";
+        const char* stageSeparator = "\n";
+        for (const auto& stage : scenario.second.stageMs) {
+            out << stageSeparator << "        \"" << stage.first << "\": " << stage.second;
+            stageSeparator = ",\n";
+        }
+        out << "\n      }\n    }";
+        scenarioSeparator = ",\n";
+    }
+    out << "\n  }\n}\n";
+
+    if (!out) {
+        throw std::runtime_error("results file could not be written");
+    }
+}
+
+bool comparePerfResults(const PerfResult& baseline, const PerfResult& current, const PerfTolerance& tolerance,
+                        std::ostream& out) {
+    bool passed = true;
+    auto row = [&](const std::string& name, const std::string& baselineValue, const std::string& currentValue,
+                   const std::string& change, const std::string& verdict) {
+        out << std::left << std::setw(26) << name << std::right << std::setw(12) << baselineValue << std::setw(12)
+            << currentValue << std::setw(10) << change << "  " << verdict << '\n';
+    };
+    auto format = [](double value, const char* unit) {
+        std::ostringstream formatted;
+        formatted << std::fixed << std::setprecision(1) << value << ' ' << unit;
+        return formatted.str();
+    };
+
+    row("stage", "baseline", "current", "change", "");
+    std::set<std::string> stages;
+    for (const auto& stage : baseline.stageMs) {
+        stages.insert(stage.first);
+    }
+    for (const auto& stage : current.stageMs) {
+        stages.insert(stage.first);
+    }
+    for (const std::string& stage : stages) {
+        auto before = baseline.stageMs.find(stage);
+        auto after = current.stageMs.find(stage);
+        if (before == baseline.stageMs.end()) {
+            row(stage, "-", format(after->second, "ms"), "", "new");
+        } else if (after == current.stageMs.end()) {
+            row(stage, format(before->second, "ms"), "-", "", "removed");
+        } else {
+            const bool slower = after->second > before->second * (1 + tolerance.time) &&
+                                after->second > before->second + tolerance.slackMs;
+            passed = passed && !slower;
+            row(stage, format(before->second, "ms"), format(after->second, "ms"),
+                formatChange(before->second, after->second), slower ? "REGRESSION" : "");
+        }
+    }
+
+    const bool larger = current.peakRssMiB > baseline.peakRssMiB * (1 + tolerance.rss);
+    passed = passed && !larger;
+    row("peak RSS", format(baseline.peakRssMiB, "MiB"), format(current.peakRssMiB, "MiB"),
+        formatChange(baseline.peakRssMiB, current.peakRssMiB), larger ? "REGRESSION" : "");
+    return passed;
+}
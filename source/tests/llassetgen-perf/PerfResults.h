@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+
+
+/**
+ * Measurements of one scenario: the wall time of every profiled stage and of
+ * the whole scenario ("total") in milliseconds, and the peak resident set
+ * size of the process.
+ */
+struct PerfResult {
+    std::map<std::string, double> stageMs;
+    double peakRssMiB = 0;
+};
+
+/**
+ * Results by scenario name, as stored in a baseline file:
+ *
+ *     {"scenarios": {"<name>": {"peakRssMiB": 12.5, "stageMs": {"total": 80.2, ...}}, ...}}
+ */
+using PerfResults = std::map<std::string, PerfResult>;
+
+/**
+ * Throws std::runtime_error if the file can not be read or is malformed. A
+ * missing file has no results.
+ */
+PerfResults loadPerfResults(const std::string& filepath);
+
+void savePerfResults(const PerfResults& results, const std::string& filepath);
+
+struct PerfTolerance {
+    // Relative slowdown of a stage that still passes, e.g. 0.25 for 25%
+    double time;
+    // Stages may always get this much slower, to not fail on the noise of very short stages
+    double slackMs;
+    // Relative growth of the peak RSS that still passes
+    double rss;
+};
+
+/**
+ * Print a table of the baseline and current values of every stage and of the
+ * peak RSS to `out`, marking regressions beyond the tolerance. Stages that
+ * were added or removed are listed, but are no regressions.
+ *
+ * @return
+ *   true if nothing regressed.
+ */
+bool comparePerfResults(const PerfResult& baseline, const PerfResult& current, const PerfTolerance& tolerance,
+                        std::ostream& out);
@@ -0,0 +1,95 @@
+#include "Scenarios.h"
+
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include <llassetgen/Atlas.h>
+#include <llassetgen/DistanceTransform.h>
+#include <llassetgen/FntWriter.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/llassetgen.h>
+#include <llassetgen/packing/Algorithms.h>
+
+#include "GlyphSizes.h"
+
+
+using namespace llassetgen;
+
+
+static void distanceTransform(Image& input, Image& output) {
+    ParabolaEnvelope(input, output).transform();
+}
+
+static void downsampling(Image& input, Image& output) {
+    input.centerDownsampling<DistanceTransform::OutputType>(output);
+}
+
+/**
+ * Like `llassetgen-cmd atlas --ascii --fontsize 128 --padding 16 --distfield parabola --packing maxrects
+ * --downsampling 8 --fnt` with the bundled OpenSans.
+ */
+static void asciiDistanceField() {
+    const int fontSize = 128;
+    const size_t padding = 16;
+    const size_t downsamplingRatio = 8;
+
+    FontFinder fontFinder = FontFinder::fromPath(std::string{LLASSETGEN_PERF_FONT_DIR} + "OpenSans-Regular.ttf");
+    std::set<unsigned long> glyphs;
+    for (unsigned long c = '!'; c <= '~'; c++) {
+        glyphs.insert(c);
+    }
+
+    std::vector<GlyphRecord> records = fontFinder.glyphRecords(glyphs, fontSize, padding, downsamplingRatio);
+    std::vector<Vec2<size_t>> imageSizes;
+    for (const GlyphRecord& record : records) {
+        imageSizes.push_back(record.size / downsamplingRatio);
+    }
+    Packing p = maxRectsPackAtlas(imageSizes.begin(), imageSizes.end(), false);
+
+    auto renderGlyph = [&](size_t i) { return fontFinder.renderGlyph(records[i], padding, downsamplingRatio); };
+    Image atlas = distanceFieldAtlas(p, renderGlyph, distanceTransform, downsampling, 30, -20);
+    atlas.exportPng<uint16_t>("perf_ascii.png");
+
+    FntWriter writer{fontFinder.fontFace, "perf_ascii", fontSize, 1, false};
+    writer.readFont(records);
+    writer.setAtlasProperties(p.atlasSize, fontSize, padding);
+    for (size_t i = 0; i < p.rects.size(); i++) {
+        writer.setCharInfo(records[i], p.rects[i], {0, 0});
+    }
+    writer.saveFnt("perf_ascii.fnt", FntFormat::Text);
+
+    std::remove("perf_ascii.png");
+    std::remove("perf_ascii.fnt");
+}
+
+/**
+ * A distance field atlas of 5k filled rectangles of 8 to 38 pixels, as a
+ * stand-in for a large CJK glyph set, downsampled by 2.
+ */
+static void synthetic5k() {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(5000);
+    std::vector<Vec2<size_t>> imageSizes;
+    for (const auto& size : glyphSizes) {
+        imageSizes.push_back(size / 2);
+    }
+    Packing p = maxRectsPackAtlas(imageSizes.begin(), imageSizes.end(), false);
+
+    auto renderGlyph = [&](size_t i) {
+        Image glyph{glyphSizes[i].x, glyphSizes[i].y, 1};
+        glyph.clear();
+        glyph.fillRect<uint8_t>({2, 2}, glyphSizes[i] - Vec2<size_t>{2, 2}, 1);
+        return glyph;
+    };
+    Image atlas = distanceFieldAtlas(p, renderGlyph, distanceTransform, downsampling, 10, -10);
+    atlas.exportPng<uint16_t>("perf_synthetic.png");
+    std::remove("perf_synthetic.png");
+}
+
+const std::map<std::string, std::function<void()>>& perfScenarios() {
+    static const std::map<std::string, std::function<void()>> scenarios{
+        {"ascii-parabola-maxrects", asciiDistanceField},
+        {"synthetic-5k", synthetic5k},
+    };
+    return scenarios;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+
+
+/**
+ * The pipeline scenarios of the performance tests by name. Each one builds
+ * and exports an atlas in the current working directory, from the bundled
+ * test fonts or synthetic glyphs, and removes its files again.
+ */
+const std::map<std::string, std::function<void()>>& perfScenarios();
@@ -0,0 +1,132 @@
+#include <CLI11.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <llassetgen/Profiler.h>
+#include <llassetgen/llassetgen.h>
+
+#include "PerfResults.h"
+#include "Scenarios.h"
+
+
+using namespace llassetgen;
+
+
+static double peakRssMiB() {
+#if defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#elif defined(__unix__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;  // KiB
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Run a scenario several times and keep the fastest time of every stage,
+ * which is the least disturbed by other processes. A first, unmeasured run
+ * loads the font files and warms up the caches.
+ */
+static PerfResult runScenario(const std::function<void()>& scenario, unsigned int repetitions) {
+    scenario();
+
+    PerfResult result;
+    for (unsigned int i = 0; i < repetitions; i++) {
+        Profiler::enable();
+        const auto start = std::chrono::steady_clock::now();
+        scenario();
+        const std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - start;
+        Profiler::disable();
+
+        auto keepFastest = [&](const std::string& stage, double ms) {
+            auto it = result.stageMs.find(stage);
+            if (it == result.stageMs.end() || ms < it->second) {
+                result.stageMs[stage] = ms;
+            }
+        };
+        keepFastest("total", total.count());
+        for (const ProfileStage& stage : Profiler::stages()) {
+            keepFastest(stage.name, stage.seconds * 1000);
+        }
+    }
+    result.peakRssMiB = peakRssMiB();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"Run a pipeline scenario and compare its stage timings and peak memory with a baseline"};
+
+    std::set<std::string> scenarioNames;
+    for (const auto& scenario : perfScenarios()) {
+        scenarioNames.insert(scenario.first);
+    }
+    std::string scenarioName;
+    app.add_set("--scenario", scenarioName, scenarioNames, "Scenario to run")->required();
+
+    std::string baselinePath;
+    app.add_option("--baseline", baselinePath, "Results file to compare with")->required();
+
+    std::string outputPath;
+    app.add_option("--output", outputPath, "Write the results of this run to this file");
+
+    bool updateBaseline = false;
+    app.add_flag("--update-baseline", updateBaseline, "Store the results in the baseline file instead of comparing");
+
+    unsigned int repetitions = 5;
+    app.add_option("--repetitions", repetitions, "Run the scenario this often and keep the fastest times", true);
+
+    PerfTolerance tolerance{0.3, 2, 0.1};
+    app.add_option("--tolerance", tolerance.time, "Allowed relative slowdown of a stage", true);
+    app.add_option("--slack", tolerance.slackMs, "Milliseconds any stage may get slower regardless", true);
+    app.add_option("--rss-tolerance", tolerance.rss, "Allowed relative growth of the peak RSS", true);
+
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        init();
+        const PerfResult current = runScenario(perfScenarios().at(scenarioName), std::max(repetitions, 1u));
+
+        PerfResults baseline = loadPerfResults(baselinePath);
+        if (updateBaseline) {
+            baseline[scenarioName] = current;
+            savePerfResults(baseline, baselinePath);
+            std::cout << "Updated the baseline of " << scenarioName << " in " << baselinePath << std::endl;
+            return 0;
+        }
+        if (!outputPath.empty()) {
+            savePerfResults({{scenarioName, current}}, outputPath);
+        }
+
+        auto expected = baseline.find(scenarioName);
+        if (expected == baseline.end()) {
+            std::cerr << "Error: " << baselinePath << " has no baseline for " << scenarioName
+                      << ", record one with --update-baseline" << std::endl;
+            return 1;
+        }
+        std::cout << scenarioName << ", fastest of " << repetitions << " runs, tolerance " << tolerance.time * 100
+                  << "% (at least " << tolerance.slackMs << " ms), peak RSS tolerance " << tolerance.rss * 100
+                  << "%\n\n";
+        const bool passed = comparePerfResults(expected->second, current, tolerance, std::cout);
+        if (!passed) {
+            std::cout << "\nPerformance regressed. If this is expected, update the baseline with --update-baseline"
+                      << std::endl;
+        }
+        return passed ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
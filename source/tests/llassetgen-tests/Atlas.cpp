@@ -1,10 +1,19 @@
 
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
 
 #include <llassetgen/Atlas.h>
+#include <llassetgen/AtlasManifest.h>
+#include <llassetgen/TileCache.h>
 #include <llassetgen/packing/Algorithms.h>
 
+#include "GlyphSizes.h"
+
 
 using namespace llassetgen;
 
@@ -49,3 +58,426 @@ TEST(AtlasTest, CreateFontAtlas) {
     std::string outPath = atlasTestDestinationPath + "atlas.png";
     atlas.exportPng<uint8_t>(outPath);
 }
+
+TEST(AtlasTest, RenderOnDemand) {
+    std::vector<Image> glyphs;
+    glyphs.reserve(atlasTestSizes.size());
+
+    for (const auto& size : atlasTestSizes) {
+        glyphs.emplace_back(size.x, size.y, 1);
+        glyphs.back().clear();
+        glyphs.back().fillRect<uint8_t>({0, 0}, size / 2, 1);
+    }
+
+    Packing p = shelfPackAtlas(atlasTestSizes.begin(), atlasTestSizes.end(), false);
+    auto renderGlyph = [&glyphs](size_t i) {
+        Image copy{glyphs[i].getWidth(), glyphs[i].getHeight(), 1};
+        copy.copyDataFrom(glyphs[i]);
+        return copy;
+    };
+
+    Image expected = fontAtlas(glyphs.begin(), glyphs.end(), p);
+    Image actual = fontAtlas(p, renderGlyph);
+    for (size_t y = 0; y < expected.getHeight(); y++) {
+        for (size_t x = 0; x < expected.getWidth(); x++) {
+            EXPECT_EQ(expected.getPixel<uint8_t>({x, y}), actual.getPixel<uint8_t>({x, y}));
+        }
+    }
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.centerDownsampling<DistanceTransform::OutputType>(out); };
+    Image expectedDf = distanceFieldAtlas(glyphs.begin(), glyphs.end(), p, dtFunc, downsampling);
+    Image actualDf = distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling);
+    for (size_t y = 0; y < expectedDf.getHeight(); y++) {
+        for (size_t x = 0; x < expectedDf.getWidth(); x++) {
+            EXPECT_EQ(expectedDf.getPixel<float>({x, y}), actualDf.getPixel<float>({x, y}));
+        }
+    }
+}
+
+std::vector<char> readAtlasFile(const std::string& path) {
+    std::ifstream in(path, std::ifstream::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+#ifdef __linux__
+size_t procStatusBytes(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) {
+            return std::stoul(line.substr(field.size() + 1)) * 1024;
+        }
+    }
+    return 0;
+}
+#endif
+
+/*
+ * Synthetic glyph set: the sizes of supersampledGlyphSizes, each glyph a filled rectangle with a margin.
+ */
+Image syntheticGlyph(const Vec2<size_t>& size) {
+    Image glyph{size.x, size.y, 1};
+    glyph.clear();
+    glyph.fillRect<uint8_t>({2, 2}, size - Vec2<size_t>{2, 2}, 1);
+    return glyph;
+}
+
+TEST(AtlasTest, StreamedAtlasMatchesInMemory) {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(300);
+    std::vector<Vec2<size_t>> rectSizes;
+    for (const auto& size : glyphSizes) {
+        rectSizes.push_back(size / 2);
+    }
+    Packing p = maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+    auto renderGlyph = [&glyphSizes](size_t i) { return syntheticGlyph(glyphSizes[i]); };
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+
+    std::string inMemoryPath = atlasTestDestinationPath + "dt_atlas_memory.png";
+    std::string streamedPath = atlasTestDestinationPath + "dt_atlas_streamed.png";
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling).exportPng<float>(inMemoryPath, 10, -10);
+    streamDistanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, streamedPath, 10, -10);
+    EXPECT_EQ(readAtlasFile(inMemoryPath), readAtlasFile(streamedPath));
+
+    auto renderHalfGlyph = [&rectSizes](size_t i) { return syntheticGlyph(rectSizes[i]); };
+    fontAtlas(p, renderHalfGlyph).exportPng<uint8_t>(inMemoryPath);
+    streamFontAtlas(p, renderHalfGlyph, streamedPath);
+    EXPECT_EQ(readAtlasFile(inMemoryPath), readAtlasFile(streamedPath));
+}
+
+TEST(AtlasTest, StreamingRespectsMemoryBudget) {
+    // 10k glyphs: composing this distance field atlas in memory needs several times the budget
+    const size_t budget = size_t(2) << 20;
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(10000);
+    std::vector<Vec2<size_t>> rectSizes;
+    for (const auto& size : glyphSizes) {
+        rectSizes.push_back(size / 2);
+    }
+    Packing p = shelfPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+
+    const size_t streamedBound = streamedAtlasPeakBytes(p, glyphSizes, true);
+    EXPECT_GT(atlasPeakBytes(p, glyphSizes, true), 3 * budget);
+    ASSERT_LE(streamedBound, budget);
+
+#ifdef __linux__
+    // Reset the resident set high water mark, so that it only covers the streaming below.
+    bool peakReset = static_cast<bool>(std::ofstream("/proc/self/clear_refs") << "5");
+    const size_t residentBefore = procStatusBytes("VmRSS:");
+#endif
+
+    auto renderGlyph = [&glyphSizes](size_t i) { return syntheticGlyph(glyphSizes[i]); };
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.centerDownsampling<DistanceTransform::OutputType>(out); };
+    size_t trackedPeak = streamDistanceFieldAtlas(p, renderGlyph, dtFunc, downsampling,
+                                                  atlasTestDestinationPath + "dt_atlas_large.png", 10, -10);
+    EXPECT_LE(trackedPeak, streamedBound);
+
+#ifdef __linux__
+    // Allow 1 MiB for the PNG encoder and allocator overhead on top of the budget.
+    if (peakReset) {
+        EXPECT_LE(procStatusBytes("VmHWM:") - residentBefore, budget + (size_t(1) << 20));
+    }
+#endif
+}
+
+TEST(AtlasTest, IncrementalUpdateMatchesFullBuild) {
+    // the update drops the first 20 glyphs and adds 50 new ones
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(200);
+    std::vector<Vec2<size_t>> rectSizes;
+    for (const auto& size : glyphSizes) {
+        rectSizes.push_back(size / 2);
+    }
+    const size_t firstBegin = 0, firstEnd = 150, secondBegin = 20, secondEnd = 200;
+
+    Packing first = maxRectsPackAtlas(rectSizes.begin() + firstBegin, rectSizes.begin() + firstEnd,
+                                      Vec2<PackingSizeType>{256, 256}, false);
+    ASSERT_EQ(first.rects.size(), firstEnd - firstBegin);
+
+    AtlasManifest manifest;
+    manifest.settings.fontSize = 32;
+    manifest.settings.distanceTransform = "parabola";
+    manifest.atlasSize = first.atlasSize;
+    for (size_t i = 0; i < first.rects.size(); i++) {
+        manifest.glyphs.push_back({firstBegin + i, first.rects[i]});
+    }
+    std::string manifestPath = atlasTestDestinationPath + "dt_atlas_incremental.manifest";
+    manifest.save(manifestPath);
+    AtlasManifest loaded = AtlasManifest::load(manifestPath);
+    EXPECT_TRUE(loaded.settings == manifest.settings);
+    ASSERT_EQ(loaded.glyphs.size(), manifest.glyphs.size());
+
+    std::vector<unsigned long> charcodes;
+    for (size_t i = secondBegin; i < secondEnd; i++) {
+        charcodes.push_back(i);
+    }
+    IncrementalPacking update = incrementalPacking(
+        loaded, charcodes, {rectSizes.begin() + secondBegin, rectSizes.begin() + secondEnd});
+    ASSERT_EQ(update.packing.rects.size(), secondEnd - secondBegin);
+    EXPECT_EQ(std::count(update.reused.begin(), update.reused.end(), true), long(firstEnd - secondBegin));
+    EXPECT_EQ(update.staleRects.size(), secondBegin - firstBegin);
+    for (size_t i = 0; i < update.packing.rects.size(); i++) {
+        for (size_t j = i + 1; j < update.packing.rects.size(); j++) {
+            EXPECT_FALSE(update.packing.rects[i].overlaps(update.packing.rects[j]));
+        }
+    }
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+    auto renderFirst = [&](size_t i) { return syntheticGlyph(glyphSizes[firstBegin + i]); };
+    auto renderSecond = [&](size_t i) { return syntheticGlyph(glyphSizes[secondBegin + i]); };
+
+    // only the new glyphs are rendered
+    size_t rendered = 0;
+    auto renderNew = [&](size_t i) {
+        EXPECT_FALSE(update.reused[i]);
+        rendered++;
+        return renderSecond(i);
+    };
+
+    std::string incrementalPath = atlasTestDestinationPath + "dt_atlas_incremental.png";
+    std::string fullPath = atlasTestDestinationPath + "dt_atlas_full.png";
+    streamDistanceFieldAtlas(first, renderFirst, dtFunc, downsampling, incrementalPath, 10, -10);
+    Image atlas{incrementalPath, 16};
+    updateDistanceFieldAtlas(atlas, update, renderNew, dtFunc, downsampling, 10, -10);
+    atlas.exportPng<uint16_t>(incrementalPath);
+    EXPECT_EQ(rendered, secondEnd - firstEnd);
+
+    distanceFieldAtlas(update.packing, renderSecond, dtFunc, downsampling).exportPng<float>(fullPath, 10, -10);
+    EXPECT_EQ(readAtlasFile(fullPath), readAtlasFile(incrementalPath));
+
+    auto renderHalfFirst = [&](size_t i) { return syntheticGlyph(rectSizes[firstBegin + i]); };
+    auto renderHalfSecond = [&](size_t i) { return syntheticGlyph(rectSizes[secondBegin + i]); };
+    fontAtlas(first, renderHalfFirst).exportPng<uint8_t>(incrementalPath);
+    Image fontAtlasImage{incrementalPath, 1};
+    updateFontAtlas(fontAtlasImage, update, renderHalfSecond);
+    fontAtlasImage.exportPng<uint8_t>(incrementalPath);
+    fontAtlas(update.packing, renderHalfSecond).exportPng<uint8_t>(fullPath);
+    EXPECT_EQ(readAtlasFile(fullPath), readAtlasFile(incrementalPath));
+}
+
+TEST(AtlasTest, TileCacheReusesTiles) {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(100);
+    std::vector<Vec2<size_t>> rectSizes;
+    std::vector<uint32_t> glyphIndices;
+    for (size_t i = 0; i < glyphSizes.size(); i++) {
+        rectSizes.push_back(glyphSizes[i] / 2);
+        glyphIndices.push_back(uint32_t(i));
+    }
+    Packing p = maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+
+    size_t rendered = 0;
+    auto renderGlyph = [&](size_t i) {
+        rendered++;
+        return syntheticGlyph(glyphSizes[i]);
+    };
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+
+    AtlasSettings settings;
+    settings.fontHash = 0x1234;
+    settings.distanceTransform = "parabola";
+    settings.dynamicRangeMin = -10;
+    settings.dynamicRangeMax = 10;
+    std::string cacheDir = atlasTestDestinationPath + "tile_cache";
+    TileCache cache{cacheDir, settings};
+
+    std::string uncachedPath = atlasTestDestinationPath + "dt_atlas_uncached.png";
+    std::string cachedPath = atlasTestDestinationPath + "dt_atlas_cached.png";
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10).exportPng<uint16_t>(uncachedPath);
+    EXPECT_EQ(rendered, glyphSizes.size());
+
+    // the first run fills the cache, unless an earlier test run did, the second one renders nothing
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, &cache, glyphIndices);
+    rendered = 0;
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, &cache, glyphIndices)
+        .exportPng<uint16_t>(cachedPath);
+    EXPECT_EQ(rendered, 0u);
+    EXPECT_EQ(readAtlasFile(uncachedPath), readAtlasFile(cachedPath));
+
+    // streamed atlases share the tiles and produce the same file
+    streamDistanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, cachedPath, 10, -10, &cache, glyphIndices);
+    EXPECT_EQ(rendered, 0u);
+    EXPECT_EQ(readAtlasFile(uncachedPath), readAtlasFile(cachedPath));
+
+    // any change of the settings misses the cache
+    settings.dynamicRangeMax = 20;
+    TileCache otherCache{cacheDir, settings};
+    Image tile{rectSizes[0].x, rectSizes[0].y, 16};
+    EXPECT_TRUE(cache.load(0, tile));
+    EXPECT_FALSE(otherCache.load(0, tile));
+    Image otherSize{rectSizes[0].x + 1, rectSizes[0].y, 16};
+    EXPECT_FALSE(cache.load(0, otherSize));
+
+    // corrupt tiles are misses, even if their size field asks for gigabytes
+    std::string tileFile;
+    {
+        std::ifstream in(cache.tilePath(0), std::ios::binary);
+        tileFile.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GT(tileFile.size(), 12u);
+    const size_t keyLength = uint8_t(tileFile[8]) | uint8_t(tileFile[9]) << 8;
+    const size_t sizeOffset = 12 + keyLength + 8;
+    ASSERT_LT(sizeOffset + 4, tileFile.size());
+    for (const std::string& corrupt : {tileFile.substr(0, sizeOffset) + std::string(4, '\xf0') +
+                                           tileFile.substr(sizeOffset + 4),
+                                       tileFile.substr(0, tileFile.size() - 10)}) {
+        std::ofstream(cache.tilePath(0), std::ios::binary) << corrupt;
+        EXPECT_FALSE(cache.load(0, tile));
+    }
+    std::remove(cache.tilePath(0).c_str());
+}
+
+TEST(AtlasTest, TileMemoryReusesTiles) {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(50);
+    std::vector<Vec2<size_t>> rectSizes;
+    std::vector<uint32_t> glyphIndices;
+    size_t tileBytes = 0;
+    for (size_t i = 0; i < glyphSizes.size(); i++) {
+        rectSizes.push_back(glyphSizes[i] / 2);
+        glyphIndices.push_back(uint32_t(i));
+        tileBytes += rectSizes.back().x * rectSizes.back().y * 2;
+    }
+    Packing p = maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+
+    size_t rendered = 0;
+    auto renderGlyph = [&](size_t i) {
+        rendered++;
+        return syntheticGlyph(glyphSizes[i]);
+    };
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+
+    AtlasSettings settings;
+    settings.fontHash = 0x5678;
+    settings.distanceTransform = "parabola";
+    TileMemory memory{tileBytes};
+    TileCache cache{"", settings, &memory};
+
+    std::string uncachedPath = atlasTestDestinationPath + "dt_atlas_memory_uncached.png";
+    std::string cachedPath = atlasTestDestinationPath + "dt_atlas_memory_cached.png";
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, &cache, glyphIndices)
+        .exportPng<uint16_t>(uncachedPath);
+    EXPECT_EQ(rendered, glyphSizes.size());
+    EXPECT_EQ(memory.sizeBytes(), tileBytes);
+
+    rendered = 0;
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, &cache, glyphIndices)
+        .exportPng<uint16_t>(cachedPath);
+    EXPECT_EQ(rendered, 0u);
+    EXPECT_EQ(readAtlasFile(uncachedPath), readAtlasFile(cachedPath));
+
+    // a smaller memory drops the least recently used tiles
+    TileMemory smallMemory{tileBytes / 2};
+    TileCache smallCache{"", settings, &smallMemory};
+    distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, &smallCache, glyphIndices);
+    EXPECT_LE(smallMemory.sizeBytes(), tileBytes / 2);
+    size_t kept = 0;
+    for (size_t i = 0; i < rectSizes.size(); i++) {
+        Image tile{rectSizes[i].x, rectSizes[i].y, 16};
+        kept += smallCache.load(glyphIndices[i], tile) ? 1 : 0;
+    }
+    EXPECT_GT(kept, 0u);
+    EXPECT_LT(kept, rectSizes.size());
+}
+
+TEST(AtlasTest, PagesBuiltInParallelMatchSequential) {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(400);
+    std::vector<Vec2<size_t>> rectSizes;
+    for (const auto& size : glyphSizes) {
+        rectSizes.push_back(size / 2);
+    }
+    PagedPacking paged = maxRectsPackPages(rectSizes.begin(), rectSizes.end(), {128, 128}, false);
+    ASSERT_GT(paged.pageCount, 2u);
+
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+    auto pagePath = [](size_t page, unsigned int threadCount) {
+        return atlasTestDestinationPath + "dt_page_" + std::to_string(threadCount) + "_" + std::to_string(page) +
+               ".png";
+    };
+
+    for (unsigned int threadCount : {1u, 4u}) {
+        std::vector<size_t> builtPages(paged.pageCount, 0);
+        buildPages(paged,
+                   [&](size_t page, const Packing& packing, const std::vector<size_t>& rectIndices) {
+                       auto renderGlyph = [&](size_t i) { return syntheticGlyph(glyphSizes[rectIndices[i]]); };
+                       Image atlas = distanceFieldAtlas(packing, renderGlyph, dtFunc, downsampling, 10, -10);
+                       atlas.exportPng<uint16_t>(pagePath(page, threadCount));
+                       builtPages[page]++;
+                   },
+                   threadCount);
+        EXPECT_EQ(std::vector<size_t>(paged.pageCount, 1), builtPages);
+    }
+
+    for (size_t page = 0; page < paged.pageCount; page++) {
+        EXPECT_EQ(readAtlasFile(pagePath(page, 1)), readAtlasFile(pagePath(page, 4)));
+    }
+
+    // a failing page is reported after all threads finished
+    EXPECT_THROW(buildPages(paged,
+                            [](size_t page, const Packing&, const std::vector<size_t>&) {
+                                if (page == 1) {
+                                    throw std::runtime_error("page failed");
+                                }
+                            },
+                            4),
+                 std::runtime_error);
+}
+
+TEST(AtlasTest, PipelinedAtlasMatchesSequential) {
+    std::vector<Vec2<size_t>> glyphSizes = supersampledGlyphSizes(200);
+    std::vector<Vec2<size_t>> rectSizes;
+    for (const auto& size : glyphSizes) {
+        rectSizes.push_back(size / 2);
+    }
+    Packing p = maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), false);
+    auto renderGlyph = [&glyphSizes](size_t i) { return syntheticGlyph(glyphSizes[i]); };
+    auto dtFunc = [](Image& in, Image& out) { ParabolaEnvelope(in, out).transform(); };
+    auto downsampling = [](Image& in, Image& out) { in.averageDownsampling<DistanceTransform::OutputType>(out); };
+
+    // the streamed atlas is built one glyph at a time
+    std::string sequentialPath = atlasTestDestinationPath + "dt_atlas_sequential.png";
+    std::string pipelinedPath = atlasTestDestinationPath + "dt_atlas_pipelined.png";
+    streamDistanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, sequentialPath, 10, -10);
+
+    for (unsigned int transformThreads : {1u, 4u}) {
+        for (size_t queueDepth : {1u, 16u}) {
+            AtlasPipeline pipeline;
+            pipeline.transformThreads = transformThreads;
+            pipeline.queueDepth = queueDepth;
+            distanceFieldAtlas(p, renderGlyph, dtFunc, downsampling, 10, -10, nullptr, {}, pipeline)
+                .exportPng<uint16_t>(pipelinedPath);
+            EXPECT_EQ(readAtlasFile(sequentialPath), readAtlasFile(pipelinedPath));
+        }
+    }
+
+    // more glyphs in flight need more memory
+    AtlasPipeline narrow;
+    narrow.transformThreads = 1;
+    narrow.queueDepth = 1;
+    AtlasPipeline wide;
+    wide.transformThreads = 8;
+    wide.queueDepth = 32;
+    EXPECT_LT(atlasPeakBytes(p, glyphSizes, true, narrow), atlasPeakBytes(p, glyphSizes, true, wide));
+
+    // a failing glyph stops all stages and is reported on the calling thread
+    AtlasPipeline pipeline;
+    pipeline.transformThreads = 4;
+    pipeline.queueDepth = 4;
+    auto failingRenderer = [&glyphSizes](size_t i) {
+        if (i == 50) {
+            throw std::runtime_error("glyph failed");
+        }
+        return syntheticGlyph(glyphSizes[i]);
+    };
+    EXPECT_THROW(distanceFieldAtlas(p, failingRenderer, dtFunc, downsampling, 10, -10, nullptr, {}, pipeline),
+                 std::runtime_error);
+    auto failingTransform = [](Image& in, Image&) {
+        if (in.getWidth() > 30) {
+            throw std::runtime_error("transform failed");
+        }
+    };
+    EXPECT_THROW(distanceFieldAtlas(p, renderGlyph, failingTransform, downsampling, 10, -10, nullptr, {}, pipeline),
+                 std::runtime_error);
+}
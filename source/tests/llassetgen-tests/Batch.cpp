@@ -0,0 +1,114 @@
+#include <gmock/gmock.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <batch.h>
+
+std::string batchTestDestinationPath = "../../";
+
+using Args = std::vector<std::string>;
+
+std::vector<BatchJob> loadManifest(const std::string& fileName, const std::string& text) {
+    const std::string path = batchTestDestinationPath + fileName;
+    std::ofstream{path} << text;
+    std::vector<BatchJob> jobs;
+    try {
+        jobs = loadBatchManifest(path);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+    std::remove(path.c_str());
+    return jobs;
+}
+
+// The message of the error loading a JSON manifest, or an empty string if it loads.
+std::string jsonError(const std::string& text) {
+    try {
+        loadManifest("batch.json", text);
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST(BatchTest, IniJobsOverrideDefaults) {
+    std::vector<BatchJob> jobs = loadManifest("batch.ini",
+                                              "; defaults\n"
+                                              "fontpath = OpenSans-Regular.ttf\n"
+                                              "fnt = true\n"
+                                              "fontsize = 64\n"
+                                              "\n"
+                                              "[small]\n"
+                                              "fontsize = 32\n"
+                                              "ascii = true\n"
+                                              "outfile = \"small atlas.png\"\n"
+                                              "[large]\n"
+                                              "fnt = false\n"
+                                              "glyph = \"a b\" c\n"
+                                              "outfile = large.png\n");
+    ASSERT_EQ(2u, jobs.size());
+    EXPECT_EQ("small", jobs[0].name);
+    EXPECT_EQ((Args{"small atlas.png", "--fontpath", "OpenSans-Regular.ttf", "--fnt", "--fontsize", "32", "--ascii"}),
+              jobs[0].args);
+    EXPECT_EQ("large", jobs[1].name);
+    EXPECT_EQ((Args{"large.png", "--fontpath", "OpenSans-Regular.ttf", "--fontsize", "64", "--glyph", "a b", "c"}),
+              jobs[1].args);
+}
+
+TEST(BatchTest, JsonJobsOverrideDefaults) {
+    std::vector<BatchJob> jobs = loadManifest("batch.json", R"({
+        "defaults": {"fontpath": "OpenSans-Regular.ttf", "fnt": true, "fontsize": 64},
+        "jobs": {
+            "small": {"fontsize": 32, "ascii": true, "outfile": "small atlas.png"},
+            "large": {"fnt": false, "glyph": ["a b", "c"], "outfile": "large.png"}
+        }
+    })");
+    ASSERT_EQ(2u, jobs.size());
+    EXPECT_EQ("small", jobs[0].name);
+    EXPECT_EQ((Args{"small atlas.png", "--fontpath", "OpenSans-Regular.ttf", "--fnt", "--fontsize", "32", "--ascii"}),
+              jobs[0].args);
+    EXPECT_EQ("large", jobs[1].name);
+    EXPECT_EQ((Args{"large.png", "--fontpath", "OpenSans-Regular.ttf", "--fontsize", "64", "--glyph", "a b", "c"}),
+              jobs[1].args);
+}
+
+TEST(BatchTest, JsonEscapes) {
+    std::vector<BatchJob> jobs =
+        loadManifest("batch.json", R"({"jobs": {"a\u00e9\uD83D\ude00\t\"\/": {"outfile": "x.png"}}})");
+    ASSERT_EQ(1u, jobs.size());
+    EXPECT_EQ("a\xC3\xA9\xF0\x9F\x98\x80\t\"/", jobs[0].name);
+}
+
+TEST(BatchTest, JsonRejectsBadEscapes) {
+    const std::string prefix = R"({"jobs": {"a)";
+    const std::string suffix = R"(": {}}})";
+    const std::string offset = std::to_string(prefix.size() + 2);
+    EXPECT_EQ("invalid manifest at offset " + std::to_string(prefix.size() + 4) + ": four hex digits expected",
+              jsonError(prefix + R"(\u12)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + offset + ": four hex digits expected",
+              jsonError(prefix + R"(\u-123)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + std::to_string(prefix.size() + 3) + ": four hex digits expected",
+              jsonError(prefix + R"(\u0+12)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + std::to_string(prefix.size() + 1) + ": invalid escape sequence",
+              jsonError(prefix + R"(\x)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + offset + ": unpaired low surrogate",
+              jsonError(prefix + R"(\ude00)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + std::to_string(prefix.size() + 6) + ": unpaired high surrogate",
+              jsonError(prefix + R"(\ud83dA)" + suffix));
+    EXPECT_EQ("invalid manifest at offset " + std::to_string(prefix.size() + 8) + ": invalid low surrogate",
+              jsonError(prefix + R"(\ud83d\u0041)" + suffix));
+}
+
+TEST(BatchTest, RejectsMalformedManifests) {
+    EXPECT_EQ("invalid manifest at offset 8: ':' expected", jsonError(R"({"jobs" {}})"));
+    EXPECT_EQ("unknown key \"job\" in the manifest", jsonError(R"({"job": {}})"));
+    EXPECT_EQ("invalid manifest at offset 13: trailing characters", jsonError(R"({"jobs": {}} x)"));
+    EXPECT_THROW(loadManifest("batch.json", R"({"jobs": {}})"), std::runtime_error);
+    EXPECT_THROW(loadManifest("batch.ini", "[job]\nascii\n"), std::runtime_error);
+    EXPECT_THROW(loadBatchManifest(batchTestDestinationPath + "missing.ini"), std::runtime_error);
+}
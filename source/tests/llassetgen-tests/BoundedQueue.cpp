@@ -0,0 +1,84 @@
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <llassetgen/BoundedQueue.h>
+
+
+using namespace llassetgen;
+
+
+TEST(BoundedQueueTest, KeepsOrderAndCapacity) {
+    BoundedQueue<int> queue{3};
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT_EQ(BoundedQueue<int>{1}.capacity(), 2u);
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    int value = 4;
+    EXPECT_FALSE(queue.tryPush(value));
+    EXPECT_EQ(value, 4);
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+
+    // wrapping around reuses the slots
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(queue.tryPush(i));
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+}
+
+TEST(BoundedQueueTest, DeliversEveryElementOnceAcrossThreads) {
+    const int producerCount = 4, consumerCount = 3, perProducer = 20000;
+    BoundedQueue<int> queue{8};
+    std::atomic<int> producersLeft{producerCount};
+    std::vector<std::vector<int>> received(consumerCount);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producerCount; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                int value = p * perProducer + i;
+                ASSERT_TRUE(queue.push(value));
+            }
+            if (--producersLeft == 0) {
+                queue.close();
+            }
+        });
+    }
+    for (int c = 0; c < consumerCount; c++) {
+        threads.emplace_back([&, c]() {
+            int value;
+            while (queue.pop(value)) {
+                received[c].push_back(value);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> seen(producerCount * perProducer, 0);
+    for (const auto& values : received) {
+        // every producer's elements arrive in the order they were pushed
+        std::vector<int> last(producerCount, -1);
+        for (int value : values) {
+            seen[value]++;
+            EXPECT_GT(value, last[value / perProducer]);
+            last[value / perProducer] = value;
+        }
+    }
+    EXPECT_EQ(seen, std::vector<int>(producerCount * perProducer, 1));
+
+    // a closed queue takes no more elements
+    int value = 1;
+    EXPECT_FALSE(queue.push(value));
+}
@@ -0,0 +1,138 @@
+#include <gmock/gmock.h>
+
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include <llassetgen/llassetgen.h>
+#include <llassetgen/BundleReader.h>
+#include <llassetgen/BundleWriter.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/packing/Algorithms.h>
+
+using namespace llassetgen;
+
+std::string bundleTestSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+std::string bundleTestDestinationPath = "../../";
+
+// File contents in 8 byte aligned memory, as a mapping would provide them.
+std::vector<uint64_t> readBundle(const std::string& path, size_t& size) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size = bytes.size();
+    std::vector<uint64_t> aligned((size + 7) / 8);
+    std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(aligned.data()));
+    return aligned;
+}
+
+TEST(BundleTest, LookupAllGlyphs) {
+    init();
+
+    FontFinder fontFinder = FontFinder::fromPath(bundleTestSourcePath + "OpenSans-Regular.ttf");
+    std::set<unsigned long> glyphs;
+    for (unsigned long glyph : fontFinder.allGlyphs()) {
+        if (glyph != ' ' && glyph != 0xA0) {
+            glyphs.insert(glyph);
+        }
+    }
+    std::vector<GlyphRecord> records;
+    for (const auto& record : fontFinder.glyphRecords(glyphs, 32, 2, 1)) {
+        records.push_back(record);
+    }
+    std::vector<Vec2<size_t>> sizes;
+    for (const auto& record : records) {
+        sizes.push_back(record.size);
+    }
+    Packing packing = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    BundleWriter writer{fontFinder.fontFace, 32};
+    writer.setGlyphs(records, packing, 2, 1);
+    writer.saveBundle(bundleTestDestinationPath + "bundle.llfb");
+
+    size_t size;
+    std::vector<uint64_t> data = readBundle(bundleTestDestinationPath + "bundle.llfb", size);
+    BundleReader reader{data.data(), size};
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_EQ(reader.info().glyphCount, records.size());
+    EXPECT_EQ(reader.info().atlasWidth, packing.atlasSize.x);
+    EXPECT_EQ(reader.atlasPixels(), nullptr);
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const bundle::Glyph* glyph = reader.findGlyph(static_cast<uint32_t>(records[i].charcode));
+        ASSERT_NE(glyph, nullptr) << records[i].charcode;
+        EXPECT_EQ(glyph->codepoint, records[i].charcode);
+        EXPECT_EQ(glyph->gindex, records[i].gindex);
+        EXPECT_EQ(glyph->x, packing.rects[i].position.x);
+        EXPECT_EQ(glyph->y, packing.rects[i].position.y);
+        EXPECT_EQ(glyph->width, packing.rects[i].size.x);
+        EXPECT_EQ(glyph->height, packing.rects[i].size.y);
+        EXPECT_FLOAT_EQ(glyph->xAdvance, float(records[i].linearHoriAdvance) / 65536.f);
+    }
+    EXPECT_EQ(reader.findGlyph(' '), nullptr);
+    EXPECT_EQ(reader.findGlyph(0x10FFFF), nullptr);
+
+    // glyphs are sorted by codepoint
+    for (size_t i = 1; i < reader.info().glyphCount; i++) {
+        EXPECT_LT(reader.glyphs()[i - 1].codepoint, reader.glyphs()[i].codepoint);
+    }
+
+    EXPECT_GT(reader.info().kerningCount, 0u);
+    EXPECT_LT(reader.kerning('A', 'V'), 0.f);
+    EXPECT_EQ(reader.kerning('A', 'A'), 0.f);
+}
+
+TEST(BundleTest, RejectsDuplicateCodepoints) {
+    init();
+
+    FontFinder fontFinder = FontFinder::fromPath(bundleTestSourcePath + "OpenSans-Regular.ttf");
+    std::vector<GlyphRecord> records = fontFinder.glyphRecords({'a', 'b'}, 16);
+    records.push_back(records[0]);
+    std::vector<Vec2<size_t>> sizes;
+    for (const auto& record : records) {
+        sizes.push_back(record.size);
+    }
+    Packing packing = shelfPackAtlas(sizes.begin(), sizes.end(), false);
+
+    BundleWriter writer{fontFinder.fontFace, 16};
+    EXPECT_THROW(writer.setGlyphs(records, packing), std::runtime_error);
+}
+
+TEST(BundleTest, AtlasPixels) {
+    init();
+
+    FontFinder fontFinder = FontFinder::fromPath(bundleTestSourcePath + "OpenSans-Regular.ttf");
+    std::set<unsigned long> glyphs = {'x'};
+    std::vector<GlyphRecord> records = fontFinder.glyphRecords(glyphs, 16);
+
+    Image atlas{records[0].size.x, records[0].size.y, 16};
+    for (size_t y = 0; y < atlas.getHeight(); y++) {
+        for (size_t x = 0; x < atlas.getWidth(); x++) {
+            atlas.setPixel<uint16_t>({x, y}, static_cast<uint16_t>(x * 1000 + y));
+        }
+    }
+    Packing packing;
+    packing.atlasSize = atlas.getSize();
+    packing.rects.push_back({{0, 0}, atlas.getSize()});
+
+    BundleWriter writer{fontFinder.fontFace, 16};
+    writer.setGlyphs(records, packing);
+    writer.setAtlas(atlas);
+    writer.saveBundle(bundleTestDestinationPath + "bundle_pixels.llfb");
+
+    size_t size;
+    std::vector<uint64_t> data = readBundle(bundleTestDestinationPath + "bundle_pixels.llfb", size);
+    BundleReader reader{data.data(), size};
+    ASSERT_TRUE(reader.isValid());
+    ASSERT_EQ(reader.info().atlasBitDepth, 16u);
+    const uint16_t* pixels = static_cast<const uint16_t*>(reader.atlasPixels());
+    ASSERT_NE(pixels, nullptr);
+    for (size_t y = 0; y < atlas.getHeight(); y++) {
+        for (size_t x = 0; x < atlas.getWidth(); x++) {
+            EXPECT_EQ(pixels[y * atlas.getWidth() + x], x * 1000 + y);
+        }
+    }
+
+    // truncated files are rejected
+    EXPECT_FALSE(BundleReader(data.data(), size - 1).isValid());
+}
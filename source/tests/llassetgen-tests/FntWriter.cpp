@@ -3,9 +3,18 @@
 
 #include <gmock/gmock.h>
 #include <llassetgen/llassetgen.h>
+#include <llassetgen/FntReader.h>
 #include <llassetgen/FntWriter.h>
+#include <llassetgen/Kerning.h>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace llassetgen;
 
@@ -112,3 +121,400 @@ TEST(FntWriterTest, fntScaling) {
 
 	writer.saveFnt(testDestinationPath + "fnt_scaled.fnt");
 }
+
+std::vector<FT_UInt> allGlyphIndices(FT_Face face) {
+	std::vector<FT_UInt> gindices;
+	FT_UInt gindex;
+	FT_ULong charcode = FT_Get_First_Char(face, &gindex);
+	while (gindex != 0) {
+		gindices.push_back(gindex);
+		charcode = FT_Get_Next_Char(face, charcode, &gindex);
+	}
+	return gindices;
+}
+
+TEST(FntWriterTest, kerningPairsMatchFreeType) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+
+	init();
+
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "OpenSans-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+
+	std::vector<FT_UInt> gindices = allGlyphIndices(face);
+	std::set<FT_UInt> unique(gindices.begin(), gindices.end());
+
+	std::vector<KerningPair> expected;
+	for (FT_UInt left : unique) {
+		for (FT_UInt right : unique) {
+			FT_Vector kerningVector;
+			FT_Get_Kerning(face, left, right, FT_KERNING_UNSCALED, &kerningVector);
+			if (kerningVector.x != 0) {
+				expected.push_back({left, right, kerningVector.x});
+			}
+		}
+	}
+
+	std::vector<KerningPair> pairs = kerningPairs(face, gindices);
+	EXPECT_FALSE(pairs.empty());
+	ASSERT_EQ(pairs.size(), expected.size());
+	for (size_t i = 0; i < pairs.size(); i++) {
+		EXPECT_EQ(pairs[i].left, expected[i].left);
+		EXPECT_EQ(pairs[i].right, expected[i].right);
+		EXPECT_EQ(pairs[i].amount, expected[i].amount);
+	}
+
+	FT_Done_Face(face);
+}
+
+TEST(FntWriterTest, kernSubtablesSkippedLikeFreeType) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+
+	init();
+
+	std::ifstream file(testSourcePath + "OpenSans-Regular.ttf", std::ios::binary);
+	std::vector<FT_Byte> font{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	auto u16 = [&font](size_t offset) { return size_t(font[offset]) << 8 | font[offset + 1]; };
+	auto u32 = [&](size_t offset) { return u16(offset) << 16 | u16(offset + 2); };
+	size_t kernOffset = 0;
+	for (size_t table = 0; table < u16(4); table++) {
+		if (std::string(font.begin() + 12 + 16 * table, font.begin() + 16 + 16 * table) == "kern") {
+			kernOffset = u32(20 + 16 * table);
+		}
+	}
+	ASSERT_NE(kernOffset, 0u);
+
+	// the single format 0 subtable, flagged as minimum values, cross-stream or overriding
+	for (FT_Byte coverage : {0x03, 0x05, 0x09}) {
+		font[kernOffset + 9] = coverage;
+		FT_Face face;
+		ASSERT_EQ(FT_New_Memory_Face(freetype, font.data(), FT_Long(font.size()), 0, &face), 0);
+
+		FT_UInt a = FT_Get_Char_Index(face, 'A');
+		FT_UInt v = FT_Get_Char_Index(face, 'V');
+		FT_UInt t = FT_Get_Char_Index(face, 'T');
+		FT_UInt o = FT_Get_Char_Index(face, 'o');
+		std::vector<KerningPair> expected;
+		for (FT_UInt left : {a, v, t, o}) {
+			for (FT_UInt right : {a, v, t, o}) {
+				FT_Vector kerningVector;
+				FT_Get_Kerning(face, left, right, FT_KERNING_UNSCALED, &kerningVector);
+				if (kerningVector.x != 0) {
+					expected.push_back({left, right, kerningVector.x});
+				}
+			}
+		}
+		// FreeType keeps the cross-stream subtable, but not the one of minimum values
+		EXPECT_EQ(expected.empty(), coverage == 0x03) << int(coverage);
+		std::sort(expected.begin(), expected.end(), [](const KerningPair& p1, const KerningPair& p2) {
+			return std::make_pair(p1.left, p1.right) < std::make_pair(p2.left, p2.right);
+		});
+
+		std::vector<KerningPair> pairs = kerningPairs(face, {a, v, t, o});
+		ASSERT_EQ(pairs.size(), expected.size());
+		for (size_t i = 0; i < pairs.size(); i++) {
+			EXPECT_EQ(pairs[i].left, expected[i].left);
+			EXPECT_EQ(pairs[i].right, expected[i].right);
+			EXPECT_EQ(pairs[i].amount, expected[i].amount);
+		}
+		FT_Done_Face(face);
+	}
+}
+
+TEST(FntWriterTest, gposKerningPairs) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+
+	init();
+
+	// SourceSansPro has no kern table, only pair adjustments in GPOS
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "SourceSansPro-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+
+	FT_UInt a = FT_Get_Char_Index(face, 'A');
+	FT_UInt v = FT_Get_Char_Index(face, 'V');
+	FT_UInt t = FT_Get_Char_Index(face, 'T');
+	FT_UInt o = FT_Get_Char_Index(face, 'o');
+	std::vector<KerningPair> pairs = kerningPairs(face, {a, v, t, o});
+	auto amount = [&pairs](FT_UInt left, FT_UInt right) {
+		for (const auto& pair : pairs) {
+			if (pair.left == left && pair.right == right) {
+				return pair.amount;
+			}
+		}
+		return FT_Pos(0);
+	};
+	EXPECT_LT(amount(a, v), 0);
+	EXPECT_LT(amount(v, a), 0);
+	EXPECT_LT(amount(t, o), 0);
+
+	// restricting the glyph set only drops the pairs outside of it
+	std::vector<KerningPair> allPairs = kerningPairs(face, allGlyphIndices(face));
+	std::set<FT_UInt> subset = {a, v, t, o};
+	std::vector<KerningPair> filtered;
+	for (const auto& pair : allPairs) {
+		EXPECT_NE(pair.amount, 0);
+		if (subset.count(pair.left) && subset.count(pair.right)) {
+			filtered.push_back(pair);
+		}
+	}
+	ASSERT_EQ(filtered.size(), pairs.size());
+	for (size_t i = 0; i < pairs.size(); i++) {
+		EXPECT_EQ(filtered[i].left, pairs[i].left);
+		EXPECT_EQ(filtered[i].right, pairs[i].right);
+		EXPECT_EQ(filtered[i].amount, pairs[i].amount);
+	}
+
+	FT_Done_Face(face);
+}
+
+TEST(FntWriterTest, binaryFntBlocks) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+	std::string testDestinationPath = "../../";
+
+	init();
+
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "OpenSans-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+	FT_Set_Pixel_Sizes(face, 0, 32);
+
+	FntWriter writer = FntWriter(face, "atlas.png", 32, 1.0f, false);
+	std::set<FT_ULong> charcodes = {'A', 'T', 'V', 'o'};
+	writer.readFont(charcodes.begin(), charcodes.end());
+	Vec2<PackingSizeType> position = { 3, 4 };
+	for (FT_ULong charcode : charcodes) {
+		writer.setCharInfo(FT_Get_Char_Index(face, charcode), Rect<PackingSizeType>(position, { 10, 20 }), { -1.0f, 2.0f });
+		position += {10, 0};
+	}
+	writer.setAtlasProperties({ 100, 200 }, 32, 2);
+	writer.saveFnt(testDestinationPath + "fnt_binary.fnt", FntFormat::Binary);
+
+	std::ifstream file(testDestinationPath + "fnt_binary.fnt", std::ios::binary);
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	ASSERT_GE(data.size(), 4u);
+	EXPECT_EQ(std::string(data.begin(), data.begin() + 3), "BMF");
+	EXPECT_EQ(data[3], 3);
+
+	auto readUint = [&data](size_t offset, size_t bytes) {
+		uint32_t value = 0;
+		for (size_t i = 0; i < bytes; i++) {
+			value |= uint32_t(data[offset + i]) << (8 * i);
+		}
+		return value;
+	};
+
+	// blocks follow each other in order of their types
+	std::map<int, std::pair<size_t, size_t>> blocks;
+	size_t offset = 4;
+	while (offset + 5 <= data.size()) {
+		int type = data[offset];
+		size_t size = readUint(offset + 1, 4);
+		blocks[type] = { offset + 5, size };
+		offset += 5 + size;
+	}
+	EXPECT_EQ(offset, data.size());
+	ASSERT_EQ(blocks.size(), 5u);
+
+	size_t info = blocks[1].first;
+	EXPECT_EQ(readUint(info, 2), 32u);
+	EXPECT_EQ(data[info + 7], 2);  // padding
+	EXPECT_EQ(std::string(reinterpret_cast<const char*>(&data[info + 14])), "Open Sans Regular");
+
+	size_t common = blocks[2].first;
+	EXPECT_EQ(blocks[2].second, 15u);
+	EXPECT_EQ(readUint(common, 2), 32u);
+	EXPECT_EQ(readUint(common + 4, 2), 100u);
+	EXPECT_EQ(readUint(common + 6, 2), 200u);
+	EXPECT_EQ(readUint(common + 8, 2), 1u);
+
+	EXPECT_EQ(std::string(reinterpret_cast<const char*>(&data[blocks[3].first])), "atlas.png");
+
+	ASSERT_EQ(blocks[4].second, 20 * charcodes.size());
+	size_t chars = blocks[4].first;
+	EXPECT_EQ(readUint(chars, 4), FT_Get_Char_Index(face, 'A'));
+	EXPECT_EQ(readUint(chars + 4, 2), 3u);
+	EXPECT_EQ(readUint(chars + 6, 2), 4u);
+	EXPECT_EQ(readUint(chars + 8, 2), 10u);
+	EXPECT_EQ(readUint(chars + 10, 2), 20u);
+	EXPECT_EQ(int16_t(readUint(chars + 12, 2)), -1);
+	EXPECT_EQ(int16_t(readUint(chars + 14, 2)), 2);
+	EXPECT_EQ(readUint(chars + 20 + 4, 2), 13u);
+
+	// 'A' and 'V' kern in both directions, among others
+	EXPECT_EQ(blocks[5].second % 10, 0u);
+	EXPECT_GE(blocks[5].second / 10, 2u);
+	size_t kernings = blocks[5].first;
+	EXPECT_LT(int16_t(readUint(kernings + 8, 2)), 0);
+
+	FT_Done_Face(face);
+}
+
+size_t countOccurrences(const std::string& text, const std::string& pattern) {
+	size_t count = 0;
+	for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+		count++;
+	}
+	return count;
+}
+
+TEST(FntWriterTest, xmlAndJsonFnt) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+	std::string testDestinationPath = "../../";
+
+	init();
+
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "OpenSans-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+	FT_Set_Pixel_Sizes(face, 0, 32);
+
+	FntWriter writer = FntWriter(face, "atlas \"1\".png", 32, 0.5f, true);
+	std::set<FT_ULong> charcodes = {'A', 'T', 'V', 'o', 'y'};
+	writer.readFont(charcodes.begin(), charcodes.end());
+	for (FT_ULong charcode : charcodes) {
+		writer.setCharInfo(FT_Get_Char_Index(face, charcode), Rect<PackingSizeType>({ 1, 2 }, { 15, 7 }), { 0.25f, -1.5f });
+	}
+	writer.setAtlasProperties({ 100, 200 }, 32, 2);
+
+	auto readFile = [](const std::string& path) {
+		std::ifstream file(path);
+		return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	};
+
+	writer.saveFnt(testDestinationPath + "fnt.xml", FntFormat::Xml);
+	std::string xml = readFile(testDestinationPath + "fnt.xml");
+	EXPECT_EQ(xml.find("<?xml version=\"1.0\"?>\n<font>\n"), 0u);
+	EXPECT_NE(xml.find("<chars count=\"5\">"), std::string::npos);
+	EXPECT_EQ(countOccurrences(xml, "<char "), 5u);
+	EXPECT_NE(xml.find("file=\"atlas &quot;1&quot;.png\""), std::string::npos);
+	EXPECT_NE(xml.find("width=\"7.5\" height=\"3.5\" xoffset=\"0.25\" yoffset=\"-1.5\""), std::string::npos);
+	EXPECT_NE(xml.find("scaleW=\"50\""), std::string::npos);
+	EXPECT_EQ(xml.substr(xml.size() - 8), "</font>\n");
+
+	writer.saveFnt(testDestinationPath + "fnt.json", FntFormat::Json);
+	std::string json = readFile(testDestinationPath + "fnt.json");
+	EXPECT_EQ(json.find("{\"pages\":[\"atlas \\\"1\\\".png\"]"), 0u);
+	EXPECT_EQ(countOccurrences(json, "{\"id\":"), 5u);
+	EXPECT_EQ(countOccurrences(json, "{\"first\":"), countOccurrences(xml, "<kerning "));
+	EXPECT_GT(countOccurrences(json, "{\"first\":"), 0u);
+	EXPECT_NE(json.find("\"width\":7.5,\"height\":3.5,\"xoffset\":0.25,\"yoffset\":-1.5"), std::string::npos);
+
+	FT_Done_Face(face);
+}
+
+TEST(FntWriterTest, readWrittenFnt) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+	std::string testDestinationPath = "../../";
+
+	init();
+
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "OpenSans-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+	FT_Set_Pixel_Sizes(face, 0, 32);
+
+	// a large synthetic glyph set, written without loading glyphs
+	const size_t glyphCount = 50000;
+	std::vector<GlyphRecord> records(glyphCount);
+	Packing packing;
+	packing.atlasSize = { 4096, 4096 };
+	for (size_t i = 0; i < glyphCount; i++) {
+		records[i].gindex = FT_UInt(i % 900);
+		records[i].linearHoriAdvance = FT_Fixed(i % 40) << 16;
+		records[i].vertBearingY = 1000;
+		packing.rects.push_back({ { (i % 200) * 20, (i / 200) * 16 }, { 3 + i % 17, 4 + i % 11 } });
+	}
+
+	FntWriter writer = FntWriter(face, "atlas.png", 32, 1.0f, false);
+	writer.readFont(std::vector<GlyphRecord>(records.begin(), records.begin() + 100));
+	writer.setAtlasProperties(packing.atlasSize, 32, 3);
+	writer.setPageFiles({ "atlas_0.png", "atlas_1.png" });
+	for (size_t i = 0; i < glyphCount; i++) {
+		writer.setCharInfo(records[i], packing.rects[i], { -1.5f, float(i % 7) }, int(i % 2));
+	}
+
+	for (FntFormat format : { FntFormat::Text, FntFormat::Binary }) {
+		std::string path = testDestinationPath + (format == FntFormat::Text ? "fnt_read.fnt" : "fnt_read_binary.fnt");
+		writer.saveFnt(path, format);
+
+		FntReader reader(path);
+		EXPECT_EQ(reader.format(), format);
+		EXPECT_EQ(reader.info().face, "Open Sans Regular");
+		EXPECT_EQ(reader.info().size, 32);
+		EXPECT_TRUE(reader.info().useUnicode);
+		EXPECT_EQ(reader.common().padding.left, 3.f);
+		EXPECT_EQ(reader.common().lineHeight, 32);
+		EXPECT_EQ(reader.common().base, 1000);
+		EXPECT_EQ(reader.common().pages, 2);
+		ASSERT_EQ(reader.pages().size(), 2u);
+		EXPECT_EQ(reader.pages()[0], "atlas_0.png");
+		EXPECT_EQ(reader.pages()[1], "atlas_1.png");
+
+		ASSERT_EQ(reader.chars().size(), glyphCount);
+		for (size_t i = 0; i < glyphCount; i += 997) {
+			const CharInfo& charInfo = reader.chars()[i];
+			EXPECT_EQ(charInfo.id, int(records[i].gindex));
+			EXPECT_EQ(charInfo.xAdvance, float(i % 40));
+			EXPECT_EQ(charInfo.yOffset, float(i % 7));
+			EXPECT_EQ(charInfo.page, int(i % 2));
+			EXPECT_EQ(charInfo.chnl, 15);
+		}
+		// the binary format only holds whole pixels
+		EXPECT_EQ(reader.chars()[0].xOffset, format == FntFormat::Text ? -1.5f : -2.f);
+
+		Packing readPacking = reader.packing();
+		EXPECT_EQ(readPacking.atlasSize, packing.atlasSize);
+		ASSERT_EQ(readPacking.rects.size(), packing.rects.size());
+		for (size_t i = 0; i < glyphCount; i++) {
+			ASSERT_EQ(readPacking.rects[i].position, packing.rects[i].position);
+			ASSERT_EQ(readPacking.rects[i].size, packing.rects[i].size);
+		}
+
+		EXPECT_GT(reader.kernings().size(), 0u);
+	}
+
+	FT_Done_Face(face);
+}
+
+TEST(FntWriterTest, binaryFntLargeIds) {
+	std::string testSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+	std::string testDestinationPath = "../../";
+
+	init();
+
+	FT_Face face;
+	FT_Error faceCreated = FT_New_Face(freetype, (testSourcePath + "OpenSans-Regular.ttf").c_str(), 0, &face);
+	ASSERT_EQ(faceCreated, 0);
+	FT_Set_Pixel_Sizes(face, 0, 32);
+
+	// ids beyond the range of 16 bit fields, which the 32 bit id fields must not clamp
+	const std::vector<FT_UInt> ids{ 40000, 70000, 0x10FFFF };
+	FntWriter writer = FntWriter(face, "atlas.png", 32, 1.0f, false);
+	writer.setAtlasProperties({ 64, 64 }, 32, 0);
+	for (size_t i = 0; i < ids.size(); i++) {
+		GlyphRecord record{};
+		record.gindex = ids[i];
+		writer.setCharInfo(record, { { i * 8, 0 }, { 8, 8 } }, { 0, 0 });
+	}
+	writer.saveFnt(testDestinationPath + "fnt_large_ids.fnt", FntFormat::Binary);
+
+	FntReader reader(testDestinationPath + "fnt_large_ids.fnt");
+	ASSERT_EQ(reader.chars().size(), ids.size());
+	for (size_t i = 0; i < ids.size(); i++) {
+		EXPECT_EQ(reader.chars()[i].id, int(ids[i]));
+	}
+
+	FT_Done_Face(face);
+}
+
+TEST(FntWriterTest, readRejectsOtherFormats) {
+	std::string testDestinationPath = "../../";
+
+	std::ofstream(testDestinationPath + "fnt_other.xml") << "<?xml version=\"1.0\"?>\n<font>\n</font>\n";
+	EXPECT_THROW(FntReader(testDestinationPath + "fnt_other.xml"), std::runtime_error);
+	std::ofstream(testDestinationPath + "fnt_broken.fnt") << "info face=\"unterminated\n";
+	EXPECT_THROW(FntReader(testDestinationPath + "fnt_broken.fnt"), std::runtime_error);
+	EXPECT_THROW(FntReader(testDestinationPath + "does-not-exist.fnt"), std::runtime_error);
+}
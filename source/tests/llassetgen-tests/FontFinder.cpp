@@ -0,0 +1,101 @@
+#include <gmock/gmock.h>
+
+#include <llassetgen/llassetgen.h>
+#include <llassetgen/FontFinder.h>
+#include <llassetgen/FontSource.h>
+
+using namespace llassetgen;
+
+std::string fontFinderTestSourcePath = "../../../source/tests/llassetgen-tests/testfiles/";
+
+TEST(FontFinderTest, SharedFontSource) {
+    init();
+
+    std::string fontFile = fontFinderTestSourcePath + "OpenSans-Regular.ttf";
+    FontFinder first = FontFinder::fromPath(fontFile);
+    FontFinder second = FontFinder::fromPath(fontFile);
+
+    // both faces are opened on the same mapping of the font file
+    EXPECT_EQ(first.source, second.source);
+    EXPECT_NE(first.fontFace, second.fontFace);
+    EXPECT_GT(first.source->size(), 0u);
+
+    first.setFontSize(32);
+    second.setFontSize(64);
+    Image small = first.renderGlyph('A', 0, 1);
+    Image large = second.renderGlyph('A', 0, 1);
+    EXPECT_LT(small.getWidth(), large.getWidth());
+    EXPECT_LT(small.getHeight(), large.getHeight());
+}
+
+TEST(FontFinderTest, FontSourceFromMemory) {
+    init();
+
+    std::shared_ptr<const FontSource> file = FontSource::fromFile(fontFinderTestSourcePath + "SourceSansPro-Regular.ttf");
+    std::vector<FT_Byte> data(file->data(), file->data() + file->size());
+    FontFinder fontFinder = FontFinder::fromSource(FontSource::fromMemory(std::move(data)));
+
+    fontFinder.setFontSize(32);
+    Image glyph = fontFinder.renderGlyph('J', 0, 1);
+    EXPECT_GT(glyph.getWidth(), 0u);
+}
+
+TEST(FontFinderTest, MissingFontFile) {
+    init();
+
+    EXPECT_THROW(FontFinder::fromPath(fontFinderTestSourcePath + "missing.ttf"), std::runtime_error);
+}
+
+TEST(FontFinderTest, GlyphSizeMatchesRendering) {
+    init();
+
+    for (const std::string fontName : {"OpenSans-Regular.ttf", "SourceSansPro-Regular.ttf"}) {
+        FontFinder fontFinder = FontFinder::fromPath(fontFinderTestSourcePath + fontName);
+        for (int size : {12, 37, 128}) {
+            fontFinder.setFontSize(size);
+
+            FT_UInt gindex;
+            for (FT_ULong charcode = FT_Get_First_Char(fontFinder.fontFace, &gindex); gindex != 0;
+                 charcode = FT_Get_Next_Char(fontFinder.fontFace, charcode, &gindex)) {
+                Vec2<size_t> predicted;
+                try {
+                    predicted = fontFinder.glyphSize(charcode, 3, 4);
+                } catch (const std::runtime_error&) {
+                    // glyphs without outline, like spaces, can not be rendered either
+                    EXPECT_THROW(fontFinder.renderGlyph(charcode, 3, 4), std::runtime_error);
+                    continue;
+                }
+                EXPECT_EQ(predicted, fontFinder.renderGlyph(charcode, 3, 4).getSize())
+                    << fontName << " size " << size << " charcode " << charcode;
+            }
+        }
+    }
+}
+
+TEST(FontFinderTest, GlyphRecordMatchesGlyphLoads) {
+    init();
+
+    FontFinder fontFinder = FontFinder::fromPath(fontFinderTestSourcePath + "OpenSans-Regular.ttf");
+    std::set<unsigned long> glyphs = {'A', 'g', 'j', '.', 0x20AC};
+    std::vector<GlyphRecord> records = fontFinder.glyphRecords(glyphs, 40, 2, 1);
+    ASSERT_EQ(records.size(), glyphs.size());
+
+    auto record = records.begin();
+    for (unsigned long glyph : glyphs) {
+        EXPECT_EQ(record->charcode, glyph);
+        EXPECT_EQ(record->gindex, FT_Get_Char_Index(fontFinder.fontFace, glyph));
+
+        // the metrics the FNT writer used to load separately
+        FT_Load_Glyph(fontFinder.fontFace, record->gindex, FT_LOAD_DEFAULT);
+        EXPECT_EQ(record->linearHoriAdvance, fontFinder.fontFace->glyph->linearHoriAdvance);
+        EXPECT_EQ(record->vertBearingY, fontFinder.fontFace->glyph->metrics.vertBearingY);
+
+        // bounds of the bitmap rendering produces
+        FT_Load_Glyph(fontFinder.fontFace, record->gindex, FT_LOAD_RENDER | FT_LOAD_TARGET_MONO);
+        const FT_GlyphSlot slot = fontFinder.fontFace->glyph;
+        EXPECT_EQ(record->bitmapOrigin, Vec2<FT_Int>(slot->bitmap_left, slot->bitmap_top));
+        EXPECT_EQ(record->bitmapSize, Vec2<size_t>(slot->bitmap.width, slot->bitmap.rows));
+        EXPECT_EQ(record->size, fontFinder.renderGlyph(*record, 2, 1).getSize());
+        ++record;
+    }
+}
@@ -1,10 +1,19 @@
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <limits>
 #include <numeric>
+#include <random>
 
 #include <llassetgen/llassetgen.h>
 #include <llassetgen/packing/Types.h>
 #include <llassetgen/packing/Algorithms.h>
+#include <llassetgen/packing/AtlasAllocator.h>
+#include <llassetgen/packing/SizeSearch.h>
+#include <llassetgen/packing/internal/CompactRects.h>
+#include <llassetgen/packing/internal/MaxRectsPacker.h>
+
+#include "GlyphSizes.h"
 
 
 using llassetgen::Packing;
@@ -147,6 +156,150 @@ class ShelfNextFitPackingTest : public PackingTest {
     }
 };
 
+/**
+ * Max rects packer that searches the whole free list for each rect, without
+ * any index. Kept as a reference for the placements of MaxRectsPacker.
+ */
+class LinearMaxRectsPacker {
+   public:
+    LinearMaxRectsPacker(Vec initialAtlasSize, bool _allowRotations, bool _allowGrowth)
+        : atlasSize{initialAtlasSize},
+          allowRotations{_allowRotations},
+          allowGrowth{_allowGrowth},
+          freeList{{{0, 0}, initialAtlasSize}} {}
+
+    bool pack(Rect& rect) {
+        auto best = findFreeRect(rect);
+        while (best == freeList.end() || !canContain(*best, rect)) {
+            if (!allowGrowth) {
+                return false;
+            }
+            grow();
+            best = findFreeRect(rect);
+        }
+
+        rect.position = best->position;
+        cropRects(rect);
+        pruneFreeList();
+        return true;
+    }
+
+    Vec atlasSize;
+
+   private:
+    static bool canContain(const Rect& free, const Rect& rect) {
+        return free.size.x >= rect.size.x && free.size.y >= rect.size.y;
+    }
+
+    static llassetgen::PackingSizeType score(const Rect& free, const Rect& rect) {
+        if (!canContain(free, rect)) {
+            return std::numeric_limits<llassetgen::PackingSizeType>::max();
+        }
+        const Vec remainder = rect.size - free.size;
+        return std::min(remainder.x, remainder.y);
+    }
+
+    std::vector<Rect>::iterator bestFreeRect(const Rect& rect) {
+        return std::min_element(freeList.begin(), freeList.end(),
+                                [&rect](const Rect& a, const Rect& b) { return score(a, rect) < score(b, rect); });
+    }
+
+    std::vector<Rect>::iterator findFreeRect(Rect& rect) {
+        if (freeList.empty()) {
+            return freeList.end();
+        }
+        auto best = bestFreeRect(rect);
+        if (allowRotations) {
+            Rect rotated{rect.position, {rect.size.y, rect.size.x}};
+            auto bestRotated = bestFreeRect(rotated);
+            if (score(*bestRotated, rotated) < score(*best, rect)) {
+                rect.size = rotated.size;
+                return bestRotated;
+            }
+        }
+        return best;
+    }
+
+    void grow() {
+        const bool growY = atlasSize.x > atlasSize.y;
+        for (auto& free : freeList) {
+            if (growY && free.position.y + free.size.y == atlasSize.y) {
+                free.size.y += atlasSize.y;
+            } else if (!growY && free.position.x + free.size.x == atlasSize.x) {
+                free.size.x += atlasSize.x;
+            }
+        }
+        freeList.push_back({growY ? Vec{0, atlasSize.y} : Vec{atlasSize.x, 0}, atlasSize});
+        (growY ? atlasSize.y : atlasSize.x) *= 2;
+    }
+
+    void cropRects(const Rect& placed) {
+        size_t rectsToCrop = freeList.size();
+        for (size_t i = 0; i < rectsToCrop;) {
+            if (placed.contains(freeList[i])) {
+                // covered rects are removed, the last rect that still has to be cropped takes their place
+                freeList[i] = freeList[rectsToCrop - 1];
+                freeList[rectsToCrop - 1] = freeList.back();
+                freeList.pop_back();
+                --rectsToCrop;
+                continue;
+            }
+
+            const Rect free = freeList[i];
+            const Vec freeMax = free.position + free.size;
+            const Vec placedMax = placed.position + placed.size;
+            std::vector<Rect> pieces;
+            auto inRange = [](llassetgen::PackingSizeType v, llassetgen::PackingSizeType min,
+                              llassetgen::PackingSizeType max) { return v > min && v < max; };
+            if (placed.position.x < freeMax.x && placedMax.x > free.position.x) {
+                if (inRange(placed.position.y, free.position.y, freeMax.y)) {
+                    pieces.push_back({free.position, {free.size.x, placed.position.y - free.position.y}});
+                }
+                if (inRange(placedMax.y, free.position.y, freeMax.y)) {
+                    pieces.push_back({{free.position.x, placedMax.y}, {free.size.x, freeMax.y - placedMax.y}});
+                }
+            }
+            if (placed.position.y < freeMax.y && placedMax.y > free.position.y) {
+                if (inRange(placed.position.x, free.position.x, freeMax.x)) {
+                    pieces.push_back({free.position, {placed.position.x - free.position.x, free.size.y}});
+                }
+                if (inRange(placedMax.x, free.position.x, freeMax.x)) {
+                    pieces.push_back({{placedMax.x, free.position.y}, {freeMax.x - placedMax.x, free.size.y}});
+                }
+            }
+            if (!pieces.empty()) {
+                freeList[i] = pieces.front();
+                freeList.insert(freeList.end(), pieces.begin() + 1, pieces.end());
+            }
+            ++i;
+        }
+    }
+
+    void pruneFreeList() {
+        if (freeList.empty()) {
+            return;
+        }
+        auto endIter = std::prev(freeList.end());
+        for (auto iter1 = freeList.begin(); iter1 < endIter; ++iter1) {
+            for (auto iter2 = std::next(iter1); iter2 <= endIter;) {
+                if (iter1->contains(*iter2)) {
+                    std::iter_swap(iter2, endIter--);
+                } else if (iter2->contains(*iter1)) {
+                    std::iter_swap(iter1, endIter--);
+                    break;
+                } else {
+                    ++iter2;
+                }
+            }
+        }
+        freeList.resize(endIter - freeList.begin() + 1);
+    }
+
+    bool allowRotations;
+    bool allowGrowth;
+    std::vector<Rect> freeList;
+};
+
 class MaxRectsPackingTest : public PackingTest {
    protected:
     Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) override {
@@ -203,6 +356,123 @@ class MaxRectsPackingTest : public PackingTest {
         test({{4, 3}, {4, 3}, {8, 5}}, {4, 5});
         test({{3, 4}, {3, 4}, {5, 8}}, {5, 4});
     }
+
+    void testSameAsLinearSearch() {
+        // The indexed free list has to choose exactly the free rects a search
+        // through the whole list chooses, ties included.
+        std::mt19937 random{17};
+        for (int run = 0; run < 200; run++) {
+            const bool allowRotations = random() % 2 == 0;
+            const bool allowGrowth = random() % 4 != 0;
+            const Vec atlasSize{llassetgen::PackingSizeType{1} << random() % 8,
+                                llassetgen::PackingSizeType{1} << random() % 8};
+            const llassetgen::PackingSizeType maxSide = 1 + random() % 40;
+            const int rectCount = 1 + random() % 300;
+
+            llassetgen::internal::MaxRectsPacker packer{atlasSize, allowRotations, allowGrowth};
+            LinearMaxRectsPacker reference{atlasSize, allowRotations, allowGrowth};
+            std::vector<Rect> placed;
+            for (int i = 0; i < rectCount; i++) {
+                // Include empty rects and squares, which tie with their rotation
+                Rect rect{{0, 0}, {random() % (maxSide + 1), random() % (maxSide + 1)}};
+                if (random() % 4 == 0) {
+                    rect.size.y = rect.size.x;
+                }
+
+                Rect expected = rect;
+                const bool packed = packer.pack(rect);
+                ASSERT_EQ(reference.pack(expected), packed);
+                if (packed) {
+                    ASSERT_EQ(expected, rect);
+                    for (const Rect& other : placed) {
+                        ASSERT_PRED2(doNotOverlap, other, rect);
+                    }
+                    placed.push_back(rect);
+                }
+                ASSERT_EQ(reference.atlasSize, packer.atlasSize());
+            }
+        }
+    }
+};
+
+class SkylinePackingTest : public PackingTest {
+   protected:
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) override {
+        return llassetgen::skylinePackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, allowRotations);
+    }
+
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
+        return llassetgen::skylinePackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
+    }
+
+   public:
+    void testDensity() {
+        // Glyph-like sizes, in a fixed size atlas that max rects fills to about 95 percent. The
+        // skyline packer has to fit them as well, which the shelf packer can not.
+        const std::vector<Vec> rectSizes = glyphSizes(500, 42);
+        llassetgen::PackingSizeType usedArea = 0;
+        for (const Vec& size : rectSizes) {
+            usedArea += size.x * size.y;
+        }
+
+        Vec atlasSize{256, usedArea * 20 / 19 / 256};
+        EXPECT_FALSE(llassetgen::maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, false).rects.empty());
+        EXPECT_TRUE(llassetgen::shelfPackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, false).rects.empty());
+        expectSuccessfulValidPacking(rectSizes, atlasSize, false);
+    }
+};
+
+class BestPackingTest : public PackingTest {
+   protected:
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations, Vec atlasSize) override {
+        return llassetgen::bestPackAtlas(rectSizes.begin(), rectSizes.end(), atlasSize, allowRotations);
+    }
+
+    Packing run(const std::vector<Vec>& rectSizes, bool allowRotations) override {
+        return llassetgen::bestPackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
+    }
+
+   public:
+    void testAllHeuristicsValid() {
+        using llassetgen::internal::MaxRectsHeuristic;
+        const std::vector<Vec> rectSizes = glyphSizes(300, 3);
+        for (MaxRectsHeuristic heuristic :
+             {MaxRectsHeuristic::BestShortSideFit, MaxRectsHeuristic::BestLongSideFit, MaxRectsHeuristic::BestAreaFit,
+              MaxRectsHeuristic::BottomLeft, MaxRectsHeuristic::ContactPoint}) {
+            for (bool allowRotations : {false, true}) {
+                Packing packing = llassetgen::internal::initPacking(rectSizes.begin(), rectSizes.end());
+                llassetgen::internal::MaxRectsPacker packer{{64, 64}, allowRotations, true, heuristic};
+                ASSERT_TRUE(llassetgen::internal::packAll(packing, packer));
+                packing.atlasSize = packer.atlasSize();
+                validatePacking(packing, rectSizes, allowRotations);
+            }
+        }
+    }
+
+    void testNotLargerThanMaxRects() {
+        for (size_t count : {10, 100, 300}) {
+            const std::vector<Vec> rectSizes = glyphSizes(count, 3);
+            for (bool allowRotations : {false, true}) {
+                Packing best = expectValidPacking(rectSizes, allowRotations);
+                Packing maxRects = llassetgen::maxRectsPackAtlas(rectSizes.begin(), rectSizes.end(), allowRotations);
+                EXPECT_LE(best.atlasSize.x * best.atlasSize.y, maxRects.atlasSize.x * maxRects.atlasSize.y);
+            }
+        }
+    }
+
+    void testSameForAnyThreadCount() {
+        const std::vector<Vec> rectSizes = glyphSizes(200, 3);
+        Packing packing = llassetgen::internal::initPacking(rectSizes.begin(), rectSizes.end());
+        packing.atlasSize = {256, 256};
+        for (bool allowGrowth : {false, true}) {
+            Packing sequential = llassetgen::internal::packBest(packing, true, allowGrowth, 1);
+            for (unsigned int threadCount : {3u, 8u}) {
+                Packing parallel = llassetgen::internal::packBest(packing, true, allowGrowth, threadCount);
+                EXPECT_EQ(sequential.atlasSize, parallel.atlasSize);
+                EXPECT_EQ(sequential.rects, parallel.rects);
+            }
+        }
+    }
 };
 
 #define ADD_TESTS_FOR_FIXTURE(Fixture)                                              \
@@ -217,11 +487,311 @@ class MaxRectsPackingTest : public PackingTest {
 
 ADD_TESTS_FOR_FIXTURE(ShelfNextFitPackingTest)
 ADD_TESTS_FOR_FIXTURE(MaxRectsPackingTest)
+ADD_TESTS_FOR_FIXTURE(SkylinePackingTest)
+ADD_TESTS_FOR_FIXTURE(BestPackingTest)
 
 #undef ADD_TESTS_FOR_FIXTURE
 
 TEST_F(MaxRectsPackingTest, TestNoFreeRect) { testNoFreeRect(); }
 TEST_F(MaxRectsPackingTest, TestFreeRectPruning) { testFreeRectPruning(); }
+TEST_F(MaxRectsPackingTest, TestSameAsLinearSearch) { testSameAsLinearSearch(); }
+TEST_F(SkylinePackingTest, TestDensity) { testDensity(); }
+TEST_F(BestPackingTest, TestAllHeuristicsValid) { testAllHeuristicsValid(); }
+TEST_F(BestPackingTest, TestNotLargerThanMaxRects) { testNotLargerThanMaxRects(); }
+TEST_F(BestPackingTest, TestSameForAnyThreadCount) { testSameForAnyThreadCount(); }
+
+TEST(SizeSearchTest, TestNotLargerThanPowerOfTwo) {
+    using PackFlexible = Packing (*)(std::vector<Vec>::const_iterator, std::vector<Vec>::const_iterator, bool);
+    const std::vector<Vec> rectSizes = glyphSizes(150, 11);
+
+    const std::vector<std::pair<PackFlexible, llassetgen::FixedSizePackingAlgorithm>> algorithms{
+        {llassetgen::shelfPackAtlas, llassetgen::shelfPackAtlas},
+        {llassetgen::maxRectsPackAtlas, llassetgen::maxRectsPackAtlas},
+        {llassetgen::skylinePackAtlas, llassetgen::skylinePackAtlas}};
+    for (const auto& algorithm : algorithms) {
+        for (bool allowRotations : {false, true}) {
+            const Packing powerOfTwo = algorithm.first(rectSizes.begin(), rectSizes.end(), allowRotations);
+            for (llassetgen::PackingSizeType alignment : {1, 16}) {
+                const Packing packing = llassetgen::packSmallestAtlas(rectSizes, algorithm.second, allowRotations,
+                                                                      alignment, 2);
+                EXPECT_EQ(0u, packing.atlasSize.x % alignment);
+                EXPECT_EQ(0u, packing.atlasSize.y % alignment);
+                EXPECT_LE(packing.atlasSize.x * packing.atlasSize.y, powerOfTwo.atlasSize.x * powerOfTwo.atlasSize.y);
+
+                ASSERT_EQ(rectSizes.size(), packing.rects.size());
+                for (size_t i = 0; i < packing.rects.size(); i++) {
+                    const Rect& rect = packing.rects[i];
+                    const Vec& size = rectSizes[i];
+                    EXPECT_TRUE(rect.size == size || (allowRotations && rect.size == Vec{size.y, size.x}));
+                    EXPECT_GE(packing.atlasSize.x, rect.position.x + rect.size.x);
+                    EXPECT_GE(packing.atlasSize.y, rect.position.y + rect.size.y);
+                    for (size_t j = i + 1; j < packing.rects.size(); j++) {
+                        EXPECT_FALSE(rect.overlaps(packing.rects[j]));
+                    }
+                }
+            }
+        }
+    }
+
+    const std::vector<Vec> none;
+    EXPECT_TRUE(llassetgen::packSmallestAtlas(none, llassetgen::shelfPackAtlas, false).rects.empty());
+}
+
+TEST(SizeSearchTest, TestSameForAnyThreadCount) {
+    std::vector<Vec> rectSizes;
+    for (llassetgen::PackingSizeType i = 0; i < 100; i++) {
+        rectSizes.push_back({1 + i % 13, 1 + i % 7});
+    }
+
+    const Packing sequential = llassetgen::packSmallestAtlas(rectSizes, llassetgen::skylinePackAtlas, false, 4, 1);
+    for (unsigned int threadCount : {2u, 5u}) {
+        const Packing parallel =
+            llassetgen::packSmallestAtlas(rectSizes, llassetgen::skylinePackAtlas, false, 4, threadCount);
+        EXPECT_EQ(sequential.atlasSize, parallel.atlasSize);
+        EXPECT_EQ(sequential.rects, parallel.rects);
+    }
+}
+
+TEST(SizeSearchTest, TestCrop) {
+    Packing packing;
+    packing.atlasSize = {64, 32};
+    packing.rects = {{{0, 0}, {10, 5}}, {{10, 0}, {3, 17}}};
+    packing.crop();
+    EXPECT_EQ((Vec{13, 17}), packing.atlasSize);
+    packing.crop(8);
+    EXPECT_EQ((Vec{13, 17}), packing.atlasSize);
+
+    packing.atlasSize = {64, 32};
+    packing.crop(8);
+    EXPECT_EQ((Vec{16, 24}), packing.atlasSize);
+    packing.atlasSize = {14, 32};
+    packing.crop(16);
+    EXPECT_EQ((Vec{14, 32}), packing.atlasSize);
+}
+
+TEST(PagedPackingTest, TestPagesAreValid) {
+    using PackPages = llassetgen::PagedPacking (*)(std::vector<Vec>::const_iterator, std::vector<Vec>::const_iterator,
+                                                   Vec, bool);
+    const std::vector<Vec> rectSizes = glyphSizes(500, 7);
+
+    const Vec pageSize{128, 128};
+    for (PackPages packPages : {PackPages(llassetgen::shelfPackPages), PackPages(llassetgen::maxRectsPackPages),
+                                PackPages(llassetgen::skylinePackPages), PackPages(llassetgen::bestPackPages)}) {
+        for (bool allowRotations : {false, true}) {
+            llassetgen::PagedPacking paged = packPages(rectSizes.begin(), rectSizes.end(), pageSize, allowRotations);
+            EXPECT_EQ(pageSize, paged.pageSize);
+            ASSERT_EQ(rectSizes.size(), paged.rects.size());
+            ASSERT_EQ(rectSizes.size(), paged.pageIndices.size());
+            EXPECT_GT(paged.pageCount, 1u);
+
+            std::vector<size_t> rectIndices;
+            size_t pagedRects = 0;
+            for (size_t page = 0; page < paged.pageCount; page++) {
+                Packing packing = paged.page(page, rectIndices);
+                EXPECT_EQ(pageSize, packing.atlasSize);
+                EXPECT_FALSE(packing.rects.empty());
+                pagedRects += rectIndices.size();
+
+                for (size_t i = 0; i < packing.rects.size(); i++) {
+                    const Rect& rect = packing.rects[i];
+                    const Vec& size = rectSizes[rectIndices[i]];
+                    EXPECT_TRUE(rect.size == size || (allowRotations && rect.size == Vec{size.y, size.x}));
+                    EXPECT_GE(pageSize.x, rect.position.x + rect.size.x);
+                    EXPECT_GE(pageSize.y, rect.position.y + rect.size.y);
+                    for (size_t j = i + 1; j < packing.rects.size(); j++) {
+                        EXPECT_FALSE(rect.overlaps(packing.rects[j]));
+                    }
+                }
+            }
+            EXPECT_EQ(rectSizes.size(), pagedRects);
+
+            std::vector<Vec> tooLarge{{1, 1}, {129, 1}};
+            EXPECT_TRUE(packPages(tooLarge.cbegin(), tooLarge.cend(), pageSize, allowRotations).rects.empty());
+        }
+    }
+}
+
+template <class Allocator>
+void expectValidAllocation(const Allocator& allocator, const std::vector<Rect>& rects) {
+    const Vec atlasSize = allocator.atlasSize();
+    for (size_t i = 0; i < rects.size(); i++) {
+        ASSERT_GE(atlasSize.x, rects[i].position.x + rects[i].size.x);
+        ASSERT_GE(atlasSize.y, rects[i].position.y + rects[i].size.y);
+        for (size_t j = i + 1; j < rects.size(); j++) {
+            ASSERT_FALSE(rects[i].overlaps(rects[j]));
+        }
+    }
+}
+
+TEST(AtlasAllocatorTest, TestMaxRectsReusesRemovedSpace) {
+    llassetgen::MaxRectsAtlasAllocator allocator{{64, 64}};
+    std::vector<Rect> rects;
+    Rect rect;
+    while (allocator.insert({8, 8}, rect)) {
+        rects.push_back(rect);
+    }
+    ASSERT_EQ(64u, rects.size());
+    EXPECT_EQ(1., allocator.occupancy());
+
+    // a square in the middle and two neighbours, which leave space for a wider rect
+    for (const Vec position : {Vec{24, 24}, Vec{32, 24}, Vec{24, 32}}) {
+        auto removed = std::find_if(rects.begin(), rects.end(), [&](const Rect& r) { return r.position == position; });
+        ASSERT_NE(rects.end(), removed);
+        allocator.remove(*removed);
+        rects.erase(removed);
+    }
+    EXPECT_EQ(61u, allocator.rectCount());
+    EXPECT_EQ(61u * 64u, allocator.usedArea());
+
+    ASSERT_TRUE(allocator.insert({16, 8}, rect));
+    EXPECT_EQ((Rect{{24, 24}, {16, 8}}), rect);
+    rects.push_back(rect);
+    ASSERT_TRUE(allocator.insert({8, 8}, rect));
+    EXPECT_EQ((Rect{{24, 32}, {8, 8}}), rect);
+    rects.push_back(rect);
+    EXPECT_FALSE(allocator.insert({1, 1}, rect));
+    expectValidAllocation(allocator, rects);
+}
+
+TEST(AtlasAllocatorTest, TestMaxRectsMergesRemovedSpace) {
+    llassetgen::MaxRectsAtlasAllocator allocator{{64, 64}};
+    std::vector<Rect> rects;
+    Rect rect;
+    while (allocator.insert({8, 8}, rect)) {
+        rects.push_back(rect);
+    }
+
+    // removed one at a time, the four squares only fit a larger rect together
+    for (const Vec position : {Vec{16, 16}, Vec{24, 24}, Vec{16, 24}, Vec{24, 16}}) {
+        auto removed = std::find_if(rects.begin(), rects.end(), [&](const Rect& r) { return r.position == position; });
+        ASSERT_NE(rects.end(), removed);
+        allocator.remove(*removed);
+        rects.erase(removed);
+    }
+
+    ASSERT_TRUE(allocator.insert({16, 16}, rect));
+    EXPECT_EQ((Rect{{16, 16}, {16, 16}}), rect);
+    rects.push_back(rect);
+    expectValidAllocation(allocator, rects);
+}
+
+TEST(AtlasAllocatorTest, TestEmptiedAtlasIsReused) {
+    llassetgen::ShelfAtlasAllocator allocator{{32, 32}};
+    std::vector<Rect> rects(4);
+    for (Rect& rect : rects) {
+        ASSERT_TRUE(allocator.insert({16, 16}, rect));
+    }
+    allocator.remove(rects[0]);
+    allocator.remove(rects[2]);
+    allocator.remove(rects[1]);
+    allocator.remove(rects[3]);
+    EXPECT_EQ(0u, allocator.rectCount());
+    EXPECT_EQ(0., allocator.occupancy());
+
+    Rect rect;
+    ASSERT_TRUE(allocator.insert({32, 32}, rect));
+    EXPECT_EQ((Rect{{0, 0}, {32, 32}}), rect);
+}
+
+TEST(AtlasAllocatorTest, TestShelfReusesSpaceAtShelfEnd) {
+    llassetgen::ShelfAtlasAllocator allocator{{32, 32}};
+    Rect first, second, third;
+    ASSERT_TRUE(allocator.insert({10, 8}, first));
+    ASSERT_TRUE(allocator.insert({10, 8}, second));
+    ASSERT_TRUE(allocator.insert({10, 8}, third));
+
+    // the space of the middle rect can only be used once the rect after it is gone
+    allocator.remove(second);
+    Rect rect;
+    ASSERT_TRUE(allocator.insert({2, 8}, rect));
+    EXPECT_EQ((Vec{30, 0}), rect.position);
+    allocator.remove(rect);
+    allocator.remove(third);
+    ASSERT_TRUE(allocator.insert({20, 8}, rect));
+    EXPECT_EQ((Vec{10, 0}), rect.position);
+    EXPECT_EQ(2u, allocator.rectCount());
+    EXPECT_DOUBLE_EQ(240. / 1024., allocator.occupancy());
+}
+
+template <class Allocator>
+void testAllocatorChurn(bool allowRotations, bool allowGrowth) {
+    std::mt19937 random{5};
+    Allocator allocator{{128, 128}, allowRotations, allowGrowth};
+    std::vector<Rect> rects;
+    llassetgen::PackingSizeType usedArea = 0;
+    for (int i = 0; i < 3000; i++) {
+        if (!rects.empty() && random() % 3 == 0) {
+            const size_t removed = random() % rects.size();
+            allocator.remove(rects[removed]);
+            usedArea -= rects[removed].size.x * rects[removed].size.y;
+            rects[removed] = rects.back();
+            rects.pop_back();
+        } else {
+            Rect rect;
+            const Vec size{1 + random() % 24, 1 + random() % 24};
+            if (allocator.insert(size, rect)) {
+                EXPECT_TRUE(rect.size == size || (allowRotations && rect.size == Vec{size.y, size.x}));
+                rects.push_back(rect);
+                usedArea += size.x * size.y;
+            } else {
+                EXPECT_FALSE(allowGrowth);
+            }
+        }
+        if (i % 100 == 0) {
+            expectValidAllocation(allocator, rects);
+        }
+    }
+    expectValidAllocation(allocator, rects);
+    EXPECT_EQ(rects.size(), allocator.rectCount());
+    EXPECT_EQ(usedArea, allocator.usedArea());
+}
+
+TEST(AtlasAllocatorTest, TestChurn) {
+    for (bool allowRotations : {false, true}) {
+        for (bool allowGrowth : {false, true}) {
+            testAllocatorChurn<llassetgen::MaxRectsAtlasAllocator>(allowRotations, allowGrowth);
+            testAllocatorChurn<llassetgen::ShelfAtlasAllocator>(allowRotations, allowGrowth);
+        }
+    }
+}
+
+TEST(PackingInternalsTest, TestMaxRectsOccupy) {
+    // every other rect of a full packing is kept, among them one that covers several free rects
+    std::mt19937 random{7};
+    const Vec atlasSize{64, 64};
+    llassetgen::internal::MaxRectsPacker packer{atlasSize, false, false};
+    std::vector<Rect> kept{{{20, 20}, {24, 24}}};
+    packer.occupy(kept[0]);
+    Rect rect;
+    for (int i = 0; i < 200; i++) {
+        rect.size = {1 + random() % 8, 1 + random() % 8};
+        if (packer.pack(rect) && i % 2 == 0) {
+            kept.push_back(rect);
+        }
+    }
+
+    llassetgen::internal::MaxRectsPacker single{atlasSize, false, false};
+    for (const Rect& keptRect : kept) {
+        single.occupy(keptRect);
+    }
+    llassetgen::internal::MaxRectsPacker bulk{atlasSize, false, false};
+    bulk.occupy(kept);
+
+    // the free rects cover exactly the pixels that are not kept
+    llassetgen::PackingSizeType freeArea = atlasSize.x * atlasSize.y;
+    for (const Rect& keptRect : kept) {
+        freeArea -= keptRect.size.x * keptRect.size.y;
+    }
+    for (auto* occupied : {&single, &bulk}) {
+        std::vector<Rect> rects = kept;
+        Rect pixel{{0, 0}, {1, 1}};
+        while (occupied->pack(pixel)) {
+            ASSERT_TRUE(std::none_of(rects.begin(), rects.end(), [&](const Rect& r) { return r.overlaps(pixel); }));
+            rects.push_back(pixel);
+        }
+        EXPECT_EQ(freeArea, rects.size() - kept.size());
+    }
+}
 
 TEST(PackingInternalsTest, TestCeilLog2) {
     for (int i = 0; i < 64; i++) {
@@ -235,3 +805,34 @@ TEST(PackingInternalsTest, TestCeilLog2) {
 
     EXPECT_EQ(64, llassetgen::internal::ceilLog2(std::numeric_limits<std::uint64_t>::max()));
 }
+
+TEST(PackingInternalsTest, TestSortDescending) {
+    std::mt19937_64 random(5);
+    std::vector<std::uint64_t> keys;
+    for (int i = 0; i < 1000; i++) {
+        // Few distinct values, spread over all bits, so that there are many ties
+        keys.push_back(random() % 8 * 0x0123456789abcdefu);
+    }
+
+    std::vector<std::uint32_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&keys](std::uint32_t i1, std::uint32_t i2) { return keys[i1] > keys[i2]; });
+    EXPECT_EQ(expected, llassetgen::internal::sortDescending(keys));
+    EXPECT_TRUE(llassetgen::internal::sortDescending({}).empty());
+}
+
+TEST(PackingInternalsTest, TestCompactRects) {
+    using Rect = llassetgen::Rect<llassetgen::PackingSizeType>;
+    llassetgen::internal::CompactRects rects;
+    rects.push_back({{1, 2}, {3, 4}});
+    rects.push_back({{0xffffffffu, 0}, {5, 6}});
+    rects.swap(0, 1);
+    EXPECT_EQ(Rect({{0xffffffffu, 0}, {5, 6}}), rects[0]);
+    EXPECT_EQ(Rect({{1, 2}, {3, 4}}), rects.back());
+
+    if (std::numeric_limits<llassetgen::PackingSizeType>::max() > 0xffffffffu) {
+        const auto tooLarge = static_cast<llassetgen::PackingSizeType>(0xffffffffu) + 1;
+        EXPECT_THROW(rects.set(0, {{0, 0}, {tooLarge, 1}}), std::runtime_error);
+    }
+}
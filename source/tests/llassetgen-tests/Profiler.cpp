@@ -0,0 +1,144 @@
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llassetgen/Atlas.h>
+#include <llassetgen/Profiler.h>
+#include <llassetgen/packing/Algorithms.h>
+
+
+using namespace llassetgen;
+
+
+std::string profilerTestTracePath = "../../trace.json";
+std::vector<Vec2<size_t>> profilerTestSizes{{1, 1}, {34, 5}, {23, 79}, {16, 70}, {91, 64}, {98, 82}};
+
+// The lines of the trace, one per event
+std::vector<std::string> readTrace() {
+    std::ifstream in{profilerTestTracePath};
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+const std::string* findEvent(const std::vector<std::string>& trace, const std::string& name) {
+    for (const std::string& line : trace) {
+        if (line.find("\"name\":\"" + name + "\"") != std::string::npos) {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t eventArg(const std::string& event, const std::string& arg) {
+    size_t pos = event.find("\"" + arg + "\":");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    std::istringstream value{event.substr(pos + arg.size() + 3)};
+    uint64_t result = 0;
+    value >> result;
+    return result;
+}
+
+Image profiledFontAtlas() {
+    std::vector<Image> glyphs;
+    for (const auto& size : profilerTestSizes) {
+        glyphs.emplace_back(size.x, size.y, 1);
+    }
+    Packing p = maxRectsPackAtlas(profilerTestSizes.begin(), profilerTestSizes.end(), false);
+    return fontAtlas(glyphs.begin(), glyphs.end(), p);
+}
+
+TEST(ProfilerTest, RecordsNothingWhenDisabled) {
+    Profiler::enable();
+    Profiler::disable();
+    profiledFontAtlas();
+    Profiler::writeTrace(profilerTestTracePath);
+
+    std::vector<std::string> trace = readTrace();
+    EXPECT_EQ(nullptr, findEvent(trace, "font atlas"));
+    EXPECT_EQ(nullptr, findEvent(trace, "pack"));
+    ASSERT_NE(nullptr, findEvent(trace, "thread_name"));
+    EXPECT_EQ("]}", trace.back());
+}
+
+TEST(ProfilerTest, RecordsStagesWithCounts) {
+    Profiler::enable();
+    Image atlas = profiledFontAtlas();
+    atlas.exportPng<uint8_t>("../../profiled_atlas.png");
+    Profiler::disable();
+    Profiler::writeTrace(profilerTestTracePath);
+
+    std::vector<std::string> trace = readTrace();
+    const std::string* pack = findEvent(trace, "pack");
+    ASSERT_NE(nullptr, pack);
+    EXPECT_EQ(profilerTestSizes.size(), eventArg(*pack, "rects"));
+
+    const std::string* composition = findEvent(trace, "font atlas");
+    ASSERT_NE(nullptr, composition);
+    EXPECT_EQ(profilerTestSizes.size(), eventArg(*composition, "glyphs"));
+    // the glyphs were allocated before, the atlas during the stage
+    EXPECT_EQ((atlas.getWidth() + 7) / 8 * atlas.getHeight(), eventArg(*composition, "imageBytes"));
+
+    const std::string* png = findEvent(trace, "png export");
+    ASSERT_NE(nullptr, png);
+    EXPECT_EQ(atlas.getWidth() * atlas.getHeight(), eventArg(*png, "pixels"));
+}
+
+TEST(ProfilerTest, SumsUpStages) {
+    Profiler::enable();
+    profiledFontAtlas();
+    profiledFontAtlas();
+    Profiler::disable();
+
+    std::vector<ProfileStage> stages = Profiler::stages();
+    ASSERT_EQ(2u, stages.size());
+    EXPECT_EQ("pack", stages[0].name);
+    EXPECT_EQ("font atlas", stages[1].name);
+    EXPECT_EQ(2u, stages[0].calls);
+    EXPECT_EQ(2u, stages[1].calls);
+    EXPECT_GT(stages[1].seconds, 0);
+    EXPECT_EQ(0u, stages[0].imageBytes);
+}
+
+TEST(ProfilerTest, RecordsEachThreadOnItsOwnTrack) {
+    std::vector<Vec2<size_t>> rectSizes(40, {30, 30});
+    PagedPacking paged = maxRectsPackPages(rectSizes.begin(), rectSizes.end(), {64, 64}, false);
+    ASSERT_GT(paged.pageCount, 2u);
+
+    Profiler::enable();
+    // slow enough pages that both threads get some
+    auto buildPage = [](size_t, const Packing&, const std::vector<size_t>&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    };
+    buildPages(paged, buildPage, 2);
+    Profiler::disable();
+    Profiler::writeTrace(profilerTestTracePath);
+
+    std::vector<std::string> trace = readTrace();
+    std::set<uint64_t> pageThreads;
+    size_t pageCount = 0;
+    for (const std::string& line : trace) {
+        if (line.find("\"name\":\"page\"") != std::string::npos) {
+            pageThreads.insert(eventArg(line, "tid"));
+            pageCount++;
+        }
+    }
+    EXPECT_EQ(paged.pageCount, pageCount);
+    EXPECT_EQ(std::set<uint64_t>({1, 2}), pageThreads);
+    EXPECT_NE(nullptr, findEvent(trace, "main"));
+    EXPECT_NE(nullptr, findEvent(trace, "worker 1"));
+}
+
+TEST(ProfilerTest, UnwritableTraceThrows) {
+    EXPECT_THROW(Profiler::writeTrace("../../missing/directory/trace.json"), std::runtime_error);
+}
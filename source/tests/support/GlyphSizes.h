@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <llassetgen/Geometry.h>
+
+
+/**
+ * Linear congruential generator for test inputs, so that a seed gives the
+ * same sequence with every standard library.
+ */
+class TestRandom {
+   public:
+    explicit TestRandom(std::uint32_t seed) : state(seed) {}
+
+    /**
+     * A number in [0, bound), from the high bits of the next state.
+     */
+    std::size_t below(std::size_t bound) {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) % bound;
+    }
+
+   private:
+    std::uint32_t state;
+};
+
+/**
+ * Glyph-like sizes, 4 to 31 pixels wide and 8 to 39 pixels high.
+ */
+inline std::vector<llassetgen::Vec2<std::size_t>> glyphSizes(std::size_t count, std::uint32_t seed) {
+    std::vector<llassetgen::Vec2<std::size_t>> sizes;
+    sizes.reserve(count);
+    TestRandom random{seed};
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t width = 4 + random.below(28);
+        sizes.push_back({width, 8 + random.below(32)});
+    }
+    return sizes;
+}
+
+/**
+ * Sizes of glyphs supersampled by 2, even numbers from 8 to 38 pixels.
+ */
+inline std::vector<llassetgen::Vec2<std::size_t>> supersampledGlyphSizes(std::size_t count) {
+    std::vector<llassetgen::Vec2<std::size_t>> sizes;
+    sizes.reserve(count);
+    TestRandom random{12345};
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t width = 2 * (4 + random.below(16));
+        sizes.push_back({width, 2 * (4 + random.below(16))});
+    }
+    return sizes;
+}